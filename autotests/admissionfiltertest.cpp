@@ -0,0 +1,110 @@
+/**
+ * @file admissionfiltertest.cpp
+ * @brief Las aperturas y cierres que pasan AdmissionFilter siguen emparejados
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ *
+ * Una ráfaga de aperturas del mismo recurso agota el token bucket. Cada
+ * apertura descartada debe llevarse también uno de los cierres, de modo que
+ * el worker reciba tantos cierres como aperturas y la sesión de la app no
+ * termine antes de cerrar la última ventana.
+ */
+
+#include "admissionfilter.h"
+
+#include <QTest>
+
+namespace {
+
+const QString AGENT = QStringLiteral("org.kde.plasmashell");
+const QString DOLPHIN = QStringLiteral("applications:org.kde.dolphin.desktop");
+const QString KATE = QStringLiteral("applications:org.kde.kate.desktop");
+
+/// Ráfaga máxima del bucket en estas pruebas
+constexpr int BURST = 3;
+
+} // namespace
+
+class AdmissionFilterTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void openBurstThenCloses();
+    void closesOfOtherResourcesPass();
+    void unlimitedAdmitsEverything();
+
+private:
+    /// Filtro con BURST tokens y una recarga de 1 por segundo
+    static AdmissionFilter limitedFilter();
+};
+
+AdmissionFilter AdmissionFilterTest::limitedFilter()
+{
+    AdmissionFilter filter;
+    AdmissionFilter::Config config;
+    config.ratePerSecond = 1;
+    config.burst = BURST;
+    filter.configure(config);
+    return filter;
+}
+
+void AdmissionFilterTest::openBurstThenCloses()
+{
+    AdmissionFilter filter = limitedFilter();
+    constexpr int opens = 10;
+
+    // Todo en el mismo milisegundo: el bucket no se recarga
+    int admittedOpens = 0;
+    for (int i = 0; i < opens; ++i) {
+        if (filter.admit(AGENT, DOLPHIN, AdmissionFilter::Open, 0) == AdmissionFilter::Admitted) {
+            ++admittedOpens;
+        }
+    }
+    QCOMPARE(admittedOpens, BURST);
+
+    int admittedCloses = 0;
+    for (int i = 0; i < opens; ++i) {
+        if (filter.admit(AGENT, DOLPHIN, AdmissionFilter::Close, 0) == AdmissionFilter::Admitted) {
+            ++admittedCloses;
+        }
+    }
+    QCOMPARE(admittedCloses, admittedOpens);
+
+    // Ya emparejados: un cierre más (sin apertura) pasa sin consumir tokens
+    QCOMPARE(filter.admit(AGENT, DOLPHIN, AdmissionFilter::Close, 0), AdmissionFilter::Admitted);
+}
+
+void AdmissionFilterTest::closesOfOtherResourcesPass()
+{
+    AdmissionFilter filter = limitedFilter();
+    for (int i = 0; i < BURST; ++i) {
+        QCOMPARE(filter.admit(AGENT, KATE, AdmissionFilter::Open, 0), AdmissionFilter::Admitted);
+    }
+    QCOMPARE(filter.admit(AGENT, DOLPHIN, AdmissionFilter::Open, 0), AdmissionFilter::Throttled);
+
+    // Las aperturas de Kate entraron: sus cierres también, con el bucket vacío
+    for (int i = 0; i < BURST; ++i) {
+        QCOMPARE(filter.admit(AGENT, KATE, AdmissionFilter::Close, 0), AdmissionFilter::Admitted);
+    }
+    QCOMPARE(filter.admit(AGENT, DOLPHIN, AdmissionFilter::Close, 0), AdmissionFilter::Throttled);
+
+    // Un foco descartado no deja cierres pendientes
+    QCOMPARE(filter.admit(AGENT, KATE, AdmissionFilter::Focus, 0), AdmissionFilter::Throttled);
+    QCOMPARE(filter.admit(AGENT, KATE, AdmissionFilter::Close, 0), AdmissionFilter::Admitted);
+}
+
+void AdmissionFilterTest::unlimitedAdmitsEverything()
+{
+    AdmissionFilter filter;
+    filter.configure(AdmissionFilter::Config());
+    for (int i = 0; i < 100; ++i) {
+        QCOMPARE(filter.admit(AGENT, DOLPHIN, AdmissionFilter::Open, 0), AdmissionFilter::Admitted);
+    }
+    for (int i = 0; i < 100; ++i) {
+        QCOMPARE(filter.admit(AGENT, DOLPHIN, AdmissionFilter::Close, 0), AdmissionFilter::Admitted);
+    }
+}
+
+QTEST_GUILESS_MAIN(AdmissionFilterTest)
+
+#include "admissionfiltertest.moc"
@@ -0,0 +1,114 @@
+/**
+ * @file appresolvertest.cpp
+ * @brief AppResolver no indexa intérpretes ni envoltorios como alias
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ *
+ * Escribe entradas .desktop en el directorio de aplicaciones de prueba con
+ * líneas Exec= que pasan por `sh -c`, `python3`, `env` y `flatpak run`.
+ * El programa real (o el id de flatpak) debe resolver a su entrada, y el
+ * nombre del intérprete no debe resolver a ninguna.
+ */
+
+#include "appresolver.h"
+#include "perfcounters.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTest>
+
+namespace {
+
+const QString SCRIPT = QStringLiteral("iconwear-test-script.desktop");
+const QString PYTHON = QStringLiteral("iconwear-test-python.desktop");
+const QString ENV = QStringLiteral("iconwear-test-env.desktop");
+const QString FLATPAK = QStringLiteral("iconwear-test-flatpak.desktop");
+const QString PLAIN = QStringLiteral("iconwear-test-plain.desktop");
+
+} // namespace
+
+class AppResolverTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void realProgramsResolve();
+    void launchersAreNotAliases();
+    void launchersAreNotAliases_data();
+
+private:
+    /// Escribe una entrada de tipo Application con @p keys en el grupo [Desktop Entry]
+    void writeDesktopFile(const QString &id, const QString &keys);
+
+    QString m_applications;
+};
+
+void AppResolverTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_applications = QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation);
+    QDir(m_applications).removeRecursively();
+    QVERIFY(QDir().mkpath(m_applications));
+
+    writeDesktopFile(SCRIPT, QStringLiteral("Exec=sh -c \"iconwear-test-wrapped --fast\"\n"));
+    writeDesktopFile(PYTHON, QStringLiteral("Exec=/usr/bin/python3 /opt/iconwear-test/tool.py %f\n"
+                                            "StartupWMClass=java\n"));
+    writeDesktopFile(ENV, QStringLiteral("Exec=env -u QT_SCALE_FACTOR LANG=C iconwear-test-envtool %U\n"));
+    writeDesktopFile(FLATPAK, QStringLiteral("Exec=/usr/bin/flatpak run --branch=stable --arch=x86_64 "
+                                             "--command=tool org.example.IconWearTest %U\n"));
+    writeDesktopFile(PLAIN, QStringLiteral("Exec=/opt/iconwear-test/bin/iconwear-test-plain\n"
+                                           "TryExec=bash\n"));
+}
+
+void AppResolverTest::writeDesktopFile(const QString &id, const QString &keys)
+{
+    QFile file(m_applications + QLatin1Char('/') + id);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("[Desktop Entry]\nType=Application\nName=IconWear test\n");
+    file.write(keys.toUtf8());
+}
+
+void AppResolverTest::realProgramsResolve()
+{
+    PerfCounters counters;
+    AppResolver resolver(counters, 16);
+
+    QCOMPARE(resolver.resolve(QStringLiteral("iconwear-test-envtool")), ENV);
+    QCOMPARE(resolver.resolve(QStringLiteral("org.example.IconWearTest")), FLATPAK);
+    QCOMPARE(resolver.resolve(QStringLiteral("iconwear-test-plain")), PLAIN);
+    QCOMPARE(resolver.resolve(QStringLiteral("/opt/iconwear-test/bin/iconwear-test-plain")), PLAIN);
+}
+
+void AppResolverTest::launchersAreNotAliases_data()
+{
+    QTest::addColumn<QString>("resource");
+
+    QTest::newRow("sh") << QStringLiteral("sh");
+    QTest::newRow("/bin/sh") << QStringLiteral("/bin/sh");
+    QTest::newRow("bash") << QStringLiteral("bash");
+    QTest::newRow("python3") << QStringLiteral("python3");
+    QTest::newRow("/usr/bin/python3") << QStringLiteral("/usr/bin/python3");
+    QTest::newRow("java") << QStringLiteral("java");
+    QTest::newRow("env") << QStringLiteral("env");
+    QTest::newRow("flatpak") << QStringLiteral("flatpak");
+    QTest::newRow("/usr/bin/flatpak") << QStringLiteral("/usr/bin/flatpak");
+}
+
+void AppResolverTest::launchersAreNotAliases()
+{
+    QFETCH(QString, resource);
+
+    PerfCounters counters;
+    AppResolver resolver(counters, 16);
+
+    // Nunca una de las entradas de prueba: sin alias, el nombre queda tal
+    // cual (o el ejecutable, o nada si la ruta no existe)
+    const QString appId = resolver.resolve(resource);
+    QVERIFY2(!appId.startsWith(QLatin1String("iconwear-test-")), qPrintable(appId));
+    QVERIFY(appId.isEmpty() || appId == resource.section(QLatin1Char('/'), -1));
+}
+
+QTEST_GUILESS_MAIN(AppResolverTest)
+
+#include "appresolvertest.moc"
@@ -0,0 +1,192 @@
+/**
+ * @file dbusbatchtest.cpp
+ * @brief Las consultas en lote y wearLevelsChanged viajan por DBus con sus tipos
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ *
+ * Exporta un UsageTracker en una conexión privada punto a punto
+ * (QDBusServer), sin bus de sesión ni daemon real, y llama a cada slot en
+ * lote por el cable. Si un typedef de wearmetrics.h no está registrado por
+ * su nombre, QtDBus no sabe serializar la respuesta ni conectar la señal.
+ */
+
+#include "usagetracker.h"
+#include "snapshot.h"
+#include "usagehistory.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusServer>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTest>
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <memory>
+
+namespace {
+
+const QString TRACKER_PATH = QStringLiteral("/Tracker");
+const QString TRACKER_INTERFACE = QStringLiteral("org.kde.iconwear.Tracker");
+const QString CLIENT_NAME = QStringLiteral("dbusbatchtest-client");
+
+/// App sembrada en iconwearrc: 80 lanzamientos dan nivel 80 con la fórmula por defecto
+const QString APP_ID = QStringLiteral("org.kde.dolphin.desktop");
+constexpr int APP_LAUNCHES = 80;
+
+} // namespace
+
+class DBusBatchTest : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    /// Receptor de la señal; la firma por nombre es la que usa IconWearClient
+    void onWearLevelsChanged(const WearLevelMap &levels)
+    {
+        m_received.append(levels);
+    }
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void getWearLevels();
+    void getMetricsBatch();
+    void getAllMetrics();
+    void getActivityMetrics();
+    void getUsageHistory();
+    void wearLevelsChangedSignal();
+
+private:
+    /// Llama a un método del tracker por la conexión del cliente
+    QDBusMessage call(const QString &method, const QVariantList &arguments = QVariantList());
+
+    std::unique_ptr<UsageTracker> m_tracker;
+    QDBusServer *m_server = nullptr;
+    QList<QDBusConnection> m_peers;
+    QList<WearLevelMap> m_received;
+};
+
+void DBusBatchTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QFile::remove(WearSnapshot::defaultPath());
+    QFile::remove(UsageHistory::defaultPath());
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+                  + QStringLiteral("/iconwearrc"));
+
+    KSharedConfigPtr config = KSharedConfig::openConfig(QStringLiteral("iconwearrc"));
+    config->reparseConfiguration();
+    KConfigGroup general(config, QStringLiteral("General"));
+    general.writeEntry(QStringLiteral("sharedMemory"), false);
+    general.writeEntry(QStringLiteral("notifyIntervalMs"), 0);
+    KConfigGroup app = config->group(QStringLiteral("Applications")).group(APP_ID);
+    app.writeEntry(QStringLiteral("launches"), APP_LAUNCHES);
+    app.writeEntry(QStringLiteral("lastOpenTime"), QDateTime::currentSecsSinceEpoch());
+    config->sync();
+
+    m_tracker.reset(new UsageTracker(nullptr, false));
+
+    m_server = new QDBusServer(QStringLiteral("unix:tmpdir=") + QDir::tempPath(), this);
+    QVERIFY(m_server->isConnected());
+    connect(m_server, &QDBusServer::newConnection, this, [this](const QDBusConnection &connection) {
+        QDBusConnection peer(connection);
+        peer.registerObject(TRACKER_PATH, m_tracker.get(),
+                            QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals);
+        m_peers.append(peer);
+    });
+
+    const QDBusConnection client = QDBusConnection::connectToPeer(m_server->address(), CLIENT_NAME);
+    QVERIFY(client.isConnected());
+    QTRY_COMPARE(m_peers.size(), 1);
+}
+
+void DBusBatchTest::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromPeer(CLIENT_NAME);
+    m_tracker.reset();
+}
+
+//! El servidor y el cliente comparten hilo: la llamada procesa eventos mientras espera
+QDBusMessage DBusBatchTest::call(const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(QString(), TRACKER_PATH, TRACKER_INTERFACE, method);
+    message.setArguments(arguments);
+    return QDBusConnection(CLIENT_NAME).call(message, QDBus::BlockWithGui);
+}
+
+void DBusBatchTest::getWearLevels()
+{
+    const QDBusMessage reply = call(QStringLiteral("getWearLevels"),
+                                    {QStringList{APP_ID, QStringLiteral("unknown.desktop")}});
+    QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+    QCOMPARE(reply.signature(), QStringLiteral("a{si}"));
+
+    const WearLevelMap levels = qdbus_cast<WearLevelMap>(reply.arguments().at(0));
+    QCOMPARE(levels.value(APP_ID), APP_LAUNCHES);
+    QCOMPARE(levels.value(QStringLiteral("unknown.desktop"), -1), 0);
+}
+
+void DBusBatchTest::getMetricsBatch()
+{
+    const QDBusMessage reply = call(QStringLiteral("getMetricsBatch"), {QStringList{APP_ID}});
+    QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+    QCOMPARE(reply.signature(), QStringLiteral("a{s(iiixx)}"));
+
+    const WearMetricsMap metrics = qdbus_cast<WearMetricsMap>(reply.arguments().at(0));
+    QVERIFY(metrics.contains(APP_ID));
+    QCOMPARE(metrics.value(APP_ID).launches, APP_LAUNCHES);
+}
+
+void DBusBatchTest::getAllMetrics()
+{
+    const QDBusMessage reply = call(QStringLiteral("getAllMetrics"));
+    QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+    QCOMPARE(reply.signature(), QStringLiteral("a{s(iiixx)}"));
+
+    const WearMetricsMap metrics = qdbus_cast<WearMetricsMap>(reply.arguments().at(0));
+    QCOMPARE(metrics.size(), 1);
+    QCOMPARE(metrics.value(APP_ID).wearLevel, APP_LAUNCHES);
+}
+
+void DBusBatchTest::getActivityMetrics()
+{
+    // Sin kactivitymanagerd no hay actividad actual: mapa vacío, pero tipado
+    const QDBusMessage reply = call(QStringLiteral("getActivityMetrics"), {QString()});
+    QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+    QCOMPARE(reply.signature(), QStringLiteral("a{s(iiixx)}"));
+}
+
+void DBusBatchTest::getUsageHistory()
+{
+    const qlonglong now = QDateTime::currentSecsSinceEpoch();
+    const QDBusMessage reply = call(QStringLiteral("getUsageHistory"),
+                                    {APP_ID, now - 7 * 86400, now, QStringLiteral("day")});
+    QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+    QCOMPARE(reply.signature(), QStringLiteral("a(xii)"));
+    QVERIFY(qdbus_cast<UsageBucketList>(reply.arguments().at(0)).isEmpty());
+}
+
+void DBusBatchTest::wearLevelsChangedSignal()
+{
+    QVERIFY(QDBusConnection(CLIENT_NAME).connect(QString(), TRACKER_PATH, TRACKER_INTERFACE,
+                                                 QStringLiteral("wearLevelsChanged"),
+                                                 this, SLOT(onWearLevelsChanged(WearLevelMap))));
+
+    // Bajar el tope recalcula el nivel y emite una única señal en lote
+    KSharedConfigPtr config = KSharedConfig::openConfig(QStringLiteral("iconwearrc"));
+    KConfigGroup(config, QStringLiteral("WearFormula")).writeEntry(QStringLiteral("cap"), 50);
+    config->sync();
+
+    const QDBusMessage reply = call(QStringLiteral("reloadWearFormula"));
+    QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+    QTRY_COMPARE(m_received.size(), 1);
+    QCOMPARE(m_received.first().value(APP_ID), 50);
+}
+
+QTEST_GUILESS_MAIN(DBusBatchTest)
+
+#include "dbusbatchtest.moc"
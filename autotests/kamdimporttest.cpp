@@ -0,0 +1,176 @@
+/**
+ * @file kamdimporttest.cpp
+ * @brief Importar dos veces la base de datos de kactivitymanagerd no duplica nada
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ *
+ * Construye una tabla ResourceEvent mínima en SQLite, la importa con
+ * TrackerWorker::importKamdDatabase() (como `iconwear-daemon --import-kamd`)
+ * y repite la importación, también desde un worker recién cargado del disco.
+ * Cada app debe quedar con el máximo entre lo guardado y lo importado, y la
+ * marca de agua de KActivities Stats debe avanzar hasta el último evento.
+ */
+
+#include "activitypartitions.h"
+#include "perfcounters.h"
+#include "trackerworker.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+namespace {
+
+const QString ACTIVITY = QStringLiteral("0b7c3f2e-8a1d-4c5e-9f60-1a2b3c4d5e6f");
+const QString DOLPHIN = QStringLiteral("org.kde.dolphin.desktop");
+const QString KONSOLE = QStringLiteral("org.kde.konsole.desktop");
+
+/// Lanzamientos de Konsole ya guardados, por encima de lo que trae la base de datos
+constexpr int KONSOLE_SAVED_LAUNCHES = 5;
+
+/// Fila de ResourceEvent
+struct Event {
+    QString resource;
+    qint64 start;
+    qint64 end;
+};
+
+} // namespace
+
+class KamdImportTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void firstImport();
+    void secondImportIsNoOp();
+    void importWithoutSnapshot();
+
+private:
+    /// Grupo de iconwearrc de una app
+    static KConfigGroup appGroup(const QString &appId);
+
+    /// General/statsWatermark guardado
+    static qint64 savedWatermark();
+
+    /// Comprueba lo guardado tras cualquier número de importaciones
+    void verifySaved();
+
+    QTemporaryDir m_dir;
+    QString m_databasePath;
+    QVector<Event> m_events;
+    qint64 m_lastEvent = 0;
+};
+
+void KamdImportTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+         + QStringLiteral("/iconwear")).removeRecursively();
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+                  + QStringLiteral("/iconwearrc"));
+
+    // Konsole ya tenía más lanzamientos que los importados, pero nada de tiempo
+    KSharedConfigPtr config = KSharedConfig::openConfig(QStringLiteral("iconwearrc"));
+    config->reparseConfiguration();
+    KConfigGroup general(config, QStringLiteral("General"));
+    general.writeEntry(QStringLiteral("sharedMemory"), false);
+    general.writeEntry(QStringLiteral("coldAfterDays"), 0);
+    appGroup(KONSOLE).writeEntry(QStringLiteral("launches"), KONSOLE_SAVED_LAUNCHES);
+    config->sync();
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    m_events = {
+        {QStringLiteral("applications:") + DOLPHIN, now - 7200, now - 3600},
+        {QStringLiteral("applications:") + DOLPHIN, now - 1800, now - 1200},
+        {QStringLiteral("applications:") + KONSOLE, now - 600, now - 300},
+    };
+    m_lastEvent = now - 300;
+
+    QVERIFY(m_dir.isValid());
+    m_databasePath = m_dir.filePath(QStringLiteral("database"));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("fixture"));
+        db.setDatabaseName(m_databasePath);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec(QStringLiteral("CREATE TABLE ResourceEvent (usedActivity TEXT, initiatingAgent TEXT, "
+                                          "targetedResource TEXT, start INTEGER, end INTEGER)")));
+        QVERIFY(query.prepare(QStringLiteral("INSERT INTO ResourceEvent VALUES (?, ?, ?, ?, ?)")));
+        for (const Event &event : qAsConst(m_events)) {
+            query.bindValue(0, ACTIVITY);
+            query.bindValue(1, QStringLiteral("org.kde.plasmashell"));
+            query.bindValue(2, event.resource);
+            query.bindValue(3, event.start);
+            query.bindValue(4, event.end);
+            QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        }
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("fixture"));
+}
+
+KConfigGroup KamdImportTest::appGroup(const QString &appId)
+{
+    return KSharedConfig::openConfig(QStringLiteral("iconwearrc"))->group(QStringLiteral("Applications")).group(appId);
+}
+
+qint64 KamdImportTest::savedWatermark()
+{
+    const KConfigGroup general(KSharedConfig::openConfig(QStringLiteral("iconwearrc")), QStringLiteral("General"));
+    return general.readEntry(QStringLiteral("statsWatermark"), 0LL);
+}
+
+void KamdImportTest::verifySaved()
+{
+    QCOMPARE(appGroup(DOLPHIN).readEntry(QStringLiteral("launches"), 0), 2);
+    QCOMPARE(appGroup(DOLPHIN).readEntry(QStringLiteral("activeTimeSeconds"), 0LL), 3600LL + 600LL);
+    QCOMPARE(appGroup(KONSOLE).readEntry(QStringLiteral("launches"), 0), KONSOLE_SAVED_LAUNCHES);
+    QCOMPARE(appGroup(KONSOLE).readEntry(QStringLiteral("activeTimeSeconds"), 0LL), 300LL);
+    QCOMPARE(savedWatermark(), m_lastEvent);
+
+    // La partición de la actividad recibe los mismos totales (sin lo guardado antes)
+    AppStore partition;
+    QVERIFY(ActivityPartitions::loadFromDisk(ActivityPartitions::defaultDirectory(), ACTIVITY, partition));
+    QCOMPARE(partition.size(), 2);
+    QCOMPARE(partition.info(partition.find(DOLPHIN)).launches, 2);
+    QCOMPARE(partition.info(partition.find(KONSOLE)).launches, 1);
+    QCOMPARE(partition.info(partition.find(KONSOLE)).activeTimeSeconds, 300LL);
+}
+
+void KamdImportTest::firstImport()
+{
+    PerfCounters counters;
+    TrackerWorker worker(counters, true);
+    QCOMPARE(worker.importKamdDatabase(m_databasePath, 2), 2);
+    verifySaved();
+}
+
+void KamdImportTest::secondImportIsNoOp()
+{
+    PerfCounters counters;
+    TrackerWorker worker(counters, true);
+    QCOMPARE(worker.importKamdDatabase(m_databasePath, 2), 0);
+    QCOMPARE(worker.importKamdDatabase(m_databasePath, 1), 0);
+    verifySaved();
+}
+
+void KamdImportTest::importWithoutSnapshot()
+{
+    // Solo iconwearrc: la marca de agua y los máximos también sobreviven sin snapshot
+    PerfCounters counters;
+    TrackerWorker worker(counters, false);
+    QCOMPARE(worker.importKamdDatabase(m_databasePath, 2), 0);
+    verifySaved();
+}
+
+QTEST_GUILESS_MAIN(KamdImportTest)
+
+#include "kamdimporttest.moc"
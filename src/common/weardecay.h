@@ -0,0 +1,82 @@
+/**
+ * @file weardecay.h
+ * @brief Desgaste con decaimiento exponencial evaluado de forma perezosa
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Cada app guarda un par (puntuación, instante). El valor en cualquier otro
+ * instante se obtiene en O(1):
+ * 
+ * @code
+ * puntuación(t) = puntuación(t0) × 2^(-(t - t0) / semivida)
+ * @endcode
+ * 
+ * No hay barrido periódico: el par solo se reescribe cuando la app suma
+ * desgaste, y los lectores (daemon o clientes de memoria compartida)
+ * aplican el decaimiento al consultar.
+ */
+
+#ifndef WEARDECAY_H
+#define WEARDECAY_H
+
+#include <QtGlobal>
+
+#include <cmath>
+#include <limits>
+
+namespace WearDecay {
+
+/// Nivel máximo de desgaste visible
+constexpr int MAX_LEVEL = 100;
+
+/**
+ * @brief Valor de una puntuación en otro instante
+ * @param score Puntuación en @p fromSecs
+ * @param fromSecs Instante de la puntuación (segundos epoch)
+ * @param toSecs Instante de la consulta (segundos epoch)
+ * @param halfLifeSeconds Semivida; <= 0 desactiva el decaimiento
+ */
+inline double decayed(double score, qint64 fromSecs, qint64 toSecs, qint64 halfLifeSeconds)
+{
+    if (halfLifeSeconds <= 0 || toSecs <= fromSecs) {
+        return score;
+    }
+    return score * std::exp2(-static_cast<double>(toSecs - fromSecs) / static_cast<double>(halfLifeSeconds));
+}
+
+/// Nivel entero (0-MAX_LEVEL) de una puntuación
+inline int level(double score)
+{
+    return qBound(0, static_cast<int>(score), MAX_LEVEL);
+}
+
+/// Nivel en @p nowSecs de una puntuación tomada en @p stampSecs
+inline int levelAt(double score, qint64 stampSecs, qint64 nowSecs, qint64 halfLifeSeconds)
+{
+    return level(decayed(score, stampSecs, nowSecs, halfLifeSeconds));
+}
+
+/**
+ * @brief Clave de orden de una puntuación, invariante en el tiempo
+ * 
+ * Todas las puntuaciones decaen al mismo ritmo, así que el orden entre
+ * apps no cambia mientras no sumen desgaste. Comparar
+ * `log2(puntuación) + instante / semivida` equivale a comparar los valores
+ * decaídos en cualquier instante común, sin tener que recalcularlos.
+ * 
+ * @return La puntuación tal cual sin semivida; -infinito si es 0
+ */
+inline double rankKey(double score, qint64 stampSecs, qint64 halfLifeSeconds)
+{
+    if (score <= 0.0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    if (halfLifeSeconds <= 0) {
+        return score;
+    }
+    return std::log2(score) + static_cast<double>(stampSecs) / static_cast<double>(halfLifeSeconds);
+}
+
+} // namespace WearDecay
+
+#endif // WEARDECAY_H
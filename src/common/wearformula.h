@@ -0,0 +1,193 @@
+/**
+ * @file wearformula.h
+ * @brief Fórmula de desgaste configurable: pesos, curva y tope
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * El desgaste bruto de una app es una combinación lineal de su uso:
+ *
+ * @code
+ * bruto = lanzamientos × launchWeight + minutosActivos × minuteWeight
+ * @endcode
+ *
+ * (con semivida configurada, el bruto es la puntuación decaída; ver
+ * weardecay.h). El nivel visible pasa el bruto por una curva y lo recorta:
+ *
+ * | Curva    | nivel                               |
+ * |----------|-------------------------------------|
+ * | `linear` | bruto                               |
+ * | `sqrt`   | √(bruto × escala)                   |
+ * | `log`    | escala × log2(1 + bruto / escala)   |
+ *
+ * Las tres coinciden en bruto = escala (sqrt y log en el origen también),
+ * así que `curveScale` marca dónde empieza a comprimirse el desgaste.
+ *
+ * Se lee una vez de la configuración (grupo WearFormula de iconwearrc) y
+ * se evalúa en float, igual en el daemon que en los lectores de memoria
+ * compartida, para que ambos den exactamente el mismo nivel.
+ */
+
+#ifndef WEARFORMULA_H
+#define WEARFORMULA_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+
+#include "weardecay.h"
+
+/**
+ * @struct WearFormula
+ * @brief Evaluador compacto de la fórmula de desgaste
+ */
+struct WearFormula {
+    /// Curva aplicada al desgaste bruto
+    enum Curve : quint8 {
+        Linear = 0,                 ///< Sin compresión (comportamiento histórico)
+        Sqrt = 1,                   ///< Raíz: comprime suave el uso intensivo
+        Log = 2                     ///< Logarítmica: comprime fuerte
+    };
+
+    float launchWeight = 1.0f;      ///< Desgaste por lanzamiento
+    float minuteWeight = 0.01f;     ///< Desgaste por minuto activo
+    Curve curve = Linear;           ///< Curva del nivel
+    float curveScale = 100.0f;      ///< Punto fijo de sqrt/log (> 0)
+    int cap = WearDecay::MAX_LEVEL; ///< Nivel máximo (0-MAX_LEVEL)
+
+    /// Desgaste bruto acumulativo (sin semivida)
+    float rawWear(int launches, qint64 activeSeconds) const
+    {
+        return launches * launchWeight + (activeSeconds / 60.0f) * minuteWeight;
+    }
+
+    /**
+     * @brief Desgaste bruto de un bloque de apps (estructura de arrays)
+     * @param launches Lanzamientos por app
+     * @param minutes Minutos activos por app
+     * @param raw Salida: desgaste bruto por app
+     * @param count Número de apps
+     */
+    void rawWear(const float *launches, const float *minutes, float *raw, int count) const
+    {
+        const float perLaunch = launchWeight;
+        const float perMinute = minuteWeight;
+        for (int i = 0; i < count; ++i) {
+            raw[i] = launches[i] * perLaunch + minutes[i] * perMinute;
+        }
+    }
+
+    /**
+     * @brief Niveles de un bloque de desgastes brutos contiguos
+     * @param raw Desgaste bruto por app
+     * @param out Salida: nivel entero (0-cap) por app
+     * @param count Número de apps
+     *
+     * La curva se elige fuera del bucle; cada bucle es aritmética sin
+     * ramas sobre arrays contiguos y el compilador lo vectoriza.
+     */
+    void levels(const float *raw, qint32 *out, int count) const
+    {
+        const float top = static_cast<float>(cap);
+        const float scale = curveScale;
+        const float inverseScale = 1.0f / curveScale;
+        switch (curve) {
+        case Linear:
+            for (int i = 0; i < count; ++i) {
+                out[i] = static_cast<qint32>(std::min(std::max(raw[i], 0.0f), top));
+            }
+            break;
+        case Sqrt:
+            for (int i = 0; i < count; ++i) {
+                out[i] = static_cast<qint32>(std::min(std::sqrt(std::max(raw[i], 0.0f) * scale), top));
+            }
+            break;
+        case Log:
+            for (int i = 0; i < count; ++i) {
+                out[i] = static_cast<qint32>(std::min(scale * std::log2(1.0f + std::max(raw[i], 0.0f) * inverseScale), top));
+            }
+            break;
+        }
+    }
+
+    /// Nivel de un desgaste bruto (mismo cálculo que levels())
+    int level(double raw) const
+    {
+        const float value = static_cast<float>(raw);
+        qint32 result = 0;
+        levels(&value, &result, 1);
+        return result;
+    }
+
+    /// Nivel en @p nowSecs de una puntuación con decaimiento (ver WearDecay::levelAt())
+    int levelAt(double score, qint64 stampSecs, qint64 nowSecs, qint64 halfLifeSeconds) const
+    {
+        return level(WearDecay::decayed(score, stampSecs, nowSecs, halfLifeSeconds));
+    }
+
+    /// Mismo nivel para cualquier desgaste (los pesos no cuentan)
+    bool sameShape(const WearFormula &other) const
+    {
+        return curve == other.curve && curveScale == other.curveScale && cap == other.cap;
+    }
+
+    bool operator==(const WearFormula &other) const
+    {
+        return sameShape(other) && launchWeight == other.launchWeight && minuteWeight == other.minuteWeight;
+    }
+
+    bool operator!=(const WearFormula &other) const { return !(*this == other); }
+
+    /**
+     * @brief Curva por nombre ("linear", "sqrt", "log")
+     * @param ok Salida: false si el nombre no es válido (se devuelve Linear)
+     */
+    static Curve curveFromName(const QString &name, bool *ok = nullptr)
+    {
+        const QString key = name.trimmed().toLower();
+        Curve result = Linear;
+        bool valid = true;
+        if (key == QLatin1String("sqrt")) {
+            result = Sqrt;
+        } else if (key == QLatin1String("log")) {
+            result = Log;
+        } else if (key != QLatin1String("linear")) {
+            valid = false;
+        }
+        if (ok) {
+            *ok = valid;
+        }
+        return result;
+    }
+
+    /// Nombre de configuración de una curva
+    static QString curveName(Curve curve)
+    {
+        switch (curve) {
+        case Sqrt:
+            return QStringLiteral("sqrt");
+        case Log:
+            return QStringLiteral("log");
+        case Linear:
+            break;
+        }
+        return QStringLiteral("linear");
+    }
+
+    /// Curva y parámetros recortados a valores utilizables
+    WearFormula sanitized() const
+    {
+        WearFormula result = *this;
+        result.launchWeight = std::isfinite(launchWeight) ? std::max(launchWeight, 0.0f) : 0.0f;
+        result.minuteWeight = std::isfinite(minuteWeight) ? std::max(minuteWeight, 0.0f) : 0.0f;
+        if (curve != Linear && curve != Sqrt && curve != Log) {
+            result.curve = Linear;
+        }
+        result.curveScale = std::isfinite(curveScale) && curveScale > 0.0f ? curveScale : 100.0f;
+        result.cap = qBound(0, cap, WearDecay::MAX_LEVEL);
+        return result;
+    }
+};
+
+#endif // WEARFORMULA_H
@@ -0,0 +1,64 @@
+/**
+ * @file wearmetrics.cpp
+ * @brief Serialización DBus de los tipos de métricas en lote
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "wearmetrics.h"
+#include <QDBusMetaType>
+
+QDBusArgument &operator<<(QDBusArgument &argument, const WearMetrics &metrics)
+{
+    argument.beginStructure();
+    argument << metrics.wearLevel
+             << metrics.launches
+             << metrics.reconstructions
+             << metrics.activeTimeSeconds
+             << metrics.lastOpenTime;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, WearMetrics &metrics)
+{
+    argument.beginStructure();
+    argument >> metrics.wearLevel
+             >> metrics.launches
+             >> metrics.reconstructions
+             >> metrics.activeTimeSeconds
+             >> metrics.lastOpenTime;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const UsageBucket &bucket)
+{
+    argument.beginStructure();
+    argument << bucket.start << bucket.launches << bucket.activeSeconds;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, UsageBucket &bucket)
+{
+    argument.beginStructure();
+    argument >> bucket.start >> bucket.launches >> bucket.activeSeconds;
+    argument.endStructure();
+    return argument;
+}
+
+void registerWearMetricsTypes()
+{
+    // moc guarda los tipos de slots y señales por su nombre escrito: los
+    // typedef necesitan su alias para conectar y serializar por nombre
+    // (p. ej. SLOT(onWearLevelsChanged(WearLevelMap)))
+    qRegisterMetaType<WearLevelMap>("WearLevelMap");
+    qRegisterMetaType<WearMetricsMap>("WearMetricsMap");
+    qRegisterMetaType<UsageBucketList>("UsageBucketList");
+
+    qDBusRegisterMetaType<WearMetrics>();
+    qDBusRegisterMetaType<WearMetricsMap>();
+    qDBusRegisterMetaType<WearLevelMap>();
+    qDBusRegisterMetaType<UsageBucket>();
+    qDBusRegisterMetaType<UsageBucketList>();
+}
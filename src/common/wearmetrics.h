@@ -0,0 +1,82 @@
+/**
+ * @file wearmetrics.h
+ * @brief Tipos DBus compartidos por las consultas en lote de IconWear
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Define las estructuras tipadas que viajan por DBus en las consultas
+ * batch de org.kde.iconwear.Tracker, evitando una llamada por appId.
+ */
+
+#ifndef WEARMETRICS_H
+#define WEARMETRICS_H
+
+#include <QDBusArgument>
+#include <QMap>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+/**
+ * @struct WearMetrics
+ * @brief Métricas de una aplicación en formato DBus compacto `(iiixx)`
+ * 
+ * | Firma | Campo                |
+ * |-------|----------------------|
+ * | i     | wearLevel            |
+ * | i     | launches             |
+ * | i     | reconstructions      |
+ * | x     | activeTimeSeconds    |
+ * | x     | lastOpenTime (epoch) |
+ */
+struct WearMetrics {
+    int wearLevel = 0;              ///< Nivel de desgaste normalizado (0-100)
+    int launches = 0;               ///< Número total de lanzamientos
+    int reconstructions = 0;        ///< Contador de resets
+    qint64 activeTimeSeconds = 0;   ///< Tiempo total activo en segundos
+    qint64 lastOpenTime = 0;        ///< Última apertura (segundos epoch, 0 si nunca)
+};
+
+/**
+ * @struct UsageBucket
+ * @brief Uso de una app en un intervalo (hora o día), firma DBus `(xii)`
+ * 
+ * | Firma | Campo                         |
+ * |-------|-------------------------------|
+ * | x     | start (segundos epoch, UTC)   |
+ * | i     | launches                      |
+ * | i     | activeSeconds                 |
+ */
+struct UsageBucket {
+    qint64 start = 0;               ///< Inicio del intervalo (segundos epoch)
+    int launches = 0;               ///< Lanzamientos en el intervalo
+    int activeSeconds = 0;          ///< Segundos activos en el intervalo
+};
+
+/// Serie de intervalos en orden cronológico, firma DBus `a(xii)`
+typedef QVector<UsageBucket> UsageBucketList;
+
+/// Mapa appId -> nivel de desgaste, firma DBus `a{si}`
+typedef QMap<QString, int> WearLevelMap;
+
+/// Mapa appId -> métricas, firma DBus `a{s(iiixx)}`
+typedef QMap<QString, WearMetrics> WearMetricsMap;
+
+Q_DECLARE_METATYPE(WearMetrics)
+Q_DECLARE_METATYPE(UsageBucket)
+
+QDBusArgument &operator<<(QDBusArgument &argument, const WearMetrics &metrics);
+const QDBusArgument &operator>>(const QDBusArgument &argument, WearMetrics &metrics);
+QDBusArgument &operator<<(QDBusArgument &argument, const UsageBucket &bucket);
+const QDBusArgument &operator>>(const QDBusArgument &argument, UsageBucket &bucket);
+
+/**
+ * @brief Registra los tipos de este archivo en el sistema de tipos de QtDBus
+ * 
+ * Debe llamarse una vez antes de exportar objetos que los usen. Registra
+ * también los typedef por su nombre (WearLevelMap, WearMetricsMap,
+ * UsageBucketList), que es como moc los anota en slots y señales.
+ */
+void registerWearMetricsTypes();
+
+#endif // WEARMETRICS_H
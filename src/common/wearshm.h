@@ -0,0 +1,126 @@
+/**
+ * @file wearshm.h
+ * @brief Formato del segmento de memoria compartida con la tabla de desgaste
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * El daemon publica sus métricas en un segmento POSIX (`shm_open`) por
+ * usuario para que los clientes locales lean niveles sin IPC: ni
+ * serialización DBus ni cambio de contexto al daemon. DBus queda para las
+ * mutaciones (resetWearLevel) y las notificaciones de cambio.
+ * 
+ * **Disposición:**
+ * ```
+ * WearShmHeader (64 bytes)
+ * WearShmEntry[capacity] (128 bytes cada una, tabla hash con sondeo lineal)
+ * ```
+ * 
+ * **Seqlock:** el escritor incrementa `sequence` (impar = escribiendo),
+ * modifica entradas e incrementa de nuevo (par = estable). El lector copia
+ * lo que necesita entre dos lecturas de `sequence` y reintenta si cambió o
+ * era impar. El escritor nunca espera a los lectores.
+ */
+
+#ifndef WEARSHM_H
+#define WEARSHM_H
+
+#include <QByteArray>
+
+#include <atomic>
+#include <cstring>
+
+namespace WearShm {
+
+/// "IWSH" en little-endian
+constexpr quint32 MAGIC = 0x48535749;
+
+/// Versión del formato; los lectores rechazan otras
+constexpr quint32 VERSION = 3;
+
+/// Longitud máxima del appId en UTF-8; los más largos solo están en DBus
+constexpr int MAX_APP_ID_BYTES = 82;
+
+/// Valores de WearShmHeader::state
+enum State : quint32 {
+    Closed = 0,                     ///< El daemon terminó; los datos pueden estar obsoletos
+    Live = 1                        ///< El daemon está publicando
+};
+
+/**
+ * @struct WearShmHeader
+ * @brief Cabecera del segmento
+ */
+struct WearShmHeader {
+    quint32 magic;                  ///< MAGIC
+    quint32 version;                ///< VERSION
+    std::atomic<quint32> sequence;  ///< Seqlock: impar mientras el daemon escribe
+    quint32 capacity;               ///< Entradas de la tabla (potencia de dos)
+    quint32 count;                  ///< Entradas ocupadas
+    quint32 state;                  ///< WearShm::State
+    qint64 writerPid;               ///< PID del daemon que publica
+    quint32 halfLifeSeconds;        ///< Semivida del desgaste (0 = sin decaimiento)
+    quint32 curve;                  ///< WearFormula::Curve del nivel
+    float curveScale;               ///< WearFormula::curveScale
+    qint32 levelCap;                ///< WearFormula::cap
+    quint8 reserved[16];
+};
+
+/**
+ * @struct WearShmEntry
+ * @brief Métricas de una app (entrada vacía: idLength == 0)
+ */
+struct WearShmEntry {
+    quint32 hash;                   ///< hashAppId() del appId
+    qint32 wearLevel;               ///< Nivel de desgaste (0-100) en wearStamp
+    qint32 launches;                ///< Lanzamientos
+    qint32 reconstructions;         ///< Resets
+    qint64 activeTimeSeconds;       ///< Tiempo activo total
+    qint64 lastOpenTime;            ///< Última apertura (segundos epoch)
+    qint64 wearStamp;               ///< Instante de wearScore (segundos epoch)
+    float wearScore;                ///< Desgaste sin recortar en wearStamp (ver weardecay.h)
+    quint16 idLength;               ///< Bytes válidos de appId
+    char appId[MAX_APP_ID_BYTES];   ///< appId en UTF-8, sin terminador
+};
+
+static_assert(sizeof(WearShmHeader) == 64, "WearShmHeader debe ocupar 64 bytes");
+static_assert(sizeof(WearShmEntry) == 128, "WearShmEntry debe ocupar 128 bytes");
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "El seqlock requiere atómicos sin bloqueo entre procesos");
+
+/// FNV-1a de 32 bits sobre el appId en UTF-8
+inline quint32 hashAppId(const char *data, int length)
+{
+    quint32 hash = 2166136261u;
+    for (int i = 0; i < length; ++i) {
+        hash ^= static_cast<quint8>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/// Tamaño en bytes de un segmento con @p capacity entradas
+inline size_t segmentSize(quint32 capacity)
+{
+    return sizeof(WearShmHeader) + size_t(capacity) * sizeof(WearShmEntry);
+}
+
+/// Primera entrada de la tabla
+inline WearShmEntry *entries(void *base)
+{
+    return reinterpret_cast<WearShmEntry *>(static_cast<char *>(base) + sizeof(WearShmHeader));
+}
+
+inline const WearShmEntry *entries(const void *base)
+{
+    return reinterpret_cast<const WearShmEntry *>(static_cast<const char *>(base) + sizeof(WearShmHeader));
+}
+
+/**
+ * @brief Nombre del segmento del usuario actual (p. ej. "/iconwear-1000")
+ * 
+ * La variable de entorno ICONWEAR_SHM_NAME lo sustituye (instancias de prueba).
+ */
+QByteArray segmentName();
+
+} // namespace WearShm
+
+#endif // WEARSHM_H
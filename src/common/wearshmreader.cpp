@@ -0,0 +1,187 @@
+/**
+ * @file wearshmreader.cpp
+ * @brief Implementación del lector de memoria compartida
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "wearshmreader.h"
+#include "wearformula.h"
+
+#include <QDateTime>
+#include <QThread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace WearShm;
+
+QByteArray WearShm::segmentName()
+{
+    // Permite aislar instancias de prueba (iconwear-loadgen) del daemon real
+    const QByteArray override = qgetenv("ICONWEAR_SHM_NAME");
+    if (!override.isEmpty()) {
+        return override.startsWith('/') ? override : '/' + override;
+    }
+    return QByteArrayLiteral("/iconwear-") + QByteArray::number(static_cast<quint64>(getuid()));
+}
+
+WearShmReader::~WearShmReader()
+{
+    close();
+}
+
+bool WearShmReader::open()
+{
+    if (m_map) {
+        return true;
+    }
+
+    m_fd = shm_open(segmentName().constData(), O_RDONLY, 0);
+    if (m_fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(WearShmHeader)) {
+        close();
+        return false;
+    }
+
+    m_mappedSize = static_cast<size_t>(info.st_size);
+    m_map = mmap(nullptr, m_mappedSize, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (m_map == MAP_FAILED) {
+        m_map = nullptr;
+        close();
+        return false;
+    }
+
+    const auto *header = static_cast<const WearShmHeader *>(m_map);
+    if (header->magic != MAGIC || header->version != VERSION) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WearShmReader::close()
+{
+    if (m_map) {
+        munmap(m_map, m_mappedSize);
+        m_map = nullptr;
+        m_mappedSize = 0;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool WearShmReader::isLive() const
+{
+    return m_map && static_cast<const WearShmHeader *>(m_map)->state == Live;
+}
+
+quint32 WearShmReader::generation() const
+{
+    if (!m_map) {
+        return 0;
+    }
+    return static_cast<const WearShmHeader *>(m_map)->sequence.load(std::memory_order_acquire) / 2;
+}
+
+//! El daemon solo agranda el segmento; basta con volver a mapear el fd abierto
+bool WearShmReader::ensureMapped(quint32 capacity)
+{
+    const size_t needed = segmentSize(capacity);
+    if (needed <= m_mappedSize) {
+        return true;
+    }
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0 || static_cast<size_t>(info.st_size) < needed) {
+        return false;  // Redimensionado en curso: reintentar
+    }
+
+    void *map = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    munmap(m_map, m_mappedSize);
+    m_map = map;
+    m_mappedSize = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+bool WearShmReader::read(const QString &appId, WearShmEntry *entry)
+{
+    // Un daemon nuevo crea otro segmento con el mismo nombre: si el mapeado
+    // quedó cerrado, volver a abrir
+    if (m_map && !isLive()) {
+        close();
+    }
+    if (!open() || !isLive()) {
+        return false;
+    }
+
+    const QByteArray id = appId.toUtf8();
+    if (id.isEmpty() || id.size() > MAX_APP_ID_BYTES) {
+        return false;
+    }
+    const quint32 hash = hashAppId(id.constData(), id.size());
+
+    for (int attempt = 0; attempt < MAX_RETRIES; ++attempt) {
+        const auto *header = static_cast<const WearShmHeader *>(m_map);
+        const quint32 before = header->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            QThread::yieldCurrentThread();  // El daemon está escribiendo
+            continue;
+        }
+
+        const quint32 capacity = header->capacity;
+        const quint32 halfLifeSeconds = header->halfLifeSeconds;
+        WearFormula formula;
+        formula.curve = static_cast<WearFormula::Curve>(header->curve);
+        formula.curveScale = header->curveScale;
+        formula.cap = header->levelCap;
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0 || !ensureMapped(capacity)) {
+            continue;
+        }
+
+        // Sondeo lineal; las lecturas pueden ver datos a medio escribir,
+        // el seqlock descarta el resultado en ese caso
+        header = static_cast<const WearShmHeader *>(m_map);
+        const WearShmEntry *table = entries(m_map);
+        const quint32 mask = capacity - 1;
+        bool found = false;
+        WearShmEntry copy;
+        for (quint32 probe = 0; probe < capacity; ++probe) {
+            const WearShmEntry &slot = table[(hash + probe) & mask];
+            if (slot.idLength == 0) {
+                break;
+            }
+            if (slot.hash == hash && slot.idLength == id.size()
+                && std::memcmp(slot.appId, id.constData(), id.size()) == 0) {
+                std::memcpy(&copy, &slot, sizeof(copy));
+                found = true;
+                break;
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        if (found) {
+            if (halfLifeSeconds > 0) {
+                // Misma curva y tope que el daemon (ver WearFormula)
+                copy.wearLevel = formula.sanitized().levelAt(copy.wearScore, copy.wearStamp,
+                                                             QDateTime::currentSecsSinceEpoch(), halfLifeSeconds);
+            }
+            *entry = copy;
+        }
+        return found;
+    }
+    return false;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file wearshmreader.h
+ * @brief Lector sin IPC de la tabla de desgaste en memoria compartida
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ */
+
+#ifndef WEARSHMREADER_H
+#define WEARSHMREADER_H
+
+#include <QString>
+
+#include "wearshm.h"
+
+/**
+ * @class WearShmReader
+ * @brief Mapea el segmento del daemon en solo lectura y consulta appIds
+ * 
+ * Cada lectura es una búsqueda hash en memoria protegida por el seqlock:
+ * sin llamadas al sistema salvo cuando el daemon agranda la tabla (se
+ * vuelve a mapear). Si el segmento no existe, el daemon lo cerró o el
+ * appId no cabe en WearShmEntry, las funciones devuelven false y el
+ * cliente debe recurrir a DBus.
+ * 
+ * Si el daemon muere sin cerrar el segmento, los datos quedan marcados
+ * como vivos; el cliente debería llamar a close() al ver desaparecer
+ * org.kde.iconwear del bus para que la siguiente lectura reabra.
+ * 
+ * @code
+ * WearShmReader reader;
+ * WearShmEntry entry;
+ * if (reader.open() && reader.read(QStringLiteral("firefox.desktop"), &entry)) {
+ *     use(entry.wearLevel);
+ * }
+ * @endcode
+ */
+class WearShmReader
+{
+public:
+    WearShmReader() = default;
+    ~WearShmReader();
+
+    WearShmReader(const WearShmReader &) = delete;
+    WearShmReader &operator=(const WearShmReader &) = delete;
+
+    /**
+     * @brief Abre y mapea el segmento (idempotente)
+     * @return true si el segmento existe y su formato es compatible
+     */
+    bool open();
+
+    /// Desmapea el segmento
+    void close();
+
+    /// El segmento está mapeado y el daemon sigue publicando
+    bool isLive() const;
+
+    /**
+     * @brief Lee las métricas de una app
+     * @param appId Identificador de la aplicación
+     * @param entry Copia consistente de la entrada (solo si devuelve true);
+     *        si el daemon usa decaimiento, wearLevel ya está evaluado al
+     *        instante de la lectura
+     * @return true si la app está publicada; false si no existe o no se
+     *         pudo leer (usar DBus)
+     */
+    bool read(const QString &appId, WearShm::WearShmEntry *entry);
+
+    /**
+     * @brief Contador de generación del seqlock
+     * 
+     * Cambia con cada publicación del daemon; permite saber si hay que
+     * releer sin tocar la tabla.
+     */
+    quint32 generation() const;
+
+private:
+    /// Vuelve a mapear si el daemon agrandó la tabla
+    bool ensureMapped(quint32 capacity);
+
+    /// Reintentos del seqlock antes de rendirse (el escritor es rápido)
+    static constexpr int MAX_RETRIES = 64;
+
+    int m_fd = -1;
+    void *m_map = nullptr;
+    size_t m_mappedSize = 0;
+};
+
+#endif // WEARSHMREADER_H
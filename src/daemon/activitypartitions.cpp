@@ -0,0 +1,119 @@
+/**
+ * @file activitypartitions.cpp
+ * @brief Implementación de las particiones de desgaste por actividad
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "activitypartitions.h"
+#include "snapshot.h"
+#include <QDebug>
+#include <QStandardPaths>
+
+ActivityPartitions::ActivityPartitions(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+QString ActivityPartitions::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+        + QStringLiteral("/iconwear/activities");
+}
+
+//! Los ids de KActivities son UUID; se rechaza todo lo que no sea seguro como nombre de archivo
+bool ActivityPartitions::isValidActivityId(const QString &activity)
+{
+    if (activity.isEmpty() || activity.size() > 64 || activity.startsWith(QLatin1Char('.'))) {
+        return false;
+    }
+    for (const QChar c : activity) {
+        if (!(c.isLetterOrNumber() && c.unicode() < 0x80) && c != QLatin1Char('-')
+            && c != QLatin1Char('_') && c != QLatin1Char('.')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ActivityPartitions::Partition *ActivityPartitions::acquire(const QString &activity, qint64 nowMs)
+{
+    auto it = m_partitions.find(activity);
+    if (it == m_partitions.end()) {
+        if (!isValidActivityId(activity)) {
+            return nullptr;
+        }
+        // Primera vez desde el arranque o tras un desalojo: cargar del disco
+        it = m_partitions.insert(activity, Partition());
+        loadFromDisk(m_directory, activity, it->store);
+        qDebug() << "Partición de actividad cargada:" << activity << "con" << it->store.size() << "apps";
+    }
+    it->lastUsedMs = nowMs;
+    return &it.value();
+}
+
+const ActivityPartitions::Partition *ActivityPartitions::resident(const QString &activity) const
+{
+    auto it = m_partitions.constFind(activity);
+    return it != m_partitions.constEnd() ? &it.value() : nullptr;
+}
+
+ActivityPartitions::Partition *ActivityPartitions::resident(const QString &activity)
+{
+    auto it = m_partitions.find(activity);
+    return it != m_partitions.end() ? &it.value() : nullptr;
+}
+
+qint64 ActivityPartitions::evictIdle(qint64 nowMs, qint64 idleMs, const QString &keep)
+{
+    qint64 bytesWritten = 0;
+    for (auto it = m_partitions.begin(); it != m_partitions.end();) {
+        if (it.key() == keep || nowMs - it->lastUsedMs < idleMs) {
+            ++it;
+            continue;
+        }
+        const qint64 bytes = save(it.key(), it.value());
+        if (bytes < 0) {
+            ++it;  // Se reintenta en el próximo desalojo; no perder datos
+            continue;
+        }
+        bytesWritten += bytes;
+        qDebug() << "Partición de actividad desalojada:" << it.key();
+        it = m_partitions.erase(it);
+    }
+    return bytesWritten;
+}
+
+qint64 ActivityPartitions::saveDirty()
+{
+    qint64 bytesWritten = 0;
+    for (auto it = m_partitions.begin(); it != m_partitions.end(); ++it) {
+        bytesWritten += qMax<qint64>(0, save(it.key(), it.value()));
+    }
+    return bytesWritten;
+}
+
+bool ActivityPartitions::loadFromDisk(const QString &directory, const QString &activity, AppStore &store)
+{
+    if (!isValidActivityId(activity)) {
+        store.clear();
+        return false;
+    }
+    return WearSnapshot::load(pathFor(directory, activity), store);
+}
+
+QString ActivityPartitions::pathFor(const QString &directory, const QString &activity)
+{
+    return directory + QLatin1Char('/') + activity + QStringLiteral(".snapshot");
+}
+
+qint64 ActivityPartitions::save(const QString &activity, Partition &partition) const
+{
+    if (!partition.dirty) {
+        return 0;
+    }
+    const qint64 bytes = WearSnapshot::write(pathFor(m_directory, activity), partition.store);
+    if (bytes >= 0) {
+        partition.dirty = false;
+    }
+    return bytes;
+}
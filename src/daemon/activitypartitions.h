@@ -0,0 +1,106 @@
+/**
+ * @file activitypartitions.h
+ * @brief Tablas de desgaste por actividad de KDE, cargadas bajo demanda
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * Cada actividad ("Trabajo", "Juegos"...) tiene su propio AppStore con el
+ * mismo formato que la tabla global, persistido como snapshot binario en
+ * ~/.local/share/iconwear/activities/<id>.snapshot. La tabla global sigue
+ * siendo el agregado de todas y es la que sirven las consultas de siempre.
+ */
+
+#ifndef ACTIVITYPARTITIONS_H
+#define ACTIVITYPARTITIONS_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "appstore.h"
+
+/**
+ * @class ActivityPartitions
+ * @brief Particiones residentes por actividad con carga perezosa y desalojo
+ *
+ * Solo están en memoria las particiones usadas recientemente: acquire()
+ * carga una partición del disco la primera vez que se necesita y
+ * evictIdle() guarda y libera las que llevan un tiempo sin usarse.
+ *
+ * Solo se usa desde el hilo del worker.
+ */
+class ActivityPartitions
+{
+public:
+    /**
+     * @struct Partition
+     * @brief Tabla de una actividad y su estado de residencia
+     */
+    struct Partition {
+        AppStore store;             ///< Métricas de las apps en esta actividad
+        qint64 lastUsedMs = 0;      ///< Último acquire() (reloj monotónico)
+        bool dirty = false;         ///< Cambios sin escribir a disco
+    };
+
+    /**
+     * @param directory Directorio de los snapshots por actividad
+     */
+    explicit ActivityPartitions(const QString &directory = defaultDirectory());
+
+    /// ~/.local/share/iconwear/activities
+    static QString defaultDirectory();
+
+    /// Id utilizable como nombre de archivo (UUID de KActivities o similar)
+    static bool isValidActivityId(const QString &activity);
+
+    /**
+     * @brief Partición de una actividad, cargándola si no está residente
+     * @param activity Id de la actividad (ver isValidActivityId())
+     * @param nowMs Reloj monotónico, para el desalojo por inactividad
+     * @return nullptr si el id no es válido
+     */
+    Partition *acquire(const QString &activity, qint64 nowMs);
+
+    /// Partición residente, o nullptr (nunca carga)
+    const Partition *resident(const QString &activity) const;
+    Partition *resident(const QString &activity);
+
+    /// Ids de las particiones en memoria
+    QStringList residentActivities() const { return m_partitions.keys(); }
+
+    /**
+     * @brief Guarda y libera las particiones sin uso en @p idleMs
+     * @param keep Actividad que nunca se desaloja (la actual)
+     * @return Bytes escritos al guardar las particiones modificadas
+     */
+    qint64 evictIdle(qint64 nowMs, qint64 idleMs, const QString &keep);
+
+    /// Escribe las particiones modificadas; devuelve los bytes escritos
+    qint64 saveDirty();
+
+    /// Particiones en memoria
+    int residentCount() const { return m_partitions.size(); }
+
+    /**
+     * @brief Lee la partición de una actividad directamente del disco
+     * @return false si no hay archivo válido (@p store queda vacío)
+     *
+     * Seguro desde cualquier hilo: no toca las particiones residentes.
+     */
+    static bool loadFromDisk(const QString &directory, const QString &activity, AppStore &store);
+
+    /// Directorio de los snapshots
+    QString directory() const { return m_directory; }
+
+private:
+    /// Ruta del snapshot de una actividad dentro de @p directory
+    static QString pathFor(const QString &directory, const QString &activity);
+
+    /// Escribe una partición; -1 si falló (sigue marcada como modificada)
+    qint64 save(const QString &activity, Partition &partition) const;
+
+    QString m_directory;
+    QHash<QString, Partition> m_partitions;
+};
+
+#endif // ACTIVITYPARTITIONS_H
@@ -0,0 +1,93 @@
+/**
+ * @file admissionfilter.cpp
+ * @brief Implementación del filtro de entrada de eventos
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "admissionfilter.h"
+
+namespace {
+
+/// Recursos con aperturas descartadas recordados a la vez; un recurso que
+/// nunca se cierra no debe hacer crecer la tabla sin límite
+constexpr int MAX_DROPPED_OPENS = 4096;
+
+} // namespace
+
+void AdmissionFilter::configure(const Config &config)
+{
+    m_ignoredAgents = QSet<QString>(config.ignoredAgents.begin(), config.ignoredAgents.end());
+    m_tokensPerMs = qMax(0, config.ratePerSecond) / 1000.0;
+    m_burst = qMax(1, config.burst);
+    m_tokens = m_burst;
+    m_lastRefillMs = 0;
+    m_droppedOpens.clear();
+}
+
+//! Camino por evento: un lookup en un QSet, un escaneo del esquema y aritmética
+AdmissionFilter::Verdict AdmissionFilter::admit(const QString &agent, const QString &resource, Kind kind, qint64 nowMs)
+{
+    if ((!m_ignoredAgents.isEmpty() && m_ignoredAgents.contains(agent)) || !isCandidateResource(resource)) {
+        return Filtered;
+    }
+
+    if (kind == Close) {
+        // El cierre de una apertura descartada tampoco entra
+        if (!m_droppedOpens.isEmpty()) {
+            auto it = m_droppedOpens.find(resource);
+            if (it != m_droppedOpens.end()) {
+                if (--it.value() == 0) {
+                    m_droppedOpens.erase(it);
+                }
+                return Throttled;
+            }
+        }
+        return Admitted;
+    }
+    if (m_tokensPerMs <= 0.0 || takeToken(nowMs)) {
+        return Admitted;
+    }
+
+    if (kind == Open && (m_droppedOpens.size() < MAX_DROPPED_OPENS || m_droppedOpens.contains(resource))) {
+        ++m_droppedOpens[resource];
+    }
+    return Throttled;
+}
+
+bool AdmissionFilter::takeToken(qint64 nowMs)
+{
+    // Recarga perezosa: solo se calcula cuando llega un evento
+    if (nowMs > m_lastRefillMs) {
+        m_tokens = qMin(m_burst, m_tokens + (nowMs - m_lastRefillMs) * m_tokensPerMs);
+        m_lastRefillMs = nowMs;
+    }
+    if (m_tokens < 1.0) {
+        return false;
+    }
+    m_tokens -= 1.0;
+    return true;
+}
+
+bool AdmissionFilter::isCandidateResource(const QString &resource)
+{
+    if (resource.isEmpty()) {
+        return false;
+    }
+    if (resource.startsWith(QLatin1Char('/'))) {
+        return true;
+    }
+
+    // Mismo criterio que AppResolver: las rutas relativas no son apps, y
+    // el esquema es lo que precede al primer ':'
+    for (int i = 0; i < resource.size(); ++i) {
+        const QChar c = resource.at(i);
+        if (c == QLatin1Char('/')) {
+            return false;
+        }
+        if (c == QLatin1Char(':')) {
+            const QStringRef scheme = resource.leftRef(i);
+            return scheme == QLatin1String("applications") || scheme == QLatin1String("file");
+        }
+    }
+    return true;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file admissionfilter.h
+ * @brief Filtro de entrada y límite de tasa para eventos de ActivityManager
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * ResourceOpened se emite por cada archivo o URL abierto, no solo por cada
+ * app lanzada: un indexador o una herramienta de copias puede mandar miles
+ * por segundo. AdmissionFilter decide en el hilo de UsageTracker, antes de
+ * copiar nada a la cola del worker, qué eventos merecen entrar.
+ */
+
+#ifndef ADMISSIONFILTER_H
+#define ADMISSIONFILTER_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class AdmissionFilter
+ * @brief Prefiltro por agente y esquema más un token bucket de admisión
+ *
+ * **Prefiltro** (sin tocar el sistema de archivos):
+ * - Agentes de General/ignoredAgents (p. ej. indexadores) → descartados
+ * - Recursos con esquema distinto de `applications:` y `file:` (http:,
+ *   smb:, trash:, ...) → descartados; nunca resuelven a una app
+ *
+ * **Admisión:** token bucket de General/admissionRate eventos por segundo
+ * con ráfagas de hasta General/admissionBurst. Se aplica a aperturas y
+ * cambios de foco. Un cierre no consume tokens, pero se descarta si su
+ * recurso tiene una apertura descartada pendiente: así aperturas y cierres
+ * que llegan al worker siguen emparejados y el contador de ventanas de la
+ * app no cierra la sesión antes de tiempo. Con la tasa a 0 no hay límite.
+ *
+ * Solo se usa desde el hilo productor: no necesita sincronización.
+ */
+class AdmissionFilter
+{
+public:
+    /// Resultado de admit()
+    enum Verdict {
+        Admitted,                   ///< Encolar hacia el worker
+        Filtered,                   ///< El prefiltro lo descartó (eventsFiltered)
+        Throttled                   ///< Sin tokens (eventsThrottled)
+    };
+
+    /// Tipo de evento, para decidir si consume tokens
+    enum Kind {
+        Open,                       ///< ResourceOpened: consume un token
+        Close,                      ///< ResourceClosed: empareja con una apertura descartada
+        Focus                       ///< ResourceFocused: consume un token
+    };
+
+    /**
+     * @struct Config
+     * @brief Parámetros leídos de [General] (ver TrackerWorker::loadConfig())
+     */
+    struct Config {
+        QStringList ignoredAgents;  ///< Agentes cuyos eventos se ignoran
+        int ratePerSecond = 0;      ///< Eventos admitidos por segundo (0 = sin límite)
+        int burst = 0;              ///< Capacidad del bucket (ráfaga máxima)
+    };
+
+    AdmissionFilter() = default;
+
+    /// Aplica la configuración; el bucket arranca lleno
+    void configure(const Config &config);
+
+    /**
+     * @brief Decide si un evento entra en la cola
+     * @param agent Agente de ActivityManager
+     * @param resource Recurso del evento
+     * @param kind Apertura, cierre o foco
+     * @param nowMs Reloj monotónico (TrackerWorker::monotonicMs())
+     */
+    Verdict admit(const QString &agent, const QString &resource, Kind kind, qint64 nowMs);
+
+    /// El recurso puede resolver a una app (ruta, nombre o esquema de app)
+    static bool isCandidateResource(const QString &resource);
+
+private:
+    /// Consume un token si hay; recarga el bucket antes
+    bool takeToken(qint64 nowMs);
+
+    QSet<QString> m_ignoredAgents;
+    QHash<QString, int> m_droppedOpens; ///< Aperturas descartadas aún sin su cierre, por recurso
+    double m_tokensPerMs = 0.0;     ///< Ritmo de recarga; 0 = sin límite
+    double m_burst = 0.0;
+    double m_tokens = 0.0;
+    qint64 m_lastRefillMs = 0;
+};
+
+#endif // ADMISSIONFILTER_H
@@ -0,0 +1,376 @@
+/**
+ * @file appresolver.cpp
+ * @brief Implementación del resolvedor de recursos a aplicaciones
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "appresolver.h"
+#include "perfcounters.h"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QUrl>
+
+namespace {
+
+const QString DESKTOP_SUFFIX = QStringLiteral(".desktop");
+const QString APPLICATIONS_SCHEME = QStringLiteral("applications:");
+
+/// Intérpretes y envoltorios: su nombre lo comparten muchas apps y no identifica ninguna
+bool isGenericLauncher(const QString &program)
+{
+    static const QSet<QString> launchers = {
+        QStringLiteral("sh"), QStringLiteral("bash"), QStringLiteral("dash"), QStringLiteral("zsh"),
+        QStringLiteral("ksh"), QStringLiteral("fish"), QStringLiteral("env"), QStringLiteral("flatpak"),
+        QStringLiteral("perl"), QStringLiteral("ruby"), QStringLiteral("node"), QStringLiteral("java"),
+        QStringLiteral("gjs"), QStringLiteral("mono"), QStringLiteral("wine"), QStringLiteral("sudo"),
+        QStringLiteral("pkexec"), QStringLiteral("kdesu"),
+    };
+    const QString name = program.section(QLatin1Char('/'), -1).toLower();
+    if (launchers.contains(name)) {
+        return true;
+    }
+
+    // python, python3, python3.12...
+    if (!name.startsWith(QLatin1String("python"))) {
+        return false;
+    }
+    for (int i = 6; i < name.size(); ++i) {
+        if (!name.at(i).isDigit() && name.at(i) != QLatin1Char('.')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Programa que lanza una línea Exec=
+/*!
+ * Salta `env [-u VAR] VAR=valor`, toma el id de la app de `flatpak run
+ * [--opción=valor] <id>` y devuelve vacío si lo que queda es un intérprete
+ * o un envoltorio (`sh -c ...`, `python3 script.py`).
+ */
+QString programFromExec(const QString &exec)
+{
+    const QStringList tokens = QProcess::splitCommand(exec);
+    bool flatpakRun = false;
+    for (int i = 0; i < tokens.size(); ++i) {
+        const QString &token = tokens.at(i);
+        if (token.contains(QLatin1Char('=')) || token.section(QLatin1Char('/'), -1) == QLatin1String("env")) {
+            continue;
+        }
+        if (token.startsWith(QLatin1Char('-'))) {
+            if (token == QLatin1String("-u") || token == QLatin1String("--unset")) {
+                ++i;
+            }
+            continue;
+        }
+        if (flatpakRun) {
+            return token;
+        }
+        if (token.section(QLatin1Char('/'), -1) == QLatin1String("flatpak")
+            && i + 1 < tokens.size() && tokens.at(i + 1) == QLatin1String("run")) {
+            flatpakRun = true;
+            ++i;
+            continue;
+        }
+        return isGenericLauncher(token) ? QString() : token;
+    }
+    return QString();
+}
+
+} // namespace
+
+AppResolver::AppResolver(PerfCounters &counters, int cacheSize, QObject *parent)
+    : QObject(parent)
+    , m_counters(counters)
+    , m_cache(qMax(1, cacheSize))
+{
+}
+
+//! Camino por evento: una búsqueda en la caché LRU
+QString AppResolver::resolve(const QString &resource)
+{
+    ensureIndex();
+
+    if (const QString *cached = m_cache.object(resource)) {
+        m_counters.resolverCacheHits.fetch_add(1, std::memory_order_relaxed);
+        return *cached;
+    }
+
+    m_counters.resolverCacheMisses.fetch_add(1, std::memory_order_relaxed);
+    const QString appId = resolveUncached(resource);
+    m_cache.insert(resource, new QString(appId));
+    return appId;
+}
+
+int AppResolver::indexedApps()
+{
+    ensureIndex();
+    return m_ids.size();
+}
+
+QString AppResolver::resolveUncached(const QString &resource) const
+{
+    QString path = resource.trimmed();
+    if (path.isEmpty()) {
+        return QString();
+    }
+
+    // Regla 1: ids de desktop explícitos
+    if (path.startsWith(APPLICATIONS_SCHEME)) {
+        QString id = path.mid(APPLICATIONS_SCHEME.size()).section(QLatin1Char('/'), -1);
+        if (!id.isEmpty() && !id.endsWith(DESKTOP_SUFFIX)) {
+            id += DESKTOP_SUFFIX;
+        }
+        return id;
+    }
+    if (path.startsWith(QLatin1String("file://"))) {
+        path = QUrl(path).toLocalFile();
+    }
+    if (path.endsWith(DESKTOP_SUFFIX)) {
+        return path.startsWith(QLatin1Char('/')) ? desktopIdForPath(path) : path.section(QLatin1Char('/'), -1);
+    }
+
+    // Regla 5 (pronto): URLs y rutas relativas no son apps
+    const bool absolute = path.startsWith(QLatin1Char('/'));
+    if (!absolute && (path.contains(QLatin1Char(':')) || path.contains(QLatin1Char('/')))) {
+        return QString();
+    }
+
+    // Regla 2: entrada .desktop con ese nombre o alias
+    const QString name = absolute ? path.section(QLatin1Char('/'), -1) : path;
+    if (m_ids.contains(name + DESKTOP_SUFFIX)) {
+        return name + DESKTOP_SUFFIX;
+    }
+    if (absolute) {
+        const QString byPath = m_aliases.value(path.toLower());
+        if (!byPath.isEmpty()) {
+            return byPath;
+        }
+    }
+    const QString byName = m_aliases.value(name.toLower());
+    if (!byName.isEmpty()) {
+        return byName;
+    }
+
+    // Regla 3: nombre suelto desconocido
+    if (!absolute) {
+        return path;
+    }
+
+    // Reglas 4 y 5: ejecutable sin entrada, o documento
+    const QFileInfo info(path);
+    return info.isFile() && info.isExecutable() ? name : QString();
+}
+
+QString AppResolver::desktopIdForPath(const QString &path) const
+{
+    for (const QString &root : m_roots) {
+        if (path.startsWith(root + QLatin1Char('/'))) {
+            QString id = path.mid(root.size() + 1);
+            id.replace(QLatin1Char('/'), QLatin1Char('-'));
+            return id;
+        }
+    }
+    return path.section(QLatin1Char('/'), -1);
+}
+
+void AppResolver::ensureIndex()
+{
+    if (m_indexed) {
+        return;
+    }
+    m_indexed = true;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Precedencia XDG: el directorio del usuario primero. Las exportaciones
+    // de flatpak suelen estar ya en XDG_DATA_DIRS; si no, van al final
+    m_roots = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+    const QStringList flatpakRoots = {
+        QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+            + QStringLiteral("/flatpak/exports/share/applications"),
+        QStringLiteral("/var/lib/flatpak/exports/share/applications"),
+    };
+    for (const QString &root : flatpakRoots) {
+        if (!m_roots.contains(root)) {
+            m_roots.append(root);
+        }
+    }
+    for (QString &root : m_roots) {
+        root = QDir::cleanPath(root);
+    }
+
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &AppResolver::onDirectoryChanged);
+
+    for (const QString &root : qAsConst(m_roots)) {
+        scanRoot(root);
+    }
+    rebuildLookup();
+
+    qDebug() << "Índice de aplicaciones:" << m_ids.size() << "entradas en" << timer.elapsed() << "ms";
+}
+
+void AppResolver::scanRoot(const QString &root)
+{
+    if (!QFileInfo(root).isDir()) {
+        m_entries.remove(root);
+        return;
+    }
+
+    const QHash<QString, DesktopEntry> previous = m_entries.value(root);
+    QHash<QString, DesktopEntry> current;
+    QStringList directories = {root};
+
+    QDirIterator it(root, QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.isDir()) {
+            directories.append(path);
+            continue;
+        }
+        if (!path.endsWith(DESKTOP_SUFFIX)) {
+            continue;
+        }
+
+        // Solo se vuelven a leer los archivos nuevos o modificados
+        const QDateTime modified = info.lastModified();
+        auto known = previous.constFind(path);
+        if (known != previous.constEnd() && known->modified == modified) {
+            current.insert(path, known.value());
+            continue;
+        }
+        QString id = path.mid(root.size() + 1);
+        id.replace(QLatin1Char('/'), QLatin1Char('-'));
+        DesktopEntry entry = parseDesktopFile(path, id);
+        entry.modified = modified;
+        current.insert(path, entry);
+    }
+    m_entries.insert(root, current);
+
+    // Vigilar también los subdirectorios nuevos
+    const QStringList watched = m_watcher->directories();
+    QStringList missing;
+    for (const QString &directory : qAsConst(directories)) {
+        if (!watched.contains(directory)) {
+            missing.append(directory);
+        }
+    }
+    if (!missing.isEmpty()) {
+        m_watcher->addPaths(missing);
+    }
+}
+
+void AppResolver::rebuildLookup()
+{
+    m_ids.clear();
+    m_aliases.clear();
+    QSet<QString> seen;
+
+    for (const QString &root : qAsConst(m_roots)) {
+        const QHash<QString, DesktopEntry> entries = m_entries.value(root);
+        for (const DesktopEntry &entry : entries) {
+            // Un id definido en un directorio de más precedencia oculta a este,
+            // incluso si allí está marcado Hidden
+            if (seen.contains(entry.id)) {
+                continue;
+            }
+            seen.insert(entry.id);
+            if (entry.hidden) {
+                continue;
+            }
+
+            m_ids.insert(entry.id);
+            for (const QString &alias : entry.aliases) {
+                if (!m_aliases.contains(alias)) {
+                    m_aliases.insert(alias, entry.id);
+                }
+            }
+        }
+    }
+}
+
+AppResolver::DesktopEntry AppResolver::parseDesktopFile(const QString &path, const QString &id)
+{
+    DesktopEntry entry;
+    entry.id = id;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        entry.hidden = true;
+        return entry;
+    }
+
+    auto addAlias = [&entry](const QString &value) {
+        if (value.isEmpty() || isGenericLauncher(value)) {
+            return;
+        }
+        entry.aliases.append(value.toLower());
+        if (value.startsWith(QLatin1Char('/'))) {
+            entry.aliases.append(value.section(QLatin1Char('/'), -1).toLower());
+        }
+    };
+
+    bool inDesktopEntry = false;
+    bool isApplication = false;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.startsWith(QLatin1Char('['))) {
+            // Solo interesa el primer grupo; los [Desktop Action ...] no
+            if (inDesktopEntry) {
+                break;
+            }
+            inDesktopEntry = line == QLatin1String("[Desktop Entry]");
+            continue;
+        }
+        if (!inDesktopEntry) {
+            continue;
+        }
+
+        const int equals = line.indexOf(QLatin1Char('='));
+        if (equals <= 0) {
+            continue;
+        }
+        const QStringRef key = line.leftRef(equals).trimmed();
+        const QString value = line.mid(equals + 1).trimmed();
+
+        if (key == QLatin1String("Type")) {
+            isApplication = value == QLatin1String("Application");
+        } else if (key == QLatin1String("Hidden")) {
+            entry.hidden = value == QLatin1String("true");
+        } else if (key == QLatin1String("Exec")) {
+            addAlias(programFromExec(value));
+        } else if (key == QLatin1String("TryExec") || key == QLatin1String("StartupWMClass")
+                   || key == QLatin1String("X-Flatpak")) {
+            addAlias(value);
+        }
+    }
+
+    if (!isApplication) {
+        entry.hidden = true;
+    }
+    return entry;
+}
+
+void AppResolver::onDirectoryChanged(const QString &directory)
+{
+    for (const QString &root : qAsConst(m_roots)) {
+        if (directory == root || directory.startsWith(root + QLatin1Char('/'))) {
+            scanRoot(root);
+            break;
+        }
+    }
+    rebuildLookup();
+
+    // Las resoluciones cacheadas pueden haber cambiado (app instalada o borrada)
+    m_cache.clear();
+}
@@ -0,0 +1,126 @@
+/**
+ * @file appresolver.h
+ * @brief Resolución de recursos de ActivityManager a ids de aplicación
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * ActivityManager informa de recursos muy distintos para una misma app:
+ * `/usr/bin/firefox`, `firefox.desktop`, `applications:firefox.desktop`, la
+ * exportación de flatpak... y también documentos. AppResolver los reduce
+ * al id canónico del archivo .desktop instalado (p. ej. "firefox.desktop")
+ * y descarta lo que no es una aplicación.
+ */
+
+#ifndef APPRESOLVER_H
+#define APPRESOLVER_H
+
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+class QFileSystemWatcher;
+struct PerfCounters;
+
+/**
+ * @class AppResolver
+ * @brief Índice de archivos .desktop instalados con caché LRU de resoluciones
+ * 
+ * **Coste por evento:** una búsqueda en la caché (QCache, LRU acotada).
+ * Solo los recursos nuevos consultan el índice, y solo los ejecutables
+ * desconocidos tocan el sistema de archivos.
+ * 
+ * **Índice:** se construye al primer uso (en el hilo del worker, no al
+ * arrancar el daemon) recorriendo los directorios XDG de aplicaciones.
+ * QFileSystemWatcher (inotify) avisa de cambios en un directorio; entonces
+ * solo se vuelven a leer los archivos nuevos o modificados de ese
+ * directorio y se vacía la caché.
+ * 
+ * **Reglas**, en orden:
+ * 1. `applications:<id>` y rutas o nombres `*.desktop` → id de desktop
+ *    (relativo al directorio de aplicaciones, con '/' → '-', o el nombre
+ *    del archivo si está fuera de ellos)
+ * 2. Nombres sueltos y rutas a ejecutables → app cuyo Exec, TryExec,
+ *    StartupWMClass o X-Flatpak coincida, o `<nombre>.desktop` si existe.
+ *    De Exec cuenta el programa real (`env VAR=x prog` → prog, `flatpak run
+ *    <id>` → id); intérpretes y envoltorios (sh, python3, env, flatpak...)
+ *    no son alias de nadie
+ * 3. Nombres sueltos desconocidos → se mantienen tal cual
+ * 4. Ejecutables sin entrada .desktop → nombre del ejecutable
+ * 5. Cualquier otra ruta o URL (documentos) → no es una app (cadena vacía)
+ */
+class AppResolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param counters Contadores de aciertos/fallos de la caché
+     * @param cacheSize Resoluciones en caché (General/resolverCacheSize)
+     */
+    AppResolver(PerfCounters &counters, int cacheSize, QObject *parent = nullptr);
+
+    /**
+     * @brief Id canónico de la app de un recurso
+     * @return Id de desktop, o cadena vacía si el recurso no es una app
+     */
+    QString resolve(const QString &resource);
+
+    /// Apps indexadas (construye el índice si aún no existe)
+    int indexedApps();
+
+private Q_SLOTS:
+    /// inotify: relee los archivos cambiados de un directorio
+    void onDirectoryChanged(const QString &directory);
+
+private:
+    /// Lo que interesa de un archivo .desktop
+    struct DesktopEntry {
+        QString id;                 ///< Id de desktop (con sufijo .desktop)
+        QStringList aliases;        ///< Exec, TryExec, StartupWMClass, X-Flatpak
+        QDateTime modified;         ///< mtime al leerlo
+        bool hidden = false;        ///< Hidden=true: la entrada está borrada
+    };
+
+    /// Construye el índice y empieza a vigilar los directorios
+    void ensureIndex();
+
+    /// (Re)lee los .desktop de @p root (con subdirectorios) reutilizando los no modificados
+    void scanRoot(const QString &root);
+
+    /// Rehace los mapas de búsqueda respetando la precedencia XDG
+    void rebuildLookup();
+
+    /// Lee las claves útiles del grupo [Desktop Entry]
+    static DesktopEntry parseDesktopFile(const QString &path, const QString &id);
+
+    /// Resolución sin caché
+    QString resolveUncached(const QString &resource) const;
+
+    /// Id de desktop de un archivo .desktop según su ubicación
+    QString desktopIdForPath(const QString &path) const;
+
+    PerfCounters &m_counters;
+
+    /// recurso -> id (vacío = no es app); LRU con coste 1 por entrada
+    QCache<QString, QString> m_cache;
+
+    /// Directorios de aplicaciones en orden de precedencia XDG
+    QStringList m_roots;
+
+    /// raíz -> (ruta del archivo -> entrada), para relecturas incrementales
+    QHash<QString, QHash<QString, DesktopEntry>> m_entries;
+
+    /// Ids instalados y visibles
+    QSet<QString> m_ids;
+
+    /// Alias (ejecutable, clase de ventana, id de flatpak) -> id
+    QHash<QString, QString> m_aliases;
+
+    QFileSystemWatcher *m_watcher = nullptr;
+    bool m_indexed = false;
+};
+
+#endif // APPRESOLVER_H
@@ -0,0 +1,130 @@
+/**
+ * @file appstore.cpp
+ * @brief Implementación del almacén compacto de métricas
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "appstore.h"
+
+#include <QtMath>
+
+namespace {
+
+/// Altas que m_recent acumula como mínimo antes de fundirse con el índice
+constexpr int RECENT_MERGE_MIN = 64;
+
+} // namespace
+
+AppHandle AppStore::intern(const QString &appId)
+{
+    const AppHandle indexed = findIndexed(appId);
+    if (indexed != InvalidHandle) {
+        return indexed;
+    }
+
+    // Primera escritura de una app del snapshot: desde ahora, búsqueda hash
+    if (m_mapped) {
+        const AppHandle mapped = m_mapped->find(appId);
+        if (mapped != InvalidHandle) {
+            addToIndex(appId, mapped);
+            return mapped;
+        }
+    }
+
+    // Una página nueva por cada PAGE_SIZE apps; escribir en la última solo
+    // copia esa página si el almacén está publicado
+    const AppHandle handle = m_size++;
+    if ((handle & PAGE_MASK) == 0) {
+        m_records.append(QVector<AppWearInfo>());
+    }
+    m_records.last().append(AppWearInfo());
+    const int slot = handle - m_mappedCount;
+    if ((slot & PAGE_MASK) == 0) {
+        m_appIds.append(QVector<QString>());
+    }
+    m_appIds.last().append(appId);
+    addToIndex(appId, handle);
+    return handle;
+}
+
+AppHandle AppStore::find(const QString &appId) const
+{
+    const AppHandle handle = findIndexed(appId);
+    if (handle != InvalidHandle || !m_mapped) {
+        return handle;
+    }
+    return m_mapped->find(appId);
+}
+
+AppHandle AppStore::findIndexed(const QString &appId) const
+{
+    if (!m_recent.isEmpty()) {
+        auto it = m_recent.constFind(appId);
+        if (it != m_recent.constEnd()) {
+            return it.value();
+        }
+    }
+    return m_index.value(appId, InvalidHandle);
+}
+
+QString AppStore::appId(AppHandle handle) const
+{
+    if (handle < m_mappedCount) {
+        return m_mapped->appId(handle);
+    }
+    const int slot = handle - m_mappedCount;
+    return m_appIds.at(slot >> PAGE_SHIFT).at(slot & PAGE_MASK);
+}
+
+//! Con m_index compartido por un estado publicado, insertar lo copiaría entero
+void AppStore::addToIndex(const QString &appId, AppHandle handle)
+{
+    if (m_index.isDetached()) {
+        m_index.insert(appId, handle);
+        return;
+    }
+
+    // m_recent también se publica, así que cada alta puede copiarlo; con
+    // fundirlo al pasar de √N entradas, copiar m_recent y repartir la copia
+    // de m_index entre las altas cuestan O(√N) por alta
+    m_recent.insert(appId, handle);
+    if (m_recent.size() > qMax(RECENT_MERGE_MIN, int(qSqrt(m_index.size())))) {
+        for (auto it = m_recent.constBegin(); it != m_recent.constEnd(); ++it) {
+            m_index.insert(it.key(), it.value());
+        }
+        m_recent.clear();
+    }
+}
+
+void AppStore::reserve(int count)
+{
+    m_index.reserve(count);
+    m_appIds.reserve((count + PAGE_MASK) >> PAGE_SHIFT);
+    m_records.reserve((count + PAGE_MASK) >> PAGE_SHIFT);
+}
+
+void AppStore::clear()
+{
+    m_mapped.reset();
+    m_mappedCount = 0;
+    m_index.clear();
+    m_recent.clear();
+    m_appIds.clear();
+    m_records.clear();
+    m_size = 0;
+}
+
+//! Sin un QString ni una inserción en hash por app: solo las páginas de métricas
+void AppStore::adoptIds(QSharedPointer<const AppIdTable> ids)
+{
+    clear();
+    m_mapped = std::move(ids);
+    m_mappedCount = m_mapped->size();
+    m_size = m_mappedCount;
+
+    const int pages = (m_size + PAGE_MASK) >> PAGE_SHIFT;
+    m_records.reserve(pages);
+    for (int page = 0; page < pages; ++page) {
+        m_records.append(QVector<AppWearInfo>(qMin(PAGE_SIZE, m_size - (page << PAGE_SHIFT))));
+    }
+}
@@ -0,0 +1,172 @@
+/**
+ * @file appstore.h
+ * @brief Almacén compacto de métricas de desgaste con appIds internados
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Cada appId se interna una sola vez (al entrar el evento) a un handle
+ * entero. Las métricas viven en una tabla plana indexada por handle, de
+ * modo que el resto del daemon trabaja con enteros en lugar de recorrer
+ * árboles con claves de texto.
+ */
+
+#ifndef APPSTORE_H
+#define APPSTORE_H
+
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+/// Handle entero de una aplicación internada (índice en AppStore)
+typedef int AppHandle;
+
+/**
+ * @struct AppWearInfo
+ * @brief Información de desgaste para una aplicación individual
+ * 
+ * Estructura que almacena todas las métricas relacionadas con el desgaste
+ * de una aplicación. El desgaste total se calcula como:
+ * 
+ * @code
+ * desgaste = (launches * launchWeight) + (activeMinutes * minuteWeight)
+ * @endcode
+ * 
+ * con los pesos, la curva y el tope de [WearFormula] (ver wearformula.h).
+ * 
+ * Con semivida configurada (General/wearHalfLifeHours) el desgaste decae:
+ * wearScore/wearStamp guardan la puntuación acumulada y el instante en que
+ * se tomó, y el nivel actual se evalúa al leer (ver weardecay.h).
+ * 
+ * Los timestamps se guardan como segundos epoch (0 = nunca) para que el
+ * registro sea POD de 56 bytes, sin asignaciones en el heap.
+ * 
+ * @see UsageTracker::updateWearLevel()
+ */
+struct AppWearInfo {
+    qint64 activeTimeSeconds = 0;   ///< Tiempo total activo en segundos
+    qint64 lastOpenTime = 0;        ///< Última apertura (segundos epoch, 0 si nunca)
+    qint64 lastResetTime = 0;       ///< Último reset (segundos epoch, 0 si nunca)
+    qint64 wearStamp = 0;           ///< Instante de wearScore (segundos epoch, 0 si nunca)
+    float wearScore = 0.0f;         ///< Desgaste sin recortar en wearStamp (modo con decaimiento)
+    qint32 wearLevel = 0;           ///< Nivel de desgaste normalizado (0-100) en wearStamp
+    qint32 launches = 0;            ///< Número total de lanzamientos de la app
+    qint32 reconstructions = 0;     ///< Contador de veces que fue reseteada
+    bool dirty = false;             ///< Cambios pendientes de escribir en KConfig
+};
+
+/**
+ * @class AppIdTable
+ * @brief appIds de solo lectura para los primeros handles de un AppStore
+ * 
+ * WearSnapshot la implementa sobre el archivo mapeado: cargar un snapshot
+ * no crea un QString ni inserta en un hash por app. Es inmutable, así que
+ * las copias publicadas del almacén la comparten entre hilos.
+ */
+class AppIdTable
+{
+public:
+    virtual ~AppIdTable() = default;
+
+    /// Número de appIds; cubren los handles [0, size())
+    virtual int size() const = 0;
+
+    /// appId de un handle de la tabla (se decodifica en cada llamada)
+    virtual QString appId(AppHandle handle) const = 0;
+
+    /// Handle de @p appId, o -1 (AppStore::InvalidHandle) si no está
+    virtual AppHandle find(const QString &appId) const = 0;
+};
+
+/**
+ * @class AppStore
+ * @brief Tabla plana de AppWearInfo con búsqueda hash O(1) por appId
+ * 
+ * Los handles son estables mientras viva el almacén: una app internada
+ * nunca cambia de índice. Para recorrer todas las apps:
+ * 
+ * @code
+ * for (AppHandle h = 0; h < store.size(); ++h) {
+ *     const AppWearInfo &info = store.info(h);
+ * }
+ * @endcode
+ * 
+ * **Copias:** el almacén es implícitamente compartido por páginas de
+ * PAGE_SIZE registros. Tras publicar una copia (WearState), escribir en una
+ * app duplica solo su página y la lista de páginas, no la tabla entera. Las
+ * apps nuevas van a un índice pequeño (m_recent) mientras el índice
+ * principal esté compartido, y se funden con él al pasar de √N entradas;
+ * así un alta tampoco copia el hash completo en cada lote.
+ * 
+ * **Apps de un snapshot:** tras adoptIds() los primeros handles toman su
+ * appId de una AppIdTable (el snapshot mapeado) en lugar de m_appIds y
+ * m_index. find() los busca en ella (búsqueda binaria) y intern() los pasa
+ * al índice hash la primera vez que se escribe en ellos.
+ */
+class AppStore
+{
+public:
+    /// Handle devuelto por find() cuando la app no está registrada
+    static constexpr AppHandle InvalidHandle = -1;
+
+    /**
+     * @brief Obtiene el handle de una app, registrándola si no existía
+     * @param appId Identificador de la aplicación
+     * @return Handle estable de la app
+     */
+    AppHandle intern(const QString &appId);
+
+    /**
+     * @brief Busca el handle de una app sin registrarla
+     * @param appId Identificador de la aplicación
+     * @return Handle de la app, o InvalidHandle si no existe
+     */
+    AppHandle find(const QString &appId) const;
+
+    /// Métricas de la app (el handle debe ser válido); solo copia su página si está compartida
+    AppWearInfo &info(AppHandle handle) { return m_records[handle >> PAGE_SHIFT][handle & PAGE_MASK]; }
+    const AppWearInfo &info(AppHandle handle) const { return m_records.at(handle >> PAGE_SHIFT).at(handle & PAGE_MASK); }
+
+    /// Identificador de texto de la app (el handle debe ser válido)
+    QString appId(AppHandle handle) const;
+
+    /// Número de apps registradas; los handles válidos son [0, size())
+    int size() const { return m_size; }
+
+    /// Reserva espacio para @p count apps (evita realojamientos en carga)
+    void reserve(int count);
+
+    /// Elimina todas las apps e invalida todos los handles
+    void clear();
+
+    /**
+     * @brief Registra las apps de @p ids sin internarlas
+     * @param ids appIds de los handles [0, ids->size())
+     * 
+     * Vacía el almacén antes; las métricas de esas apps quedan a cero para
+     * que el cargador las rellene con info() (ver WearSnapshot::load()).
+     */
+    void adoptIds(QSharedPointer<const AppIdTable> ids);
+
+private:
+    /// Registros por página: 256 × 56 bytes, lo que copia una escritura tras publicar
+    static constexpr int PAGE_SHIFT = 8;
+    static constexpr int PAGE_SIZE = 1 << PAGE_SHIFT;
+    static constexpr int PAGE_MASK = PAGE_SIZE - 1;
+
+    /// Busca solo en m_recent y m_index (sin la tabla mapeada)
+    AppHandle findIndexed(const QString &appId) const;
+
+    /// Añade @p appId al índice sin copiar m_index si está compartido
+    void addToIndex(const QString &appId, AppHandle handle);
+
+    QSharedPointer<const AppIdTable> m_mapped; ///< appIds de los handles [0, m_mappedCount)
+    int m_mappedCount = 0;
+    QHash<QString, AppHandle> m_index;   ///< appId -> handle
+    QHash<QString, AppHandle> m_recent;  ///< Altas hechas con m_index compartido, aún sin fundir
+    QVector<QVector<QString>> m_appIds;  ///< Páginas (handle - m_mappedCount) -> appId
+    QVector<QVector<AppWearInfo>> m_records; ///< Páginas handle -> métricas
+    int m_size = 0;                      ///< Apps registradas
+};
+
+#endif // APPSTORE_H
@@ -0,0 +1,202 @@
+/**
+ * @file importbench.cpp
+ * @brief Fixture sintético de kactivitymanagerd y benchmark de la importación masiva
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ *
+ * Genera una base de datos SQLite con el esquema de ResourceEvent de
+ * kactivitymanagerd (aperturas de apps y de documentos repartidas en tres
+ * actividades y tres años) y mide KamdImporter con distinto número de
+ * hilos, más la importación completa de TrackerWorker hasta disco.
+ *
+ * Usa QStandardPaths en modo test, así que nunca toca el estado real.
+ *
+ * **Uso:**
+ * ```bash
+ * ./iconwear-importbench                     # 100000 y 1000000 eventos
+ * ./iconwear-importbench 5000000             # tamaños personalizados
+ * ./iconwear-importbench --fixture kamd.db 1000000
+ * iconwear-daemon --import-kamd --kamd-database kamd.db
+ * ```
+ *
+ * Cada resultado es una línea JSON en stdout:
+ * `{"benchmark":"kamdRead","events":1000000,"threads":4,"ms":...,"eventsPerSec":...}`
+ */
+
+#include "kamdimporter.h"
+#include "perfcounters.h"
+#include "snapshot.h"
+#include "trackerworker.h"
+#include "usagehistory.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QVariantList>
+
+#include <cstdio>
+
+namespace {
+
+/// Apps distintas del fixture
+constexpr int FIXTURE_APPS = 500;
+
+/// Filas por lote de inserción (execBatch)
+constexpr int INSERT_BATCH = 10000;
+
+/**
+ * @brief Escribe una base de datos con el esquema de kactivitymanagerd
+ * @return false si no se pudo crear
+ *
+ * Uso Zipf aproximado (pocas apps concentran casi todo), 25% de eventos de
+ * documentos abiertos por una app y duraciones de hasta dos horas.
+ */
+bool writeFixture(const QString &path, int events)
+{
+    QFile::remove(path);
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("fixture"));
+        db.setDatabaseName(path);
+        if (db.open()) {
+            QSqlQuery query(db);
+            ok = query.exec(QStringLiteral("CREATE TABLE ResourceEvent (usedActivity TEXT, initiatingAgent TEXT, "
+                                           "targetedResource TEXT, start INTEGER, end INTEGER)"));
+
+            const QStringList activities = {
+                QStringLiteral("0b7c3f2e-8a1d-4c5e-9f60-1a2b3c4d5e6f"),
+                QStringLiteral("5d9e1a7b-2c3f-4e8d-b0a1-6f5e4d3c2b1a"),
+                QStringLiteral("c4a2e6f8-1b3d-4f5a-8c7e-9d0b1a2c3e4f"),
+            };
+            const qint64 now = QDateTime::currentSecsSinceEpoch();
+            const qint64 history = 3 * 365 * 86400LL;
+            QRandomGenerator rng(42);
+
+            db.transaction();
+            query.prepare(QStringLiteral("INSERT INTO ResourceEvent VALUES (?, ?, ?, ?, ?)"));
+            for (int done = 0; ok && done < events; done += INSERT_BATCH) {
+                QVariantList activityColumn, agentColumn, resourceColumn, startColumn, endColumn;
+                const int rows = qMin(INSERT_BATCH, events - done);
+                for (int i = 0; i < rows; ++i) {
+                    // u^3 concentra el uso en las primeras apps
+                    const double u = rng.generateDouble();
+                    const int app = static_cast<int>(u * u * u * FIXTURE_APPS);
+                    const QString agent = QStringLiteral("org.example.app%1").arg(app);
+                    const bool document = rng.bounded(4) == 0;
+                    const qint64 start = now - static_cast<qint64>(rng.bounded(static_cast<quint32>(history)));
+
+                    activityColumn.append(activities.at(static_cast<int>(rng.bounded(activities.size()))));
+                    agentColumn.append(document ? agent : QStringLiteral("org.kde.plasmashell"));
+                    resourceColumn.append(document
+                        ? QStringLiteral("file:///home/user/Documents/doc%1.odt").arg(rng.bounded(20000))
+                        : QStringLiteral("applications:%1.desktop").arg(agent));
+                    startColumn.append(start);
+                    endColumn.append(start + rng.bounded(7200));
+                }
+                query.addBindValue(activityColumn);
+                query.addBindValue(agentColumn);
+                query.addBindValue(resourceColumn);
+                query.addBindValue(startColumn);
+                query.addBindValue(endColumn);
+                ok = query.execBatch();
+            }
+            ok = ok && db.commit();
+            if (!ok) {
+                std::fprintf(stderr, "fixture: %s\n", qPrintable(query.lastError().text()));
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("fixture"));
+    return ok;
+}
+
+void report(const char *name, int events, int threads, qint64 ns)
+{
+    QJsonObject result;
+    result[QStringLiteral("benchmark")] = QString::fromLatin1(name);
+    result[QStringLiteral("events")] = events;
+    result[QStringLiteral("threads")] = threads;
+    result[QStringLiteral("ms")] = ns / 1e6;
+    result[QStringLiteral("eventsPerSec")] = ns > 0 ? events * 1e9 / ns : 0.0;
+    std::printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+    std::fflush(stdout);
+}
+
+void benchImport(const QString &path, int events)
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const int maxThreads = qMax(1, QThread::idealThreadCount());
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        KamdImporter importer(path, threads, 0, now);
+        QElapsedTimer timer;
+        timer.start();
+        if (!importer.run()) {
+            std::fprintf(stderr, "kamdRead: %s\n", qPrintable(importer.errorString()));
+            return;
+        }
+        report("kamdRead", events, importer.threadsUsed(), timer.nsecsElapsed());
+    }
+
+    // Camino completo: lectura, resolución, desgaste y guardado (modo test)
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+                  + QStringLiteral("/iconwearrc"));
+    QFile::remove(WearSnapshot::defaultPath());
+    QFile::remove(UsageHistory::defaultPath());
+    PerfCounters counters;
+    TrackerWorker worker(counters, true);
+    QElapsedTimer timer;
+    timer.start();
+    worker.importKamdDatabase(path, maxThreads);
+    report("importKamdDatabase", events, maxThreads, timer.nsecsElapsed());
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("iconwear-importbench"));
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+
+    QStringList args = app.arguments().mid(1);
+
+    // Solo generar el fixture, para usarlo con iconwear-daemon --import-kamd
+    if (args.size() >= 2 && args.first() == QLatin1String("--fixture")) {
+        const int events = args.size() > 2 ? qMax(1, args.at(2).toInt()) : 1000000;
+        return writeFixture(args.at(1), events) ? 0 : 1;
+    }
+
+    QVector<int> sizes;
+    for (const QString &arg : qAsConst(args)) {
+        bool ok = false;
+        const int size = arg.toInt(&ok);
+        if (ok && size > 0) {
+            sizes.append(size);
+        }
+    }
+    if (sizes.isEmpty()) {
+        sizes = {100000, 1000000};
+    }
+
+    QTemporaryDir dir;
+    for (int events : sizes) {
+        const QString path = dir.filePath(QStringLiteral("kamd-%1.db").arg(events));
+        if (!writeFixture(path, events)) {
+            return 1;
+        }
+        benchImport(path, events);
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file storebench.cpp
+ * @brief Benchmark de memoria y búsqueda: AppStore frente al QMap anterior
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * 
+ * Compara el layout original (`QMap<QString, AppWearInfo>` con dos
+ * QDateTime por entrada y búsquedas `contains()` + `operator[]`) con el
+ * almacén internado AppStore, para 1k/10k/100k aplicaciones.
+ * 
+ * **Uso:**
+ * ```bash
+ * ./iconwear-storebench            # 1000 10000 100000 apps
+ * ./iconwear-storebench 5000 50000 # tamaños personalizados
+ * ```
+ * 
+ * Cada resultado se imprime como una línea JSON en stdout.
+ */
+
+#include "appstore.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+
+#include <cstdio>
+#include <malloc.h>
+
+namespace {
+
+/// Layout de AppWearInfo anterior a AppStore, reproducido para comparar
+struct LegacyAppWearInfo {
+    int wearLevel = 0;
+    int launches = 0;
+    qint64 activeTimeSeconds = 0;
+    int reconstructions = 0;
+    QDateTime lastOpenTime;
+    QDateTime lastResetTime;
+};
+
+/// Número de búsquedas por medición
+constexpr int LOOKUPS = 1000000;
+
+//! Bytes actualmente reservados en el heap (0 si la libc no lo expone)
+qint64 heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return static_cast<qint64>(mallinfo2().uordblks);
+#else
+    return 0;
+#endif
+}
+
+void report(const QString &layout, int apps, qint64 bytes, double lookupNs, double handleNs)
+{
+    QJsonObject result;
+    result[QStringLiteral("benchmark")] = QStringLiteral("store");
+    result[QStringLiteral("layout")] = layout;
+    result[QStringLiteral("apps")] = apps;
+    result[QStringLiteral("heapBytes")] = bytes;
+    result[QStringLiteral("bytesPerApp")] = apps > 0 ? static_cast<double>(bytes) / apps : 0.0;
+    result[QStringLiteral("lookupNs")] = lookupNs;
+    if (handleNs >= 0) {
+        result[QStringLiteral("handleAccessNs")] = handleNs;
+    }
+    std::printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+    std::fflush(stdout);
+}
+
+void benchLegacy(const QStringList &appIds, const QVector<int> &pattern)
+{
+    const qint64 before = heapInUse();
+    auto *map = new QMap<QString, LegacyAppWearInfo>;
+    const QDateTime now = QDateTime::currentDateTime();
+    for (const QString &appId : appIds) {
+        LegacyAppWearInfo info;
+        info.lastOpenTime = now;
+        info.lastResetTime = now;
+        map->insert(appId, info);
+    }
+    const qint64 bytes = heapInUse() - before;
+
+    // Patrón del código original: contains() seguido de operator[]
+    QElapsedTimer timer;
+    timer.start();
+    for (int index : pattern) {
+        const QString &appId = appIds.at(index);
+        if (map->contains(appId)) {
+            (*map)[appId].launches++;
+        }
+    }
+    const double lookupNs = static_cast<double>(timer.nsecsElapsed()) / pattern.size();
+
+    report(QStringLiteral("qmap"), appIds.size(), bytes, lookupNs, -1);
+    delete map;
+}
+
+void benchStore(const QStringList &appIds, const QVector<int> &pattern)
+{
+    const qint64 before = heapInUse();
+    auto *store = new AppStore;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (const QString &appId : appIds) {
+        AppWearInfo &info = store->info(store->intern(appId));
+        info.lastOpenTime = now;
+        info.lastResetTime = now;
+    }
+    const qint64 bytes = heapInUse() - before;
+
+    // Búsqueda por texto en la entrada (una sola búsqueda hash)
+    QElapsedTimer timer;
+    timer.start();
+    for (int index : pattern) {
+        const AppHandle handle = store->find(appIds.at(index));
+        if (handle != AppStore::InvalidHandle) {
+            store->info(handle).launches++;
+        }
+    }
+    const double lookupNs = static_cast<double>(timer.nsecsElapsed()) / pattern.size();
+
+    // Acceso por handle ya internado (camino interno del daemon)
+    timer.restart();
+    for (int index : pattern) {
+        store->info(index).launches++;
+    }
+    const double handleNs = static_cast<double>(timer.nsecsElapsed()) / pattern.size();
+
+    report(QStringLiteral("appstore"), appIds.size(), bytes, lookupNs, handleNs);
+    delete store;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QVector<int> sizes;
+    const QStringList args = app.arguments().mid(1);
+    for (const QString &arg : args) {
+        bool ok = false;
+        const int size = arg.toInt(&ok);
+        if (ok && size > 0) {
+            sizes.append(size);
+        }
+    }
+    if (sizes.isEmpty()) {
+        sizes = {1000, 10000, 100000};
+    }
+
+    for (int size : sizes) {
+        QStringList appIds;
+        appIds.reserve(size);
+        for (int i = 0; i < size; ++i) {
+            appIds.append(QStringLiteral("org.example.application%1.desktop").arg(i));
+        }
+
+        // Mismo patrón de acceso aleatorio para ambos layouts
+        QVector<int> pattern(LOOKUPS);
+        QRandomGenerator rng(42);
+        for (int &index : pattern) {
+            index = static_cast<int>(rng.bounded(size));
+        }
+
+        benchLegacy(appIds, pattern);
+        benchStore(appIds, pattern);
+    }
+
+    return 0;
+}
@@ -0,0 +1,411 @@
+/**
+ * @file trackerbench.cpp
+ * @brief Microbenchmarks de los caminos críticos de UsageTracker
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * 
+ * Mide de forma aislada, sin sesión de Plasma, los caminos que más se
+ * ejecutan en el daemon:
+ * 
+ * | Benchmark                 | Qué mide                                   |
+ * |---------------------------|--------------------------------------------|
+ * | onResourceOpened          | Eventos de apertura por segundo            |
+ * | resourceStorm             | Ráfaga de una app: admisión + agrupación   |
+ * | eventQueue                | Encolar + vaciar en ráfagas (por evento)   |
+ * | updateWearLevel           | Recalcular el desgaste de una app          |
+ * | updateRank                | Sumar desgaste y recolocar en el ranking   |
+ * | recomputeAllLevels        | Pasada por lotes tras cambiar la fórmula   |
+ * | publishThenWrite          | Publicar un estado y escribir en una app   |
+ * | publishThenIntern         | Publicar un estado y registrar una app     |
+ * | checkActiveApplications   | Checkpoint con N sesiones abiertas         |
+ * | saveConfig                | Guardado con N apps modificadas            |
+ * | loadConfig.snapshot       | Carga de N apps desde el snapshot binario  |
+ * | loadConfig.kconfig        | Carga de N apps desde iconwearrc           |
+ * | demoteColdApps            | Degradar el 90% de N apps (una pasada)     |
+ * | saveConfig.coldTier       | Guardado con solo el 10% residente         |
+ * | exportDataset.json        | Volcado completo a /dev/null (NDJSON)      |
+ * | exportDataset.binary      | Volcado completo a /dev/null (binario)     |
+ * | getMetrics.cold           | Serialización JSON sin caché               |
+ * | getMetrics.cached         | Respuesta JSON desde la caché              |
+ * 
+ * Usa QStandardPaths en modo test, así que nunca toca ~/.config/iconwearrc.
+ * 
+ * **Uso:**
+ * ```bash
+ * ./iconwear-bench                 # N = 100 1000 10000
+ * ./iconwear-bench 500 5000 > bench_output.txt
+ * ```
+ * 
+ * Cada resultado es una línea JSON en stdout:
+ * `{"benchmark":"saveConfig","apps":1000,"iterations":10,"nsPerOp":...,"opsPerSec":...}`
+ */
+
+#include "coldtier.h"
+#include "datasetexporter.h"
+#include "snapshot.h"
+#include "trackerworker.h"
+#include "usagetracker.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QVector>
+
+#include <cstdio>
+#include <fcntl.h>
+
+/**
+ * @class TrackerBench
+ * @brief Accede a los miembros privados de UsageTracker y TrackerWorker (friend)
+ * 
+ * Los caminos de ingesta y persistencia se miden sobre un TrackerWorker
+ * sin hilo propio; las consultas, sobre un UsageTracker completo.
+ */
+class TrackerBench
+{
+public:
+    explicit TrackerBench(int apps)
+        : m_apps(apps)
+    {
+        m_resources.reserve(apps);
+        for (int i = 0; i < apps; ++i) {
+            m_resources.append(QStringLiteral("/usr/share/applications/org.example.app%1.desktop").arg(i));
+        }
+    }
+
+    void runAll()
+    {
+        benchResourceOpened();
+        benchResourceStorm();
+        benchEventQueue();
+        benchUpdateWearLevel();
+        benchUpdateRank();
+        benchRecomputeAllLevels();
+        benchPublishThenWrite();
+        benchCheckActiveApplications();
+        benchSaveLoad();
+        benchColdTier();
+        benchExport();
+        benchGetMetrics();
+    }
+
+private:
+    //! Ejecuta @p fn @p iterations veces y devuelve nanosegundos por operación
+    template<typename Fn>
+    static double measure(int iterations, Fn fn)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            fn(i);
+        }
+        return static_cast<double>(timer.nsecsElapsed()) / iterations;
+    }
+
+    void report(const char *name, int iterations, double nsPerOp)
+    {
+        QJsonObject result;
+        result[QStringLiteral("benchmark")] = QString::fromLatin1(name);
+        result[QStringLiteral("apps")] = m_apps;
+        result[QStringLiteral("iterations")] = iterations;
+        result[QStringLiteral("nsPerOp")] = nsPerOp;
+        result[QStringLiteral("opsPerSec")] = nsPerOp > 0 ? 1e9 / nsPerOp : 0.0;
+        std::printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+        std::fflush(stdout);
+    }
+
+    //! Borra todo estado persistido para que cada medición empiece igual
+    static void clearPersistedState()
+    {
+        QFile::remove(QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+                      + QStringLiteral("/iconwearrc"));
+        QFile::remove(WearSnapshot::defaultPath());
+        QFile::remove(UsageHistory::defaultPath());
+        QFile::remove(ColdTier::defaultPath());
+    }
+
+    //! Worker con las N apps ya registradas
+    void populate(TrackerWorker &worker)
+    {
+        for (const QString &resource : qAsConst(m_resources)) {
+            worker.processOpened(resource, worker.monotonicMs(), QString());
+        }
+    }
+
+    void benchResourceOpened()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        worker.m_launchCoalesceMs = 0;  // Cada apertura es un lanzamiento completo
+        const int iterations = qMax(10000, m_apps * 10);
+        const double ns = measure(iterations, [&](int i) {
+            worker.processOpened(m_resources.at(i % m_apps), worker.monotonicMs(), QString());
+        });
+        report("onResourceOpened", iterations, ns);
+    }
+
+    //! Tormenta de aperturas de una misma app con la admisión por defecto
+    void benchResourceStorm()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        AdmissionFilter admission;
+        admission.configure(worker.admissionConfig());
+        const QString agent = QStringLiteral("org.kde.kdevelop");
+        const int iterations = qMax(100000, m_apps * 10);
+        const double ns = measure(iterations, [&](int i) {
+            const qint64 now = worker.monotonicMs();
+            const QString &resource = m_resources.at(i % qMin(m_apps, 4));
+            if (admission.admit(agent, resource, AdmissionFilter::Open, now) == AdmissionFilter::Admitted) {
+                worker.processOpened(resource, now, QString());
+            }
+        });
+        report("resourceStorm", iterations, ns);
+    }
+
+    //! Camino completo de ingesta: encolar en ráfagas y vaciar en el worker
+    void benchEventQueue()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        worker.m_launchCoalesceMs = 0;
+        const int burst = qMin(1024, worker.m_queue->capacity());
+        const int iterations = qMax(10000, m_apps * 10) / burst * burst;
+        const double ns = measure(iterations, [&](int i) {
+            UsageEvent event;
+            event.monotonicMs = worker.monotonicMs();
+            event.resource = m_resources.at(i % m_apps);
+            worker.enqueue(std::move(event));
+            if ((i + 1) % burst == 0) {
+                worker.drainEvents();
+            }
+        });
+        report("eventQueue", iterations, ns);
+    }
+
+    void benchUpdateWearLevel()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        populate(worker);
+        const int iterations = qMax(100000, m_apps * 10);
+        const double ns = measure(iterations, [&](int i) {
+            worker.m_store.info(i % m_apps).launches++;
+            worker.updateWearLevel(i % m_apps);
+        });
+        report("updateWearLevel", iterations, ns);
+    }
+
+    void benchUpdateRank()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        populate(worker);
+        const int iterations = qMax(100000, m_apps * 10);
+        const double ns = measure(iterations, [&](int i) {
+            // Saltos pseudoaleatorios: la app cambia de posición en el árbol
+            const AppHandle handle = static_cast<AppHandle>((i * 7919LL) % m_apps);
+            worker.addWear(handle, worker.m_formula.launchWeight);
+            worker.updateRank(handle);
+        });
+        report("updateRank", iterations, ns);
+    }
+
+    void benchRecomputeAllLevels()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        populate(worker);
+        for (AppHandle handle = 0; handle < m_apps; ++handle) {
+            worker.m_store.info(handle).launches = handle % 250;  // Niveles variados
+        }
+
+        // Alterna dos curvas para que cada pasada cambie los niveles de verdad
+        WearFormula linear;
+        WearFormula compressed;
+        compressed.curve = WearFormula::Sqrt;
+        const int iterations = 200;
+        const double ns = measure(iterations, [&](int i) {
+            worker.m_formula = (i & 1) ? compressed : linear;
+            worker.recomputeAllLevels();
+            worker.m_pendingLevelChanges.clear();
+        });
+        report("recomputeAllLevels", iterations, ns);
+    }
+
+    //! Lote de un evento con un lector que retiene el último estado (UsageTracker::m_state)
+    void benchPublishThenWrite()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        populate(worker);
+        WearStatePtr published;
+        const int iterations = qMax(10000, m_apps);
+        double ns = measure(iterations, [&](int i) {
+            published = worker.takeState();
+            const AppHandle handle = static_cast<AppHandle>((i * 7919LL) % m_apps);
+            worker.m_store.info(handle).launches++;
+            worker.markDirty(handle);
+        });
+        report("publishThenWrite", iterations, ns);
+
+        ns = measure(iterations, [&](int i) {
+            published = worker.takeState();
+            worker.markDirty(worker.m_store.intern(QStringLiteral("org.example.new%1.desktop").arg(i)));
+        });
+        report("publishThenIntern", iterations, ns);
+    }
+
+    void benchCheckActiveApplications()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        populate(worker);  // Cada apertura deja la sesión de la app abierta
+        const int iterations = 100;
+        const double ns = measure(iterations, [&](int) {
+            worker.checkActiveApplications();
+        });
+        report("checkActiveApplications", iterations, ns);
+    }
+
+    void benchSaveLoad()
+    {
+        clearPersistedState();
+        const int iterations = 10;
+        {
+            TrackerWorker worker(m_counters, true);
+            populate(worker);
+            const double ns = measure(iterations, [&](int) {
+                for (AppHandle handle = 0; handle < worker.m_store.size(); ++handle) {
+                    worker.markDirty(handle);
+                }
+                worker.saveConfig();
+            });
+            report("saveConfig", iterations, ns);
+        }
+
+        TrackerWorker worker(m_counters, true);
+        const double snapshotNs = measure(iterations, [&](int) {
+            worker.m_store.clear();
+            worker.loadConfig();
+        });
+        report("loadConfig.snapshot", iterations, snapshotNs);
+
+        worker.m_useSnapshot = false;
+        const double kconfigNs = measure(iterations, [&](int) {
+            worker.m_store.clear();
+            worker.loadConfig();
+        });
+        report("loadConfig.kconfig", iterations, kconfigNs);
+    }
+
+    //! Degradación del 90% de las apps y guardado con solo el 10% residente
+    void benchColdTier()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        populate(worker);
+        worker.m_activeApplications.clear();
+        const qint64 old = QDateTime::currentSecsSinceEpoch() - 400 * 86400LL;
+        for (AppHandle handle = 0; handle < worker.m_store.size(); ++handle) {
+            if (handle % 10 != 0) {
+                worker.m_store.info(handle).lastOpenTime = old;
+            }
+        }
+        worker.m_coldAfterSeconds = TrackerWorker::DEFAULT_COLD_AFTER_DAYS * 86400LL;
+
+        QElapsedTimer timer;
+        timer.start();
+        worker.demoteColdApps();
+        report("demoteColdApps", 1, static_cast<double>(timer.nsecsElapsed()));
+
+        const int iterations = 10;
+        const double ns = measure(iterations, [&](int) {
+            for (AppHandle handle = 0; handle < worker.m_store.size(); ++handle) {
+                worker.markDirty(handle);
+            }
+            worker.saveConfig();
+        });
+        report("saveConfig.coldTier", iterations, ns);
+    }
+
+    void benchExport()
+    {
+        clearPersistedState();
+        TrackerWorker worker(m_counters, true);
+        populate(worker);
+        const WearStatePtr state = worker.takeState();
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        const int iterations = 10;
+        for (DatasetExporter::Format format : {DatasetExporter::Json, DatasetExporter::Binary}) {
+            const double ns = measure(iterations, [&](int) {
+                DatasetExporter exporter(state, format, now);
+                exporter.run(::open("/dev/null", O_WRONLY | O_CLOEXEC));
+            });
+            report(format == DatasetExporter::Json ? "exportDataset.json" : "exportDataset.binary", iterations, ns);
+        }
+    }
+
+    void benchGetMetrics()
+    {
+        // Persistir N apps para que el tracker (con su hilo) arranque con ellas
+        clearPersistedState();
+        {
+            TrackerWorker worker(m_counters, true);
+            populate(worker);
+            worker.saveConfig();
+        }
+
+        UsageTracker tracker;
+        const int iterations = qMax(10000, m_apps);
+
+        const double coldNs = measure(iterations, [&](int i) {
+            tracker.m_metricsJsonCache.clear();
+            tracker.getMetrics(tracker.m_state->store.appId(i % m_apps));
+        });
+        report("getMetrics.cold", iterations, coldNs);
+
+        const double cachedNs = measure(iterations, [&](int i) {
+            tracker.getMetrics(tracker.m_state->store.appId(i % m_apps));
+        });
+        report("getMetrics.cached", iterations, cachedNs);
+    }
+
+    int m_apps;
+    QStringList m_resources;
+    PerfCounters m_counters;
+};
+
+int main(int argc, char *argv[])
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("iconwear-bench"));
+
+    // Los qDebug por evento dominarían las mediciones
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+
+    QVector<int> sizes;
+    const QStringList args = app.arguments().mid(1);
+    for (const QString &arg : args) {
+        bool ok = false;
+        const int size = arg.toInt(&ok);
+        if (ok && size > 0) {
+            sizes.append(size);
+        }
+    }
+    if (sizes.isEmpty()) {
+        sizes = {100, 1000, 10000};
+    }
+
+    for (int size : sizes) {
+        TrackerBench(size).runAll();
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file coldtier.cpp
+ * @brief Implementación del nivel frío
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "coldtier.h"
+#include "snapshot.h"
+#include <QDebug>
+#include <QStandardPaths>
+
+ColdTier::ColdTier(const QString &path)
+    : m_path(path)
+{
+}
+
+QString ColdTier::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+        + QStringLiteral("/iconwear/cold.snapshot");
+}
+
+void ColdTier::load(const AppStore &hot)
+{
+    m_ids.clear();
+    m_added.clear();
+    m_taken.clear();
+    m_dropped.clear();
+    m_diskLoaded = false;
+
+    AppStore stored;
+    if (!WearSnapshot::load(m_path, stored)) {
+        return;
+    }
+    m_ids.reserve(stored.size());
+    for (AppHandle handle = 0; handle < stored.size(); ++handle) {
+        const QString &appId = stored.appId(handle);
+        // Corte entre promocionar y limpiar el nivel frío: el principal ya la tiene
+        if (hot.find(appId) != AppStore::InvalidHandle) {
+            m_dropped.insert(appId);
+        } else {
+            m_ids.insert(appId);
+        }
+    }
+    qDebug() << "Nivel frío:" << m_ids.size() << "aplicaciones en disco";
+}
+
+void ColdTier::add(const QString &appId, const AppWearInfo &info)
+{
+    AppWearInfo &stored = m_added[appId];
+    stored = info;
+    stored.dirty = false;
+    m_ids.insert(appId);
+    m_taken.remove(appId);
+    m_dropped.remove(appId);
+}
+
+bool ColdTier::take(const QString &appId, AppWearInfo &info)
+{
+    if (!m_ids.contains(appId)) {
+        return false;
+    }
+
+    // Degradada en este mismo intervalo: el archivo aún no la tiene
+    auto added = m_added.find(appId);
+    if (added != m_added.end()) {
+        info = added.value();
+        m_added.erase(added);
+    } else {
+        const AppStore &stored = disk();
+        const AppHandle handle = stored.find(appId);
+        if (handle == AppStore::InvalidHandle) {
+            return false;
+        }
+        info = stored.info(handle);
+    }
+
+    m_ids.remove(appId);
+    m_taken.insert(appId);
+    return true;
+}
+
+void ColdTier::commitPromotions()
+{
+    m_dropped.unite(m_taken);
+    m_taken.clear();
+}
+
+qint64 ColdTier::save()
+{
+    if (m_added.isEmpty() && m_dropped.isEmpty()) {
+        if (m_taken.isEmpty()) {
+            m_disk.clear();
+            m_diskLoaded = false;
+        }
+        return 0;
+    }
+
+    // Archivo actual menos lo promocionado y confirmado, más lo degradado
+    const AppStore &stored = disk();
+    AppStore merged;
+    merged.reserve(stored.size() + m_added.size());
+    for (AppHandle handle = 0; handle < stored.size(); ++handle) {
+        const QString &appId = stored.appId(handle);
+        if (!m_dropped.contains(appId) && !m_added.contains(appId)) {
+            merged.info(merged.intern(appId)) = stored.info(handle);
+        }
+    }
+    for (auto it = m_added.constBegin(); it != m_added.constEnd(); ++it) {
+        merged.info(merged.intern(it.key())) = it.value();
+    }
+
+    const qint64 bytes = WearSnapshot::write(m_path, merged);
+    if (bytes < 0) {
+        return -1;
+    }
+    m_added.clear();
+    m_dropped.clear();
+
+    // La copia en memoria solo sirve entre promociones cercanas
+    m_disk.clear();
+    m_diskLoaded = false;
+    qDebug() << "Nivel frío guardado con" << merged.size() << "aplicaciones";
+    return bytes;
+}
+
+const AppStore &ColdTier::disk()
+{
+    if (!m_diskLoaded) {
+        WearSnapshot::load(m_path, m_disk);
+        m_diskLoaded = true;
+    }
+    return m_disk;
+}
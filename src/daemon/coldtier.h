@@ -0,0 +1,110 @@
+/**
+ * @file coldtier.h
+ * @brief Nivel frío en disco para las apps sin uso reciente
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * Las apps que llevan General/coldAfterDays sin abrirse salen del AppStore
+ * residente y pasan a ~/.local/share/iconwear/cold.snapshot (mismo formato
+ * que el snapshot principal). En memoria solo queda el conjunto de sus
+ * appIds, para saber sin tocar el disco si una app desconocida es nueva o
+ * está fría. Un ResourceOpened o una consulta DBus la promocionan de vuelta.
+ *
+ * **Orden de escritura:** una app nunca falta de los dos archivos.
+ * - Degradar: el nivel frío se escribe antes que el snapshot principal.
+ * - Promocionar: el registro solo se borra del nivel frío después de que el
+ *   snapshot principal lo contenga (commitPromotions()).
+ *
+ * Si un corte deja una app en ambos, al cargar gana el snapshot principal.
+ */
+
+#ifndef COLDTIER_H
+#define COLDTIER_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include "appstore.h"
+
+/**
+ * @class ColdTier
+ * @brief Registros de las apps degradadas, con los cambios pendientes de escribir
+ *
+ * Solo se usa desde el hilo del worker.
+ */
+class ColdTier
+{
+public:
+    /**
+     * @param path Archivo del nivel frío
+     */
+    explicit ColdTier(const QString &path = defaultPath());
+
+    /// ~/.local/share/iconwear/cold.snapshot
+    static QString defaultPath();
+
+    /**
+     * @brief Lee del archivo los appIds fríos (los registros se quedan en disco)
+     * @param hot Apps residentes: las que aparezcan en ambos se quitan del nivel frío
+     */
+    void load(const AppStore &hot);
+
+    /// La app está en el nivel frío
+    bool contains(const QString &appId) const { return m_ids.contains(appId); }
+
+    /// appIds fríos (implícitamente compartido, se publica en WearState)
+    const QSet<QString> &ids() const { return m_ids; }
+
+    /// Apps en el nivel frío
+    int size() const { return m_ids.size(); }
+
+    /// Degrada una app; se escribe en el próximo save()
+    void add(const QString &appId, const AppWearInfo &info);
+
+    /**
+     * @brief Saca una app del nivel frío para promocionarla
+     * @param info Salida: sus métricas
+     * @return false si la app no estaba fría o su registro no se pudo leer
+     *
+     * El registro sigue en el archivo hasta commitPromotions() y el save()
+     * siguiente.
+     */
+    bool take(const QString &appId, AppWearInfo &info);
+
+    /// Las promociones ya están en el snapshot principal: se pueden borrar del archivo
+    void commitPromotions();
+
+    /// Hay cambios pendientes de escribir con save()
+    bool isDirty() const { return !m_added.isEmpty() || !m_dropped.isEmpty(); }
+
+    /**
+     * @brief Reescribe el archivo si hay cambios
+     * @return Bytes escritos (0 sin cambios), o -1 si falló
+     */
+    qint64 save();
+
+private:
+    /// Carga el archivo en m_disk si aún no está cargado
+    const AppStore &disk();
+
+    QString m_path;
+
+    /// appIds fríos, en disco o pendientes de escribir
+    QSet<QString> m_ids;
+
+    /// Degradadas desde el último save()
+    QHash<QString, AppWearInfo> m_added;
+
+    /// Promocionadas cuyo registro aún no está en el snapshot principal
+    QSet<QString> m_taken;
+
+    /// Registros a borrar del archivo en el próximo save()
+    QSet<QString> m_dropped;
+
+    /// Contenido del archivo mientras haya promociones; se libera al guardar
+    AppStore m_disk;
+    bool m_diskLoaded = false;
+};
+
+#endif // COLDTIER_H
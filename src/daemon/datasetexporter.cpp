@@ -0,0 +1,203 @@
+/**
+ * @file datasetexporter.cpp
+ * @brief Implementación de la exportación completa
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "datasetexporter.h"
+#include "coldtier.h"
+#include "snapshot.h"
+#include <QDataStream>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <limits>
+
+namespace {
+
+/// Todo lo que guardan los búferes circulares
+constexpr qint64 FULL_RANGE_END = std::numeric_limits<qint64>::max();
+
+//! Buckets como [[start, launches, seconds], ...]
+QJsonArray bucketsToJson(const UsageBucketList &buckets)
+{
+    QJsonArray result;
+    for (const UsageBucket &bucket : buckets) {
+        result.append(QJsonArray{bucket.start, bucket.launches, bucket.activeSeconds});
+    }
+    return result;
+}
+
+void writeBuckets(QDataStream &stream, const UsageBucketList &buckets)
+{
+    stream << static_cast<quint32>(buckets.size());
+    for (const UsageBucket &bucket : buckets) {
+        stream << bucket.start << static_cast<qint32>(bucket.launches) << static_cast<qint32>(bucket.activeSeconds);
+    }
+}
+
+} // namespace
+
+DatasetExporter::DatasetExporter(const WearStatePtr &state, Format format, qint64 nowSecs)
+    : m_state(state)
+    , m_format(format)
+    , m_nowSecs(nowSecs)
+{
+}
+
+bool DatasetExporter::formatFromName(const QString &name, Format *format)
+{
+    if (name == QLatin1String("json")) {
+        *format = Json;
+    } else if (name == QLatin1String("binary")) {
+        *format = Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+qint64 DatasetExporter::run(int fd)
+{
+    m_exported = 0;
+    m_error.clear();
+
+    QFile output;
+    if (!output.open(fd, QIODevice::WriteOnly, QFileDevice::AutoCloseHandle)) {
+        m_error = output.errorString();
+        return -1;
+    }
+
+    // Los registros fríos se leen aquí, en el hilo de la exportación
+    AppStore cold;
+    if (!m_state->coldApps.isEmpty()) {
+        WearSnapshot::load(ColdTier::defaultPath(), cold);
+    }
+
+    const bool ok = m_format == Json ? writeJson(output, cold) : writeBinary(output, cold);
+    if (ok && !output.flush()) {
+        m_error = output.errorString();
+    }
+    if (!ok && m_error.isEmpty()) {
+        m_error = output.errorString();
+    }
+    output.close();
+    return m_error.isEmpty() ? m_exported : -1;
+}
+
+bool DatasetExporter::cancelled()
+{
+    if (!m_cancelled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    m_error = QStringLiteral("Export cancelled");
+    return true;
+}
+
+bool DatasetExporter::exportsCold(const AppStore &cold, AppHandle handle) const
+{
+    const QString &appId = cold.appId(handle);
+    return m_state->coldApps.contains(appId) && m_state->store.find(appId) == AppStore::InvalidHandle;
+}
+
+bool DatasetExporter::writeJson(QIODevice &device, const AppStore &cold)
+{
+    const AppStore &store = m_state->store;
+    int total = store.size();
+    for (AppHandle handle = 0; handle < cold.size(); ++handle) {
+        total += exportsCold(cold, handle) ? 1 : 0;
+    }
+
+    QJsonObject header;
+    header[QStringLiteral("format")] = QStringLiteral("iconwear-export");
+    header[QStringLiteral("version")] = static_cast<int>(VERSION);
+    header[QStringLiteral("exportedAt")] = m_nowSecs;
+    header[QStringLiteral("apps")] = total;
+    header[QStringLiteral("halfLifeSeconds")] = m_state->halfLifeSeconds;
+    if (device.write(QJsonDocument(header).toJson(QJsonDocument::Compact) + '\n') < 0) {
+        return false;
+    }
+
+    // Una línea por app; el búfer de QFile agrupa las escrituras al descriptor
+    auto writeApp = [&](const QString &appId, const AppWearInfo &info, bool isCold, AppHandle historyHandle) {
+        if (cancelled()) {
+            return false;
+        }
+        QJsonObject app;
+        app[QStringLiteral("appId")] = appId;
+        app[QStringLiteral("cold")] = isCold;
+        app[QStringLiteral("wearLevel")] = m_state->levelAt(info, m_nowSecs);
+        app[QStringLiteral("launches")] = info.launches;
+        app[QStringLiteral("activeSeconds")] = info.activeTimeSeconds;
+        app[QStringLiteral("reconstructions")] = info.reconstructions;
+        app[QStringLiteral("lastOpenTime")] = info.lastOpenTime;
+        app[QStringLiteral("lastResetTime")] = info.lastResetTime;
+        app[QStringLiteral("wearScore")] = static_cast<double>(info.wearScore);
+        app[QStringLiteral("wearStamp")] = info.wearStamp;
+        app[QStringLiteral("hours")] = bucketsToJson(m_state->history.query(historyHandle, 0, FULL_RANGE_END, UsageHistory::Hour));
+        app[QStringLiteral("days")] = bucketsToJson(m_state->history.query(historyHandle, 0, FULL_RANGE_END, UsageHistory::Day));
+        if (device.write(QJsonDocument(app).toJson(QJsonDocument::Compact) + '\n') < 0) {
+            return false;
+        }
+        ++m_exported;
+        return true;
+    };
+
+    for (AppHandle handle = 0; handle < store.size(); ++handle) {
+        if (!writeApp(store.appId(handle), store.info(handle), false, handle)) {
+            return false;
+        }
+    }
+    for (AppHandle handle = 0; handle < cold.size(); ++handle) {
+        if (exportsCold(cold, handle) && !writeApp(cold.appId(handle), cold.info(handle), true, AppStore::InvalidHandle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatasetExporter::writeBinary(QIODevice &device, const AppStore &cold)
+{
+    const AppStore &store = m_state->store;
+    quint32 total = static_cast<quint32>(store.size());
+    for (AppHandle handle = 0; handle < cold.size(); ++handle) {
+        total += exportsCold(cold, handle) ? 1 : 0;
+    }
+
+    QDataStream stream(&device);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << quint32(MAGIC) << quint32(VERSION) << m_nowSecs << total << m_state->halfLifeSeconds;
+
+    auto writeApp = [&](const QString &appId, const AppWearInfo &info, bool isCold, AppHandle historyHandle) {
+        if (cancelled()) {
+            return false;
+        }
+        stream << static_cast<quint8>(1) << appId << isCold
+               << static_cast<qint32>(m_state->levelAt(info, m_nowSecs)) << info.launches << info.reconstructions
+               << info.activeTimeSeconds << info.lastOpenTime << info.lastResetTime << info.wearScore << info.wearStamp;
+        writeBuckets(stream, m_state->history.query(historyHandle, 0, FULL_RANGE_END, UsageHistory::Hour));
+        writeBuckets(stream, m_state->history.query(historyHandle, 0, FULL_RANGE_END, UsageHistory::Day));
+        if (stream.status() != QDataStream::Ok) {
+            return false;
+        }
+        ++m_exported;
+        return true;
+    };
+
+    for (AppHandle handle = 0; handle < store.size(); ++handle) {
+        if (!writeApp(store.appId(handle), store.info(handle), false, handle)) {
+            return false;
+        }
+    }
+    for (AppHandle handle = 0; handle < cold.size(); ++handle) {
+        if (exportsCold(cold, handle) && !writeApp(cold.appId(handle), cold.info(handle), true, AppStore::InvalidHandle)) {
+            return false;
+        }
+    }
+
+    stream << static_cast<quint8>(0) << static_cast<quint32>(m_exported);
+    return stream.status() == QDataStream::Ok;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file datasetexporter.h
+ * @brief Exportación completa del estado a un descriptor de archivo
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * Escribe todas las apps (residentes y del nivel frío) con su historial,
+ * registro a registro, en un descriptor recibido por DBus (ver
+ * UsageTracker::exportDataset()). Nada se acumula en memoria: cada app se
+ * serializa y se escribe antes de pasar a la siguiente.
+ *
+ * **Formato "json"** (una línea JSON por objeto):
+ * ```
+ * {"format":"iconwear-export","version":1,"exportedAt":...,"apps":N,"halfLifeSeconds":...}
+ * {"appId":"org.kde.dolphin.desktop","cold":false,"wearLevel":78,"launches":247,
+ *  "activeSeconds":3600,"reconstructions":0,"lastOpenTime":...,"lastResetTime":0,
+ *  "wearScore":78.4,"wearStamp":...,"hours":[[start,launches,seconds],...],"days":[...]}
+ * ```
+ *
+ * **Formato "binary"** (QDataStream Qt_5_12, big-endian):
+ * ```
+ * quint32 MAGIC, quint32 VERSION, qint64 exportedAt, quint32 apps, qint64 halfLifeSeconds
+ * por app:
+ *   quint8 1, QString appId, bool cold,
+ *   qint32 wearLevel, launches, reconstructions,
+ *   qint64 activeSeconds, lastOpenTime, lastResetTime, float wearScore, qint64 wearStamp,
+ *   2 × (quint32 n, n × (qint64 start, qint32 launches, qint32 activeSeconds))   // horas, días
+ * quint8 0, quint32 apps escritas
+ * ```
+ *
+ * El historial va solo donde existe: las apps del nivel frío salen con
+ * listas vacías (su historial no está en memoria).
+ */
+
+#ifndef DATASETEXPORTER_H
+#define DATASETEXPORTER_H
+
+#include <QString>
+
+#include "trackerworker.h"
+
+#include <atomic>
+
+class QIODevice;
+
+/**
+ * @class DatasetExporter
+ * @brief Serializa un WearState publicado; pensado para correr en un hilo propio
+ *
+ * El estado es inmutable, así que el exportador no necesita bloqueos y el
+ * worker sigue publicando estados nuevos mientras tanto.
+ */
+class DatasetExporter
+{
+public:
+    /// Formato de salida
+    enum Format {
+        Json,       ///< JSON delimitado por líneas
+        Binary      ///< QDataStream compacto
+    };
+
+    /// Identificador mágico del formato binario ("IWEX")
+    static constexpr quint32 MAGIC = 0x49574558;
+
+    /// Versión de ambos formatos
+    static constexpr quint32 VERSION = 1;
+
+    /**
+     * @param state Estado a exportar
+     * @param format Formato de salida
+     * @param nowSecs Instante en el que se evalúan los niveles con semivida
+     */
+    DatasetExporter(const WearStatePtr &state, Format format, qint64 nowSecs);
+
+    /**
+     * @brief Formato por nombre ("json" o "binary")
+     * @return false si el nombre no es válido
+     */
+    static bool formatFromName(const QString &name, Format *format);
+
+    /**
+     * @brief Escribe todo el estado en @p fd y lo cierra
+     * @return Apps exportadas, o -1 si falló la escritura (ver errorString())
+     */
+    qint64 run(int fd);
+
+    /**
+     * @brief Pide a run() que pare tras la app en curso (desde cualquier hilo)
+     *
+     * run() devuelve entonces -1; lo ya escrito queda en el descriptor.
+     */
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    /// Descripción del último error de run()
+    QString errorString() const { return m_error; }
+
+private:
+    bool writeJson(QIODevice &device, const AppStore &cold);
+    bool writeBinary(QIODevice &device, const AppStore &cold);
+
+    /// Se pidió cancel(); deja el motivo en m_error
+    bool cancelled();
+
+    /// La app del nivel frío no fue promocionada después de publicarse el estado
+    bool exportsCold(const AppStore &cold, AppHandle handle) const;
+
+    WearStatePtr m_state;
+    Format m_format;
+    qint64 m_nowSecs;
+    qint64 m_exported = 0;
+    QString m_error;
+    std::atomic<bool> m_cancelled{false};
+};
+
+#endif // DATASETEXPORTER_H
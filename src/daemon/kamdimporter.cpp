@@ -0,0 +1,206 @@
+/**
+ * @file kamdimporter.cpp
+ * @brief Implementación del lector paralelo de kactivitymanagerd
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "kamdimporter.h"
+#include "weardecay.h"
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QThread>
+#include <QVariant>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+const QString CONNECT_OPTIONS = QStringLiteral("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+
+/// Clave de agregación: una fila de KamdUsage por combinación
+struct UsageKey {
+    QString resource;
+    QString agent;
+    QString activity;
+
+    bool operator==(const UsageKey &other) const
+    {
+        return resource == other.resource && agent == other.agent && activity == other.activity;
+    }
+};
+
+inline uint qHash(const UsageKey &key, uint seed = 0)
+{
+    seed ^= ::qHash(key.resource) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= ::qHash(key.agent) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= ::qHash(key.activity) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+//! Abre una conexión de solo lectura con nombre propio (una por hilo)
+QSqlDatabase openReadOnly(const QString &path, const QString &connectionName)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+    db.setDatabaseName(path);
+    db.setConnectOptions(CONNECT_OPTIONS);
+    db.open();
+    return db;
+}
+
+} // namespace
+
+KamdImporter::KamdImporter(const QString &databasePath, int threads, qint64 halfLifeSeconds, qint64 nowSecs)
+    : m_databasePath(databasePath)
+    , m_threads(threads > 0 ? threads : QThread::idealThreadCount())
+    , m_halfLifeSeconds(halfLifeSeconds)
+    , m_nowSecs(nowSecs)
+{
+}
+
+QString KamdImporter::defaultDatabasePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+        + QStringLiteral("/kactivitymanagerd/resources/database");
+}
+
+bool KamdImporter::run()
+{
+    m_results.clear();
+    m_eventsRead = 0;
+    m_watermark = 0;
+    m_threadsUsed = 0;
+    m_error.clear();
+
+    // Rango de rowid a repartir; la conexión se cierra antes de arrancar los hilos
+    const QString mainConnection = QStringLiteral("iconwear-kamd");
+    qint64 minRow = 0;
+    qint64 maxRow = -1;
+    {
+        QSqlDatabase db = openReadOnly(m_databasePath, mainConnection);
+        if (!db.isOpen()) {
+            m_error = db.lastError().text();
+        } else {
+            QSqlQuery query(QStringLiteral("SELECT MIN(rowid), MAX(rowid) FROM ResourceEvent"), db);
+            if (!query.next()) {
+                m_error = query.lastError().text();
+            } else if (!query.value(0).isNull()) {
+                minRow = query.value(0).toLongLong();
+                maxRow = query.value(1).toLongLong();
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(mainConnection);
+    if (!m_error.isEmpty()) {
+        return false;
+    }
+    if (maxRow < minRow) {
+        return true;  // Tabla vacía
+    }
+
+    // Rangos contiguos de igual tamaño: los rowid de ResourceEvent son casi densos
+    const qint64 span = maxRow - minRow + 1;
+    m_threadsUsed = static_cast<int>(qMin<qint64>(m_threads, span));
+    const qint64 perThread = (span + m_threadsUsed - 1) / m_threadsUsed;
+
+    std::vector<Partial> partials(m_threadsUsed);
+    std::vector<std::unique_ptr<QThread>> threads;
+    threads.reserve(m_threadsUsed);
+    for (int i = 0; i < m_threadsUsed; ++i) {
+        const qint64 from = minRow + i * perThread;
+        const qint64 to = qMin(maxRow, from + perThread - 1);
+        const QString connection = QStringLiteral("iconwear-kamd-%1").arg(i);
+        Partial &partial = partials[i];
+        threads.emplace_back(QThread::create([this, connection, from, to, &partial] {
+            aggregateRange(connection, from, to, partial);
+        }));
+        threads.back()->start();
+    }
+    for (auto &thread : threads) {
+        thread->wait();
+    }
+
+    // Fusión: el primer parcial se adopta entero, el resto se suma por clave
+    QHash<UsageKey, int> index;
+    for (Partial &partial : partials) {
+        if (!partial.error.isEmpty()) {
+            m_error = partial.error;
+            m_results.clear();
+            return false;
+        }
+        m_eventsRead += partial.eventsRead;
+        for (KamdUsage &usage : partial.usages) {
+            m_watermark = qMax(m_watermark, usage.lastUse);
+            const UsageKey key{usage.resource, usage.agent, usage.activity};
+            auto it = index.find(key);
+            if (it == index.end()) {
+                index.insert(key, m_results.size());
+                m_results.append(std::move(usage));
+                continue;
+            }
+            KamdUsage &total = m_results[*it];
+            total.events += usage.events;
+            total.activeSeconds += usage.activeSeconds;
+            total.lastUse = qMax(total.lastUse, usage.lastUse);
+            total.eventWeight += usage.eventWeight;
+            total.minuteWeight += usage.minuteWeight;
+        }
+        partial.usages.clear();
+    }
+    return true;
+}
+
+void KamdImporter::aggregateRange(const QString &connectionName, qint64 fromRow, qint64 toRow, Partial &partial) const
+{
+    {
+        QSqlDatabase db = openReadOnly(m_databasePath, connectionName);
+        if (!db.isOpen()) {
+            partial.error = db.lastError().text();
+        } else {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            query.prepare(QStringLiteral("SELECT targetedResource, initiatingAgent, usedActivity, start, end "
+                                         "FROM ResourceEvent WHERE rowid BETWEEN ? AND ?"));
+            query.addBindValue(fromRow);
+            query.addBindValue(toRow);
+
+            if (!query.exec()) {
+                partial.error = query.lastError().text();
+            } else {
+                QHash<UsageKey, int> index;
+                while (query.next()) {
+                    const qint64 start = query.value(3).toLongLong();
+                    if (start <= 0) {
+                        continue;
+                    }
+                    const qint64 end = query.value(4).toLongLong();
+                    const qint64 seconds = end > start ? qMin(end - start, MAX_EVENT_SECONDS) : 0;
+                    const qint64 last = qMax(start, end);
+
+                    const UsageKey key{query.value(0).toString(), query.value(1).toString(), query.value(2).toString()};
+                    auto it = index.find(key);
+                    if (it == index.end()) {
+                        KamdUsage usage;
+                        usage.resource = key.resource;
+                        usage.agent = key.agent;
+                        usage.activity = key.activity;
+                        it = index.insert(key, partial.usages.size());
+                        partial.usages.append(usage);
+                    }
+
+                    KamdUsage &usage = partial.usages[*it];
+                    usage.events++;
+                    usage.activeSeconds += seconds;
+                    usage.lastUse = qMax(usage.lastUse, last);
+                    usage.eventWeight += WearDecay::decayed(1.0, start, m_nowSecs, m_halfLifeSeconds);
+                    usage.minuteWeight += WearDecay::decayed(seconds / 60.0, last, m_nowSecs, m_halfLifeSeconds);
+                    partial.eventsRead++;
+                }
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
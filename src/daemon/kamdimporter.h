@@ -0,0 +1,119 @@
+/**
+ * @file kamdimporter.h
+ * @brief Importación masiva y sin conexión de la base de datos de kactivitymanagerd
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * StatsImporter solo ve lo que devuelve una consulta de KActivities Stats.
+ * Al instalar IconWear en una máquina con años de uso, KamdImporter lee
+ * directamente la tabla ResourceEvent de kactivitymanagerd (SQLite, solo
+ * lectura) y agrega los eventos en paralelo:
+ *
+ * ```
+ * ResourceEvent(usedActivity, initiatingAgent, targetedResource, start, end)
+ * ```
+ *
+ * La tabla se reparte por rangos de rowid entre hilos; cada hilo abre su
+ * propia conexión, recorre su rango con un cursor de solo avance y agrega
+ * por (recurso, agente, actividad). Al final se fusionan los parciales. La
+ * resolución a appIds y la escritura del estado las hace el TrackerWorker
+ * (ver TrackerWorker::importKamdDatabase()).
+ */
+
+#ifndef KAMDIMPORTER_H
+#define KAMDIMPORTER_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @struct KamdUsage
+ * @brief Uso agregado de un recurso desde un agente en una actividad
+ *
+ * Los pesos son sumas de contribuciones ya decaídas hasta el instante de
+ * la importación (sin semivida, simples totales), para que el worker solo
+ * tenga que multiplicarlas por los factores de desgaste.
+ */
+struct KamdUsage {
+    QString resource;               ///< targetedResource
+    QString agent;                  ///< initiatingAgent
+    QString activity;               ///< usedActivity
+    int events = 0;                 ///< Filas de ResourceEvent
+    qint64 activeSeconds = 0;       ///< Suma de (end - start), acotada por evento
+    qint64 lastUse = 0;             ///< Último start/end visto (segundos epoch)
+    double eventWeight = 0.0;       ///< Σ decaimiento(1) por evento
+    double minuteWeight = 0.0;      ///< Σ decaimiento(minutos activos) por evento
+};
+
+/**
+ * @class KamdImporter
+ * @brief Lector paralelo de ResourceEvent
+ *
+ * @code
+ * KamdImporter importer(KamdImporter::defaultDatabasePath(), 8, halfLife, now);
+ * if (importer.run()) {
+ *     for (const KamdUsage &usage : importer.results()) { ... }
+ * }
+ * @endcode
+ */
+class KamdImporter
+{
+public:
+    /**
+     * @param databasePath Base de datos de kactivitymanagerd
+     * @param threads Hilos lectores (<= 0: QThread::idealThreadCount())
+     * @param halfLifeSeconds Semivida del desgaste (0 = sin decaimiento)
+     * @param nowSecs Instante hasta el que se decaen los eventos
+     */
+    KamdImporter(const QString &databasePath, int threads, qint64 halfLifeSeconds, qint64 nowSecs);
+
+    /// ~/.local/share/kactivitymanagerd/resources/database
+    static QString defaultDatabasePath();
+
+    /// Duración máxima que se atribuye a un solo evento (sesiones sin cerrar)
+    static constexpr qint64 MAX_EVENT_SECONDS = 12 * 3600;
+
+    /**
+     * @brief Lee y agrega toda la tabla
+     * @return false si la base de datos no se pudo abrir o leer (ver errorString())
+     */
+    bool run();
+
+    /// Usos agregados, uno por (recurso, agente, actividad)
+    const QVector<KamdUsage> &results() const { return m_results; }
+
+    /// Filas leídas
+    qint64 eventsRead() const { return m_eventsRead; }
+
+    /// Último uso visto (nueva marca de agua de KActivities)
+    qint64 watermark() const { return m_watermark; }
+
+    /// Hilos usados en la última ejecución
+    int threadsUsed() const { return m_threadsUsed; }
+
+    QString errorString() const { return m_error; }
+
+private:
+    /// Resultado de un hilo lector
+    struct Partial {
+        QVector<KamdUsage> usages;
+        qint64 eventsRead = 0;
+        QString error;
+    };
+
+    /// Agrega las filas con rowid en [fromRow, toRow] (en el hilo que llama)
+    void aggregateRange(const QString &connectionName, qint64 fromRow, qint64 toRow, Partial &partial) const;
+
+    QString m_databasePath;
+    int m_threads;
+    qint64 m_halfLifeSeconds;
+    qint64 m_nowSecs;
+
+    QVector<KamdUsage> m_results;
+    qint64 m_eventsRead = 0;
+    qint64 m_watermark = 0;
+    int m_threadsUsed = 0;
+    QString m_error;
+};
+
+#endif // KAMDIMPORTER_H
@@ -31,27 +31,117 @@
  * 
  * # Ver configuración guardada
  * cat ~/.config/iconwearrc
+ * 
+ * # Comparar el arranque sin snapshot binario (solo KConfig)
+ * ./iconwear-daemon --no-snapshot
+ * 
+ * # Importar el histórico de kactivitymanagerd y salir (daemon parado)
+ * ./iconwear-daemon --import-kamd [--kamd-database ruta] [--import-threads N]
  * ```
  */
 
+#include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QDBusConnection>
+#include <QDBusConnectionInterface>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include "kamdimporter.h"
+#include "statsadaptor.h"
+#include "trackerworker.h"
 #include "usagetracker.h"
 
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+/// Par de sockets para convertir señales Unix en eventos del event loop
+int s_signalFd[2] = {-1, -1};
+
+//! Manejador async-signal-safe: solo escribe un byte en el socket
+void unixSignalHandler(int signum)
+{
+    const char c = static_cast<char>(signum);
+    const ssize_t written = ::write(s_signalFd[0], &c, sizeof(c));
+    Q_UNUSED(written);
+}
+
+//! Instala SIGTERM/SIGINT/SIGHUP para salir limpiamente del event loop
+/*!
+ * systemd y el gestor de sesión envían SIGTERM al cerrar sesión. En lugar
+ * de morir con cambios pendientes, se sale del event loop para que el
+ * destructor de UsageTracker persista el estado.
+ */
+void setupUnixSignalHandlers(QCoreApplication *app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, s_signalFd) != 0) {
+        qWarning() << "No se pudo crear el socketpair para señales Unix";
+        return;
+    }
+
+    auto *notifier = new QSocketNotifier(s_signalFd[1], QSocketNotifier::Read, app);
+    QObject::connect(notifier, &QSocketNotifier::activated, app, [app]() {
+        char signum = 0;
+        if (::read(s_signalFd[1], &signum, sizeof(signum)) > 0) {
+            qInfo() << "Señal" << int(signum) << "recibida, guardando y saliendo";
+        }
+        app->quit();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = unixSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+
+    for (int signum : {SIGTERM, SIGINT, SIGHUP}) {
+        sigaction(signum, &action, nullptr);
+    }
+
+    // Un lector de exportDataset que cierra la tubería no debe matar el daemon
+    ::signal(SIGPIPE, SIG_IGN);
+}
+
+//! Modo sin conexión: importa kactivitymanagerd al estado guardado y termina
+/*!
+ * Se niega a correr con el daemon activo: su próximo guardado pisaría el
+ * estado importado.
+ */
+int runKamdImport(const QString &databasePath, int threads, bool useSnapshot)
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (bus.isConnected() && bus.interface()->isServiceRegistered(QStringLiteral("org.kde.iconwear")).value()) {
+        qCritical() << "org.kde.iconwear is running; stop the daemon before importing";
+        return 1;
+    }
+
+    PerfCounters counters;
+    TrackerWorker worker(counters, useSnapshot);
+    return worker.importKamdDatabase(databasePath, threads) >= 0 ? 0 : 1;
+}
+
+} // namespace
+
 //! Función principal - Inicializa y ejecuta el daemon
 /*!
  * **Proceso de inicialización:**
  * 
  * 1. Crea QCoreApplication (event loop)
  * 2. Configura nombre de aplicación y organización
- * 3. Instancia UsageTracker:
- *    - Carga configuración guardada
+ * 3. Registra servicio DBus "org.kde.iconwear"; si otra instancia ya lo
+ *    tiene sale sin tocar el estado guardado
+ * 4. Instancia UsageTracker:
+ *    - Carga configuración guardada (TrackerWorker)
+ *    - Arranca el hilo worker de ingesta y persistencia
  *    - Conecta a señales de ActivityManager
- *    - Inicia timer de monitoring
- * 4. Registra servicio DBus "org.kde.iconwear"
  * 5. Expone objeto /Tracker con interfaz pública
+ * 5b. Publica la tabla en memoria compartida (solo con el nombre en propiedad)
+ * 5c. Arranca la importación incremental de KActivities Stats en otro hilo
  * 6. Entra en event loop (espera eventos)
+ * 7. Al recibir SIGTERM/SIGINT/SIGHUP sale del loop y persiste los
+ *    cambios pendientes (flush) antes de terminar
  * 
  * **Interfaces expuestas:**
  * ```
@@ -64,40 +154,100 @@
  *   QString getMetrics(QString appId)
  *   void resetWearLevel(QString appId)
  *   int getReconstructions(QString appId)
+ *   a{si} getWearLevels(QStringList appIds)
+ *   a{s(iiixx)} getMetricsBatch(QStringList appIds)
+ *   a{s(iiixx)} getAllMetrics()
+ *   int exportDataset(h fd, QString format)   // respuesta diferida
  * 
  * Signals:
  *   wearLevelChanged(QString appId, int newLevel)
+ *   wearLevelsChanged(a{si} levels)
  *   wearLevelReset(QString appId)
+ *   statsImportProgress(int imported)
+ *   statsImportFinished(int imported)
+ * 
+ * Interface: org.kde.iconwear.Stats (mismo objeto)
+ *   QVariantMap getCounters()
+ *   QVariantMap getLatencyHistograms()
+ *   void resetCounters()
  * ```
  * 
  * @return 0 si todo OK, 1 si hay error al registrar DBus
  */
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     QCoreApplication app(argc, argv);
     app.setApplicationName(QStringLiteral("iconwear-daemon"));
     app.setOrganizationDomain(QStringLiteral("org.kde"));
 
-    // Crear instancia del rastreador (inicializa todo)
-    UsageTracker tracker;
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("IconWear usage tracking daemon"));
+    parser.addHelpOption();
+    QCommandLineOption noSnapshotOption(QStringLiteral("no-snapshot"),
+                                        QStringLiteral("Load and save state only through iconwearrc (KConfig)."));
+    parser.addOption(noSnapshotOption);
+    QCommandLineOption importOption(QStringLiteral("import-kamd"),
+                                    QStringLiteral("Import the kactivitymanagerd history into the saved state and exit."));
+    parser.addOption(importOption);
+    QCommandLineOption databaseOption(QStringLiteral("kamd-database"),
+                                      QStringLiteral("kactivitymanagerd database to import (default: the user's)."),
+                                      QStringLiteral("path"), KamdImporter::defaultDatabasePath());
+    parser.addOption(databaseOption);
+    QCommandLineOption threadsOption(QStringLiteral("import-threads"),
+                                     QStringLiteral("Reader threads for --import-kamd (default: one per core)."),
+                                     QStringLiteral("count"), QStringLiteral("0"));
+    parser.addOption(threadsOption);
+    parser.process(app);
+
+    if (parser.isSet(importOption)) {
+        return runKamdImport(parser.value(databaseOption), parser.value(threadsOption).toInt(),
+                             !parser.isSet(noSnapshotOption));
+    }
 
-    // Registrar servicio DBus
+    setupUnixSignalHandlers(&app);
+
+    // Registrar servicio DBus antes de cargar nada: el nombre es el cerrojo
+    // de la sesión. Una segunda instancia sale aquí, antes de que su tracker
+    // degrade apps o guarde (y al destruirse vuelque) estado viejo encima
+    // del de la instancia activa.
     if (!QDBusConnection::sessionBus().registerService(QStringLiteral("org.kde.iconwear"))) {
         qCritical() << "Failed to register DBus service org.kde.iconwear";
         return 1;
     }
 
+    // Crear instancia del rastreador (inicializa todo)
+    UsageTracker tracker(nullptr, !parser.isSet(noSnapshotOption));
+
+    // Garantizar escritura de cambios pendientes al salir (fin de sesión)
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &tracker, &UsageTracker::flush);
+
+    // Interfaz org.kde.iconwear.Stats con los contadores de rendimiento
+    new StatsAdaptor(&tracker);
+
     // Exponer objeto en la ruta /Tracker con todas sus slots y señales
     if (!QDBusConnection::sessionBus().registerObject(QStringLiteral("/Tracker"), &tracker, 
                                                        QDBusConnection::ExportAllSlots | 
-                                                       QDBusConnection::ExportAllSignals)) {
+                                                       QDBusConnection::ExportAllSignals |
+                                                       QDBusConnection::ExportAdaptors)) {
         qCritical() << "Failed to register DBus object /Tracker";
         return 1;
     }
 
+    // Memoria compartida solo con el nombre DBus ya en propiedad: nunca
+    // reemplaza el segmento de otro daemon de la misma sesión
+    tracker.openSharedMemory();
+
+    // Importar el histórico de KActivities en segundo plano, ya con el servicio disponible
+    tracker.startStatsImport();
+
     qInfo() << "✓ IconWear Daemon started successfully";
     qInfo() << "  Service: org.kde.iconwear";
     qInfo() << "  Object: /Tracker";
+    qInfo() << "  State loaded from:" << (tracker.loadedFromSnapshot() ? "snapshot" : "iconwearrc");
+    qInfo() << "  Startup to DBus ready:" << startupTimer.nsecsElapsed() / 1000 << "us";
 
     // Event loop - espera eventos DBus y ActivityManager
     return app.exec();
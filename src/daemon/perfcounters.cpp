@@ -0,0 +1,93 @@
+/**
+ * @file perfcounters.cpp
+ * @brief Implementación de contadores e histogramas de latencia
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "perfcounters.h"
+#include <QFile>
+#include <QList>
+#include <QVariantList>
+
+#include <unistd.h>
+
+void LatencyHistogram::record(qint64 nanoseconds)
+{
+    const quint64 ns = nanoseconds > 0 ? static_cast<quint64>(nanoseconds) : 0;
+
+    // Cubeta = número de bits de la latencia en µs (log2 + 1)
+    quint64 us = ns / 1000;
+    int bucket = 0;
+    while (us > 0 && bucket < BUCKETS - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumNs.fetch_add(ns, std::memory_order_relaxed);
+
+    quint64 previous = m_maxNs.load(std::memory_order_relaxed);
+    while (ns > previous && !m_maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {
+    }
+}
+
+QVariantMap LatencyHistogram::toVariantMap() const
+{
+    QVariantList buckets;
+    for (const auto &bucket : m_buckets) {
+        buckets.append(QVariant::fromValue<quint64>(bucket.load(std::memory_order_relaxed)));
+    }
+
+    QVariantMap result;
+    result[QStringLiteral("count")] = QVariant::fromValue<quint64>(m_count.load(std::memory_order_relaxed));
+    result[QStringLiteral("sumUs")] = QVariant::fromValue<quint64>(m_sumNs.load(std::memory_order_relaxed) / 1000);
+    result[QStringLiteral("maxUs")] = QVariant::fromValue<quint64>(m_maxNs.load(std::memory_order_relaxed) / 1000);
+    result[QStringLiteral("buckets")] = buckets;
+    return result;
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+void PerfCounters::reset()
+{
+    eventsReceived.store(0, std::memory_order_relaxed);
+    eventsFiltered.store(0, std::memory_order_relaxed);
+    eventsProcessed.store(0, std::memory_order_relaxed);
+    eventsDropped.store(0, std::memory_order_relaxed);
+    eventsThrottled.store(0, std::memory_order_relaxed);
+    eventsCoalesced.store(0, std::memory_order_relaxed);
+    signalsEmitted.store(0, std::memory_order_relaxed);
+    savesPerformed.store(0, std::memory_order_relaxed);
+    bytesWritten.store(0, std::memory_order_relaxed);
+    resolverCacheHits.store(0, std::memory_order_relaxed);
+    resolverCacheMisses.store(0, std::memory_order_relaxed);
+    appsDemoted.store(0, std::memory_order_relaxed);
+    appsPromoted.store(0, std::memory_order_relaxed);
+    saveConfigLatency.reset();
+    statsMergeLatency.reset();
+    dbusSlotLatency.reset();
+}
+
+qint64 residentMemoryBytes()
+{
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    // Formato: size resident shared text lib data dt (en páginas)
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return 0;
+    }
+    return fields.at(1).toLongLong() * static_cast<qint64>(sysconf(_SC_PAGESIZE));
+}
@@ -0,0 +1,116 @@
+/**
+ * @file perfcounters.h
+ * @brief Contadores de rendimiento del daemon, baratos y siempre activos
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Contadores atómicos (orden relaxed) e histogramas de latencia con cubetas
+ * en potencias de dos. Registrar un evento cuesta un incremento atómico;
+ * medir una latencia, dos lecturas del reloj monotónico. Se exponen por
+ * DBus a través de StatsAdaptor (org.kde.iconwear.Stats).
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QElapsedTimer>
+#include <QVariantMap>
+
+#include <atomic>
+
+/**
+ * @class LatencyHistogram
+ * @brief Histograma de latencias con cubetas log2 en microsegundos
+ * 
+ * La cubeta `i` cuenta las muestras con latencia < 2^i µs (la 0, < 1 µs);
+ * la última acumula todo lo que excede el rango.
+ */
+class LatencyHistogram
+{
+public:
+    /// Número de cubetas: la última cubre >= 2^22 µs (~4 s)
+    static constexpr int BUCKETS = 24;
+
+    /// Registra una muestra en nanosegundos
+    void record(qint64 nanoseconds);
+
+    /**
+     * @brief Exporta el histograma para DBus
+     * @return Mapa con `count`, `sumUs`, `maxUs` y `buckets` (lista de conteos)
+     */
+    QVariantMap toVariantMap() const;
+
+    /// Pone a cero todas las cubetas
+    void reset();
+
+private:
+    std::atomic<quint64> m_buckets[BUCKETS] = {};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sumNs{0};
+    std::atomic<quint64> m_maxNs{0};
+};
+
+/**
+ * @struct PerfCounters
+ * @brief Todos los contadores del daemon
+ */
+struct PerfCounters {
+    std::atomic<quint64> eventsReceived{0};     ///< Eventos de ActivityManager recibidos
+    std::atomic<quint64> eventsFiltered{0};     ///< Eventos descartados sin efecto
+    std::atomic<quint64> eventsProcessed{0};    ///< Eventos que modificaron el estado
+    std::atomic<quint64> eventsDropped{0};      ///< Eventos descartados por cola llena
+    std::atomic<quint64> eventsThrottled{0};    ///< Eventos rechazados por el límite de admisión
+    std::atomic<quint64> eventsCoalesced{0};    ///< Aperturas repetidas de una app dentro de la ventana
+    std::atomic<quint64> signalsEmitted{0};     ///< Señales DBus emitidas
+    std::atomic<quint64> savesPerformed{0};     ///< Guardados que escribieron a disco
+    std::atomic<quint64> bytesWritten{0};       ///< Bytes escritos (iconwearrc + snapshot)
+    std::atomic<quint64> resolverCacheHits{0};  ///< Recursos resueltos desde la caché de AppResolver
+    std::atomic<quint64> resolverCacheMisses{0}; ///< Recursos resueltos con el índice de .desktop
+    std::atomic<quint64> appsDemoted{0};        ///< Apps movidas al nivel frío
+    std::atomic<quint64> appsPromoted{0};       ///< Apps recuperadas del nivel frío
+
+    LatencyHistogram saveConfigLatency;         ///< Duración de saveConfig()
+    LatencyHistogram statsMergeLatency;         ///< Fusión de cada lote de KActivities Stats
+    LatencyHistogram dbusSlotLatency;           ///< Duración de los slots DBus públicos
+
+    /// Pone a cero todos los contadores e histogramas
+    void reset();
+};
+
+/**
+ * @class ScopedLatency
+ * @brief Mide el tiempo de vida del objeto y lo registra en un histograma
+ * 
+ * @code
+ * ScopedLatency latency(m_counters.saveConfigLatency);
+ * @endcode
+ */
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(LatencyHistogram &histogram)
+        : m_histogram(histogram)
+    {
+        m_timer.start();
+    }
+
+    ~ScopedLatency()
+    {
+        m_histogram.record(m_timer.nsecsElapsed());
+    }
+
+    ScopedLatency(const ScopedLatency &) = delete;
+    ScopedLatency &operator=(const ScopedLatency &) = delete;
+
+private:
+    LatencyHistogram &m_histogram;
+    QElapsedTimer m_timer;
+};
+
+/**
+ * @brief Memoria residente del proceso en bytes (de /proc/self/statm)
+ * @return RSS en bytes, o 0 si no está disponible
+ */
+qint64 residentMemoryBytes();
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,196 @@
+/**
+ * @file shmpublisher.cpp
+ * @brief Implementación del escritor de memoria compartida
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "shmpublisher.h"
+
+#include <QDebug>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace WearShm;
+
+ShmPublisher::~ShmPublisher()
+{
+    if (m_map) {
+        beginWrite();
+        static_cast<WearShmHeader *>(m_map)->state = Closed;
+        endWrite();
+        munmap(m_map, m_mappedSize);
+        shm_unlink(segmentName().constData());
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+bool ShmPublisher::open(const AppStore &store)
+{
+    // Un segmento de un daemon anterior no se trunca (los clientes que aún lo
+    // tengan mapeado recibirían SIGBUS): se desenlaza y se crea uno nuevo
+    shm_unlink(segmentName().constData());
+
+    // Solo el usuario: los clientes lo abren en O_RDONLY
+    m_fd = shm_open(segmentName().constData(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (m_fd < 0) {
+        qWarning() << "No se pudo crear la memoria compartida" << segmentName();
+        return false;
+    }
+    return rebuild(store);
+}
+
+void ShmPublisher::beginWrite()
+{
+    auto *header = static_cast<WearShmHeader *>(m_map);
+    header->sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void ShmPublisher::endWrite()
+{
+    auto *header = static_cast<WearShmHeader *>(m_map);
+    header->sequence.fetch_add(1, std::memory_order_release);
+}
+
+bool ShmPublisher::rebuild(const AppStore &store)
+{
+    quint32 capacity = qMax(MIN_CAPACITY, m_capacity);
+    while (capacity < quint32(store.size()) * 2) {
+        capacity <<= 1;
+    }
+
+    // Crecer el archivo antes de anunciar la nueva capacidad: los lectores
+    // vuelven a mapear en cuanto la ven
+    const size_t size = segmentSize(capacity);
+    if (size > m_mappedSize) {
+        if (ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+            return false;
+        }
+        void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (map == MAP_FAILED) {
+            return false;
+        }
+        if (m_map) {
+            munmap(m_map, m_mappedSize);
+        }
+        m_map = map;
+        m_mappedSize = size;
+    }
+
+    // Un objeto recién creado está a cero: secuencia 0 (par) y sin magic,
+    // así que ningún lector lo da por válido hasta terminar esta escritura
+    auto *header = static_cast<WearShmHeader *>(m_map);
+    beginWrite();
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->capacity = capacity;
+    header->count = 0;
+    header->state = Live;
+    header->writerPid = getpid();
+    header->halfLifeSeconds = m_halfLifeSeconds;
+    writeFormula(header);
+    std::memset(entries(m_map), 0, size_t(capacity) * sizeof(WearShmEntry));
+
+    m_capacity = capacity;
+    m_slotOfHandle.clear();
+    for (AppHandle handle = 0; handle < store.size(); ++handle) {
+        writeEntry(store, handle);
+    }
+    endWrite();
+    return true;
+}
+
+void ShmPublisher::republish(const AppStore &store)
+{
+    if (m_map) {
+        rebuild(store);
+    }
+}
+
+void ShmPublisher::setWearFormula(const WearFormula &formula)
+{
+    m_formula = formula;
+    if (!m_map) {
+        return;
+    }
+    beginWrite();
+    writeFormula(static_cast<WearShmHeader *>(m_map));
+    endWrite();
+}
+
+void ShmPublisher::writeFormula(WearShmHeader *header) const
+{
+    header->curve = m_formula.curve;
+    header->curveScale = m_formula.curveScale;
+    header->levelCap = m_formula.cap;
+}
+
+void ShmPublisher::publish(const AppStore &store, const QVector<AppHandle> &changed)
+{
+    if (!m_map || changed.isEmpty()) {
+        return;
+    }
+
+    if (quint32(store.size()) * 2 > m_capacity) {
+        rebuild(store);
+        return;
+    }
+
+    beginWrite();
+    for (AppHandle handle : changed) {
+        writeEntry(store, handle);
+    }
+    endWrite();
+}
+
+void ShmPublisher::writeEntry(const AppStore &store, AppHandle handle)
+{
+    while (m_slotOfHandle.size() <= handle) {
+        m_slotOfHandle.append(UnassignedSlot);
+    }
+
+    WearShmEntry *table = entries(m_map);
+    int slot = m_slotOfHandle.at(handle);
+    if (slot == OversizedSlot) {
+        return;
+    }
+
+    // Primera publicación de la app: buscar hueco con sondeo lineal
+    if (slot == UnassignedSlot) {
+        const QByteArray id = store.appId(handle).toUtf8();
+        if (id.isEmpty() || id.size() > MAX_APP_ID_BYTES) {
+            m_slotOfHandle[handle] = OversizedSlot;  // Solo disponible por DBus
+            return;
+        }
+
+        const quint32 hash = hashAppId(id.constData(), id.size());
+        const quint32 mask = m_capacity - 1;
+        quint32 index = hash & mask;
+        while (table[index].idLength != 0) {
+            index = (index + 1) & mask;
+        }
+
+        WearShmEntry &entry = table[index];
+        entry.hash = hash;
+        std::memcpy(entry.appId, id.constData(), id.size());
+        entry.idLength = static_cast<quint16>(id.size());
+        static_cast<WearShmHeader *>(m_map)->count++;
+        slot = static_cast<int>(index);
+        m_slotOfHandle[handle] = slot;
+    }
+
+    const AppWearInfo &info = store.info(handle);
+    WearShmEntry &entry = table[slot];
+    entry.wearLevel = info.wearLevel;
+    entry.launches = info.launches;
+    entry.reconstructions = info.reconstructions;
+    entry.activeTimeSeconds = info.activeTimeSeconds;
+    entry.lastOpenTime = info.lastOpenTime;
+    entry.wearStamp = info.wearStamp;
+    entry.wearScore = info.wearScore;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file shmpublisher.h
+ * @brief Publicación de la tabla de desgaste en memoria compartida
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Escritor del segmento descrito en wearshm.h. Lo usa TrackerWorker en
+ * cada publicación de estado, con la misma lista de handles modificados:
+ * solo se reescriben las entradas que cambiaron.
+ */
+
+#ifndef SHMPUBLISHER_H
+#define SHMPUBLISHER_H
+
+#include <QVector>
+
+#include "appstore.h"
+#include "wearformula.h"
+#include "wearshm.h"
+
+/**
+ * @class ShmPublisher
+ * @brief Crea el segmento del usuario y mantiene la tabla al día
+ * 
+ * La tabla crece (duplicando capacidad y rehaciendo el hash) cuando la
+ * ocupación supera la mitad, así el sondeo lineal sigue siendo corto. Al
+ * destruirse marca el segmento como cerrado y lo elimina.
+ */
+class ShmPublisher
+{
+public:
+    ShmPublisher() = default;
+    ~ShmPublisher();
+
+    ShmPublisher(const ShmPublisher &) = delete;
+    ShmPublisher &operator=(const ShmPublisher &) = delete;
+
+    /**
+     * @brief Crea (o trunca) el segmento y publica todas las apps
+     * @param store Estado completo
+     * @return false si no se pudo crear el segmento (se sigue solo con DBus)
+     */
+    bool open(const AppStore &store);
+
+    /**
+     * @brief Semivida que anuncia la cabecera (antes de open())
+     * @param seconds Semivida del desgaste; 0 = sin decaimiento
+     */
+    void setHalfLifeSeconds(quint32 seconds) { m_halfLifeSeconds = seconds; }
+
+    /**
+     * @brief Curva y tope que anuncia la cabecera
+     *
+     * Los lectores la aplican al decaer la puntuación. Con el segmento ya
+     * abierto se reescribe la cabecera dentro del seqlock.
+     */
+    void setWearFormula(const WearFormula &formula);
+
+    /// El segmento está creado
+    bool isOpen() const { return m_map != nullptr; }
+
+    /**
+     * @brief Publica las apps modificadas
+     * @param store Estado actual
+     * @param changed Handles modificados desde la publicación anterior
+     */
+    void publish(const AppStore &store, const QVector<AppHandle> &changed);
+
+    /**
+     * @brief Rehace la tabla tras recompactar el almacén (los handles cambiaron)
+     *
+     * Las apps que ya no están desaparecen del segmento; los lectores las
+     * ven con nivel 0, igual que a una app desconocida.
+     */
+    void republish(const AppStore &store);
+
+private:
+    /// Rehace la tabla entera con capacidad suficiente para @p store
+    bool rebuild(const AppStore &store);
+
+    /// Inserta o actualiza la entrada de una app (dentro del seqlock)
+    void writeEntry(const AppStore &store, AppHandle handle);
+
+    /// Copia la curva y el tope a la cabecera (dentro del seqlock)
+    void writeFormula(WearShm::WearShmHeader *header) const;
+
+    /// Abre la escritura: secuencia impar
+    void beginWrite();
+
+    /// Cierra la escritura: secuencia par
+    void endWrite();
+
+    /// Capacidad inicial de la tabla
+    static constexpr quint32 MIN_CAPACITY = 1024;
+
+    /// Valores especiales de m_slotOfHandle
+    static constexpr int UnassignedSlot = -1;   ///< Aún no publicada
+    static constexpr int OversizedSlot = -2;    ///< appId demasiado largo para WearShmEntry
+
+    int m_fd = -1;
+    void *m_map = nullptr;
+    size_t m_mappedSize = 0;
+    quint32 m_capacity = 0;
+    quint32 m_halfLifeSeconds = 0;
+    WearFormula m_formula;
+
+    /// handle -> índice en la tabla, o UnassignedSlot/OversizedSlot
+    QVector<int> m_slotOfHandle;
+};
+
+#endif // SHMPUBLISHER_H
@@ -0,0 +1,326 @@
+/**
+ * @file snapshot.cpp
+ * @brief Lectura (mmap) y escritura atómica del snapshot binario
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "snapshot.h"
+#include "appstore.h"
+#include <QByteArray>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace WearSnapshot {
+
+namespace {
+
+/// Orden de los appIds en el archivo: bytes UTF-8, luego longitud
+int compareIds(const char *a, quint32 aLength, const char *b, quint32 bLength)
+{
+    const int common = std::memcmp(a, b, qMin(aLength, bLength));
+    if (common != 0) {
+        return common;
+    }
+    return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+/**
+ * @brief Mapeo de solo lectura de un archivo completo
+ *
+ * mmap de POSIX en lugar de QFile::map(): el mapeo puede acabar liberándose
+ * en el hilo DBus (última copia publicada del almacén), y un QFile es un
+ * QObject que no debe destruirse fuera de su hilo.
+ */
+class Mapping
+{
+public:
+    explicit Mapping(const QString &path)
+    {
+        const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0) {
+            m_opened = true;
+            m_size = info.st_size;
+            if (m_size > 0) {
+                void *data = ::mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                m_data = data != MAP_FAILED ? static_cast<const uchar *>(data) : nullptr;
+            }
+        }
+        ::close(fd);
+    }
+
+    ~Mapping()
+    {
+        if (m_data) {
+            ::munmap(const_cast<uchar *>(m_data), static_cast<size_t>(m_size));
+        }
+    }
+
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+
+    /// El archivo existe y se pudo abrir (aunque no se haya podido mapear)
+    bool opened() const { return m_opened; }
+    /// Contenido mapeado, o nulo si mmap falló
+    const uchar *data() const { return m_data; }
+    qint64 size() const { return m_size; }
+
+private:
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    bool m_opened = false;
+};
+
+/**
+ * @brief appIds de un snapshot versión 3, leídos del mapeo sin copiarlos
+ *
+ * Dueña del mapeo: se libera con la última copia del almacén que la usa.
+ * QSaveFile reemplaza el archivo con un rename, así que reescribir el
+ * snapshot no toca las páginas ya mapeadas.
+ */
+class MappedIdTable : public AppIdTable
+{
+public:
+    MappedIdTable(std::unique_ptr<Mapping> mapping, quint32 count, qint64 recordsSize)
+        : m_mapping(std::move(mapping))
+        , m_records(reinterpret_cast<const SnapshotRecord *>(m_mapping->data() + sizeof(SnapshotHeader)))
+        , m_sorted(reinterpret_cast<const quint32 *>(m_mapping->data() + sizeof(SnapshotHeader) + recordsSize))
+        , m_strings(reinterpret_cast<const char *>(m_sorted + count))
+        , m_count(static_cast<int>(count))
+    {
+    }
+
+    int size() const override { return m_count; }
+
+    QString appId(AppHandle handle) const override
+    {
+        const SnapshotRecord &record = m_records[handle];
+        return QString::fromUtf8(m_strings + record.idOffset, static_cast<int>(record.idLength));
+    }
+
+    AppHandle find(const QString &appId) const override
+    {
+        const QByteArray key = appId.toUtf8();
+        const quint32 keyLength = static_cast<quint32>(key.size());
+        const quint32 *end = m_sorted + m_count;
+        const quint32 *it = std::lower_bound(m_sorted, end, key, [&](quint32 handle, const QByteArray &) {
+            const SnapshotRecord &record = m_records[handle];
+            return compareIds(m_strings + record.idOffset, record.idLength, key.constData(), keyLength) < 0;
+        });
+        if (it == end) {
+            return AppStore::InvalidHandle;
+        }
+        const SnapshotRecord &record = m_records[*it];
+        return compareIds(m_strings + record.idOffset, record.idLength, key.constData(), keyLength) == 0
+            ? static_cast<AppHandle>(*it) : AppStore::InvalidHandle;
+    }
+
+private:
+    std::unique_ptr<Mapping> m_mapping;
+    const SnapshotRecord *m_records;
+    const quint32 *m_sorted;        ///< Handles en orden de appId
+    const char *m_strings;
+    int m_count;
+};
+
+} // namespace
+
+QString defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+        + QStringLiteral("/iconwear/wear.snapshot");
+}
+
+quint32 crc32(const uchar *data, qint64 size, quint32 crc)
+{
+    static const QVector<quint32> table = [] {
+        QVector<quint32> t(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table.at((crc ^ data[i]) & 0xFF) ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+bool load(const QString &path, AppStore &store, quint32 *generation)
+{
+    store.clear();
+
+    auto mapping = std::make_unique<Mapping>(path);
+    if (!mapping->opened()) {
+        return false;
+    }
+
+    const qint64 size = mapping->size();
+    if (size < static_cast<qint64>(sizeof(SnapshotHeader))) {
+        qWarning() << "Snapshot truncado:" << path;
+        return false;
+    }
+
+    const uchar *data = mapping->data();
+    if (!data) {
+        qWarning() << "No se pudo mapear el snapshot:" << path;
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const bool sorted = header.version == VERSION;
+    const qint64 recordsSize = static_cast<qint64>(header.count) * sizeof(SnapshotRecord);
+    const qint64 sortedSize = sorted ? static_cast<qint64>(header.count) * sizeof(quint32) : 0;
+    if (header.magic != MAGIC || (header.version != VERSION && header.version != VERSION_UNSORTED)
+        || header.headerSize != sizeof(SnapshotHeader)
+        || header.recordSize != sizeof(SnapshotRecord)
+        || static_cast<qint64>(sizeof(SnapshotHeader)) + recordsSize + sortedSize
+               + static_cast<qint64>(header.stringsSize) != size) {
+        qWarning() << "Snapshot con cabecera inválida o de otra versión:" << path;
+        return false;
+    }
+
+    const uchar *payload = data + sizeof(SnapshotHeader);
+    if (crc32(payload, size - static_cast<qint64>(sizeof(SnapshotHeader))) != header.checksum) {
+        qWarning() << "Snapshot corrupto (checksum):" << path;
+        return false;
+    }
+
+    const auto *records = reinterpret_cast<const SnapshotRecord *>(payload);
+    const auto *order = reinterpret_cast<const quint32 *>(payload + recordsSize);
+    const char *strings = reinterpret_cast<const char *>(payload + recordsSize + sortedSize);
+
+    // Validar antes de entregar el mapeo: después solo se indexa sin comprobar
+    for (quint32 i = 0; i < header.count; ++i) {
+        if (static_cast<quint64>(records[i].idOffset) + records[i].idLength > header.stringsSize
+            || (sorted && order[i] >= header.count)) {
+            qWarning() << "Snapshot con appId fuera de rango:" << path;
+            return false;
+        }
+    }
+
+    // Versión 3: los handles son los índices de los registros y los appIds
+    // se quedan en el mapeo. Versión 2: sin orden en el archivo, cada appId
+    // se copia y se interna
+    if (sorted) {
+        store.adoptIds(QSharedPointer<const AppIdTable>(new MappedIdTable(std::move(mapping), header.count, recordsSize)));
+    } else {
+        store.reserve(static_cast<int>(header.count));
+    }
+
+    for (quint32 i = 0; i < header.count; ++i) {
+        const SnapshotRecord &record = records[i];
+        const AppHandle handle = sorted
+            ? static_cast<AppHandle>(i)
+            : store.intern(QString::fromUtf8(strings + record.idOffset, static_cast<int>(record.idLength)));
+        AppWearInfo &info = store.info(handle);
+        info.activeTimeSeconds = record.activeTimeSeconds;
+        info.lastOpenTime = record.lastOpenTime;
+        info.lastResetTime = record.lastResetTime;
+        info.wearStamp = record.wearStamp;
+        info.wearScore = record.wearScore;
+        info.wearLevel = record.wearLevel;
+        info.launches = record.launches;
+        info.reconstructions = record.reconstructions;
+    }
+
+    if (generation) {
+        *generation = header.generation;
+    }
+    return true;
+}
+
+qint64 write(const QString &path, const AppStore &store, quint32 generation)
+{
+    QVector<SnapshotRecord> records(store.size());
+    QByteArray strings;
+
+    for (AppHandle handle = 0; handle < store.size(); ++handle) {
+        const AppWearInfo &info = store.info(handle);
+        const QByteArray appId = store.appId(handle).toUtf8();
+
+        SnapshotRecord &record = records[handle];
+        std::memset(&record, 0, sizeof(record));
+        record.activeTimeSeconds = info.activeTimeSeconds;
+        record.lastOpenTime = info.lastOpenTime;
+        record.lastResetTime = info.lastResetTime;
+        record.wearStamp = info.wearStamp;
+        record.wearScore = info.wearScore;
+        record.wearLevel = info.wearLevel;
+        record.launches = info.launches;
+        record.reconstructions = info.reconstructions;
+        record.idOffset = static_cast<quint32>(strings.size());
+        record.idLength = static_cast<quint32>(appId.size());
+        strings.append(appId);
+    }
+
+    // Handles en orden de appId: la carga busca con ellos sin construir un hash
+    QVector<quint32> order(records.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](quint32 a, quint32 b) {
+        return compareIds(strings.constData() + records.at(a).idOffset, records.at(a).idLength,
+                          strings.constData() + records.at(b).idOffset, records.at(b).idLength) < 0;
+    });
+
+    const auto *recordBytes = reinterpret_cast<const uchar *>(records.constData());
+    const qint64 recordsSize = static_cast<qint64>(records.size()) * sizeof(SnapshotRecord);
+    const auto *orderBytes = reinterpret_cast<const uchar *>(order.constData());
+    const qint64 orderSize = static_cast<qint64>(order.size()) * sizeof(quint32);
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.count = static_cast<quint32>(records.size());
+    header.recordSize = sizeof(SnapshotRecord);
+    header.stringsSize = static_cast<quint64>(strings.size());
+    header.checksum = crc32(reinterpret_cast<const uchar *>(strings.constData()), strings.size(),
+                            crc32(orderBytes, orderSize, crc32(recordBytes, recordsSize)));
+    header.generation = generation;
+
+    QDir().mkpath(path.section(QLatin1Char('/'), 0, -2));
+
+    // QSaveFile escribe en un temporal y renombra: nunca queda un snapshot a medias
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "No se pudo escribir el snapshot:" << path;
+        return -1;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(recordBytes), recordsSize);
+    file.write(reinterpret_cast<const char *>(orderBytes), orderSize);
+    file.write(strings);
+    if (!file.commit()) {
+        qWarning() << "No se pudo confirmar el snapshot:" << path;
+        return -1;
+    }
+
+    return static_cast<qint64>(sizeof(header)) + recordsSize + orderSize + strings.size();
+}
+
+} // namespace WearSnapshot
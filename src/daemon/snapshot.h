@@ -0,0 +1,123 @@
+/**
+ * @file snapshot.h
+ * @brief Snapshot binario del estado del rastreador para arranque rápido
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Formato versionado y con checksum que se mapea en memoria (mmap) al
+ * iniciar el daemon. Evita parsear iconwearrc grupo a grupo: los registros
+ * son de tamaño fijo y se leen directamente del mapeo.
+ * 
+ * **Layout del archivo** (orden de bytes nativo del host):
+ * ```
+ * SnapshotHeader                 (32 bytes)
+ * SnapshotRecord × count         (64 bytes cada uno)
+ * quint32 × count                (handles ordenados por appId, versión 3)
+ * Tabla de strings UTF-8         (appIds concatenados, sin separador)
+ * ```
+ * El checksum es un CRC-32 de todo lo que sigue a la cabecera.
+ * 
+ * **Carga perezosa (versión 3):** las métricas se copian al almacén (una
+ * copia de 56 bytes por app, sin asignaciones), pero los appIds se quedan
+ * en el mapeo: AppStore los busca con una búsqueda binaria sobre los
+ * handles ordenados y solo crea el QString de una app cuando se pide su
+ * appId o se escribe en ella. El mapeo vive mientras alguna copia del
+ * almacén lo use. Un snapshot de la versión 2 se carga copiando cada appId,
+ * como antes.
+ * 
+ * KConfig (iconwearrc) sigue siendo el formato de importación/exportación
+ * y el respaldo cuando el snapshot falta o está corrupto. Ambos llevan una
+ * generación de guardado: un snapshot más antiguo que iconwearrc (corte
+ * entre las dos escrituras, o un arranque con --no-snapshot) no se usa.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <QString>
+#include <QtGlobal>
+
+class AppStore;
+
+namespace WearSnapshot {
+
+/// Identificador mágico del formato ("IWSN")
+constexpr quint32 MAGIC = 0x4E535749;
+
+/// Versión actual del formato
+constexpr quint16 VERSION = 3;
+
+/// Versión anterior (sin handles ordenados); se lee, pero no se escribe
+constexpr quint16 VERSION_UNSORTED = 2;
+
+/**
+ * @struct SnapshotHeader
+ * @brief Cabecera fija al inicio del archivo
+ */
+struct SnapshotHeader {
+    quint32 magic;          ///< MAGIC
+    quint16 version;        ///< VERSION
+    quint16 headerSize;     ///< sizeof(SnapshotHeader)
+    quint32 count;          ///< Número de registros
+    quint32 recordSize;     ///< sizeof(SnapshotRecord)
+    quint64 stringsSize;    ///< Bytes de la tabla de strings
+    quint32 checksum;       ///< CRC-32 de registros + handles ordenados + strings
+    quint32 generation;     ///< Generación de guardado (0 en archivos anteriores a ella)
+};
+
+/**
+ * @struct SnapshotRecord
+ * @brief Registro de tamaño fijo con las métricas de una app
+ */
+struct SnapshotRecord {
+    qint64 activeTimeSeconds;
+    qint64 lastOpenTime;
+    qint64 lastResetTime;
+    qint64 wearStamp;
+    qint32 wearLevel;
+    qint32 launches;
+    qint32 reconstructions;
+    quint32 idOffset;       ///< Offset del appId en la tabla de strings
+    quint32 idLength;       ///< Longitud del appId en bytes UTF-8
+    float wearScore;
+    quint32 reserved[2];    ///< Reservado (0)
+};
+
+static_assert(sizeof(SnapshotHeader) == 32, "SnapshotHeader debe medir 32 bytes");
+static_assert(sizeof(SnapshotRecord) == 64, "SnapshotRecord debe medir 64 bytes");
+
+/**
+ * @brief Ruta por defecto del snapshot (~/.local/share/iconwear/wear.snapshot)
+ */
+QString defaultPath();
+
+/**
+ * @brief Carga un snapshot en el almacén
+ * @param path Ruta del archivo
+ * @param store Almacén destino (se vacía antes de cargar)
+ * @param generation Si no es nulo, recibe la generación de la cabecera
+ * @return true si el archivo existe, es válido y se cargó completo
+ * 
+ * Valida magic, versión, tamaños y checksum antes de tocar el almacén;
+ * ante cualquier error devuelve false y deja el almacén vacío. Con la
+ * versión 3 el almacén comparte el mapeo (ver AppStore::adoptIds()).
+ */
+bool load(const QString &path, AppStore &store, quint32 *generation = nullptr);
+
+/**
+ * @brief Escribe el almacén completo como snapshot de forma atómica
+ * @param path Ruta del archivo
+ * @param store Almacén a serializar
+ * @param generation Generación de guardado que anota la cabecera
+ * @return Bytes escritos, o -1 si hubo un error
+ */
+qint64 write(const QString &path, const AppStore &store, quint32 generation = 0);
+
+/**
+ * @brief CRC-32 (polinomio IEEE 802.3) de un bloque de memoria
+ */
+quint32 crc32(const uchar *data, qint64 size, quint32 crc = 0);
+
+} // namespace WearSnapshot
+
+#endif // SNAPSHOT_H
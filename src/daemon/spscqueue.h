@@ -0,0 +1,103 @@
+/**
+ * @file spscqueue.h
+ * @brief Cola acotada sin bloqueos de un productor y un consumidor
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * Búfer circular de capacidad fija (potencia de dos). El productor solo
+ * escribe la cola (m_tail) y el consumidor solo la cabeza (m_head), así que
+ * push() y pop() no necesitan mutex ni operaciones read-modify-write: basta
+ * un par release/acquire por elemento. Ambos índices van en líneas de caché
+ * distintas para que los dos hilos no se invaliden mutuamente.
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * @class SpscQueue
+ * @brief Cola FIFO acotada para exactamente un hilo productor y uno consumidor
+ *
+ * @code
+ * SpscQueue<UsageEvent> queue(4096);
+ * queue.push(std::move(event));      // hilo productor
+ * while (queue.pop(event)) { ... }   // hilo consumidor
+ * @endcode
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    /**
+     * @brief Crea la cola
+     * @param capacity Capacidad mínima; se redondea a la siguiente potencia de dos
+     */
+    explicit SpscQueue(int capacity)
+    {
+        size_t size = 2;
+        while (size < static_cast<size_t>(qMax(2, capacity))) {
+            size <<= 1;
+        }
+        m_slots.reset(new T[size]);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @brief Encola un elemento (solo desde el hilo productor)
+     * @return false si la cola está llena; el elemento no se consume
+     */
+    bool push(T &&value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask) {
+            return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Desencola un elemento (solo desde el hilo consumidor)
+     * @return false si la cola está vacía
+     */
+    bool pop(T &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_slots[head & m_mask] = T();  // Liberar recursos del hueco (p. ej. QString)
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Elementos encolados; aproximado si se consulta mientras otro hilo opera
+    int size() const
+    {
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return static_cast<int>(m_tail.load(std::memory_order_acquire) - head);
+    }
+
+    /// Capacidad real (potencia de dos)
+    int capacity() const { return static_cast<int>(m_mask + 1); }
+
+private:
+    std::unique_ptr<T[]> m_slots;
+    size_t m_mask = 0;
+    alignas(64) std::atomic<size_t> m_head{0};  ///< Siguiente hueco a leer (consumidor)
+    alignas(64) std::atomic<size_t> m_tail{0};  ///< Siguiente hueco a escribir (productor)
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,57 @@
+/**
+ * @file statsadaptor.cpp
+ * @brief Implementación de la interfaz DBus org.kde.iconwear.Stats
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "statsadaptor.h"
+#include "perfcounters.h"
+#include "usagetracker.h"
+
+StatsAdaptor::StatsAdaptor(UsageTracker *tracker)
+    : QDBusAbstractAdaptor(tracker)
+    , m_tracker(tracker)
+{
+}
+
+QVariantMap StatsAdaptor::getCounters()
+{
+    const PerfCounters &counters = m_tracker->counters();
+
+    QVariantMap result;
+    result[QStringLiteral("eventsReceived")] = QVariant::fromValue<quint64>(counters.eventsReceived.load(std::memory_order_relaxed));
+    result[QStringLiteral("eventsFiltered")] = QVariant::fromValue<quint64>(counters.eventsFiltered.load(std::memory_order_relaxed));
+    result[QStringLiteral("eventsProcessed")] = QVariant::fromValue<quint64>(counters.eventsProcessed.load(std::memory_order_relaxed));
+    result[QStringLiteral("eventsDropped")] = QVariant::fromValue<quint64>(counters.eventsDropped.load(std::memory_order_relaxed));
+    result[QStringLiteral("eventsThrottled")] = QVariant::fromValue<quint64>(counters.eventsThrottled.load(std::memory_order_relaxed));
+    result[QStringLiteral("eventsCoalesced")] = QVariant::fromValue<quint64>(counters.eventsCoalesced.load(std::memory_order_relaxed));
+    result[QStringLiteral("signalsEmitted")] = QVariant::fromValue<quint64>(counters.signalsEmitted.load(std::memory_order_relaxed));
+    result[QStringLiteral("savesPerformed")] = QVariant::fromValue<quint64>(counters.savesPerformed.load(std::memory_order_relaxed));
+    result[QStringLiteral("bytesWritten")] = QVariant::fromValue<quint64>(counters.bytesWritten.load(std::memory_order_relaxed));
+    result[QStringLiteral("resolverCacheHits")] = QVariant::fromValue<quint64>(counters.resolverCacheHits.load(std::memory_order_relaxed));
+    result[QStringLiteral("resolverCacheMisses")] = QVariant::fromValue<quint64>(counters.resolverCacheMisses.load(std::memory_order_relaxed));
+    result[QStringLiteral("appsDemoted")] = QVariant::fromValue<quint64>(counters.appsDemoted.load(std::memory_order_relaxed));
+    result[QStringLiteral("appsPromoted")] = QVariant::fromValue<quint64>(counters.appsPromoted.load(std::memory_order_relaxed));
+    result[QStringLiteral("trackedApps")] = m_tracker->trackedAppCount();
+    result[QStringLiteral("coldApps")] = m_tracker->coldAppCount();
+    result[QStringLiteral("activeApps")] = m_tracker->activeAppCount();
+    result[QStringLiteral("queuedEvents")] = m_tracker->queuedEventCount();
+    result[QStringLiteral("residentMemoryBytes")] = residentMemoryBytes();
+    return result;
+}
+
+QVariantMap StatsAdaptor::getLatencyHistograms()
+{
+    const PerfCounters &counters = m_tracker->counters();
+
+    QVariantMap result;
+    result[QStringLiteral("saveConfig")] = counters.saveConfigLatency.toVariantMap();
+    result[QStringLiteral("statsMerge")] = counters.statsMergeLatency.toVariantMap();
+    result[QStringLiteral("dbusSlot")] = counters.dbusSlotLatency.toVariantMap();
+    return result;
+}
+
+void StatsAdaptor::resetCounters()
+{
+    m_tracker->counters().reset();
+}
@@ -0,0 +1,70 @@
+/**
+ * @file statsadaptor.h
+ * @brief Interfaz DBus org.kde.iconwear.Stats con contadores de rendimiento
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Adaptador que se registra junto a UsageTracker en /Tracker. Separa la
+ * telemetría de la API pública de org.kde.iconwear.Tracker.
+ * 
+ * **Ejemplo:**
+ * ```bash
+ * qdbus org.kde.iconwear /Tracker org.kde.iconwear.Stats.getCounters
+ * qdbus org.kde.iconwear /Tracker org.kde.iconwear.Stats.getLatencyHistograms
+ * ```
+ */
+
+#ifndef STATSADAPTOR_H
+#define STATSADAPTOR_H
+
+#include <QDBusAbstractAdaptor>
+#include <QVariantMap>
+
+class UsageTracker;
+
+/**
+ * @class StatsAdaptor
+ * @brief Expone PerfCounters de un UsageTracker por DBus
+ */
+class StatsAdaptor : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.iconwear.Stats")
+
+public:
+    /**
+     * @brief Crea el adaptador como hijo del rastreador
+     * @param tracker Rastreador cuyos contadores se exponen
+     */
+    explicit StatsAdaptor(UsageTracker *tracker);
+
+public Q_SLOTS:
+    /**
+     * @brief Contadores acumulados y estado actual
+     * @return Mapa con eventsReceived, eventsFiltered, eventsProcessed,
+     *         eventsDropped, eventsThrottled, eventsCoalesced, signalsEmitted,
+     *         savesPerformed, bytesWritten, resolverCacheHits, resolverCacheMisses,
+     *         appsDemoted (apps pasadas al nivel frío),
+     *         appsPromoted (apps frías que volvieron a memoria),
+     *         trackedApps, coldApps (apps ahora en el nivel frío),
+     *         activeApps, queuedEvents y residentMemoryBytes
+     */
+    QVariantMap getCounters();
+
+    /**
+     * @brief Histogramas de latencia
+     * @return Mapa nombre -> histograma (ver LatencyHistogram::toVariantMap())
+     *         para saveConfig, statsMerge y dbusSlot
+     */
+    QVariantMap getLatencyHistograms();
+
+    /**
+     * @brief Pone a cero todos los contadores e histogramas
+     */
+    void resetCounters();
+
+private:
+    UsageTracker *m_tracker;
+};
+
+#endif // STATSADAPTOR_H
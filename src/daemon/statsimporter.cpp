@@ -0,0 +1,65 @@
+/**
+ * @file statsimporter.cpp
+ * @brief Implementación de la importación de KActivities Stats
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "statsimporter.h"
+#include <KActivities/Stats/Query>
+#include <KActivities/Stats/ResultSet>
+#include <QDebug>
+#include <QThread>
+
+using namespace KActivities::Stats;
+
+StatsImporter::StatsImporter(qint64 watermark, QObject *parent)
+    : QObject(parent)
+    , m_watermark(watermark)
+{
+}
+
+void StatsImporter::run()
+{
+    Query query;
+    query.setAgents(QStringList{QStringLiteral("plasma-desktop")});
+    query.setOrdering(Terms::RecentlyUsedFirst);
+
+    ResultSet results(query);
+
+    QVector<ImportedStat> batch;
+    batch.reserve(BATCH_SIZE);
+    qint64 newest = m_watermark;
+    int imported = 0;
+
+    for (const ResultSet::Result &result : results) {
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            break;
+        }
+
+        // Orden por uso reciente: al llegar a la marca de agua, el resto ya se importó
+        const qint64 lastUpdate = result.lastUpdate();
+        if (lastUpdate <= m_watermark) {
+            break;
+        }
+
+        ImportedStat stat;
+        stat.resource = result.resource();
+        stat.score = result.score();
+        stat.lastUpdate = lastUpdate;
+        batch.append(stat);
+        newest = qMax(newest, lastUpdate);
+        ++imported;
+
+        if (batch.size() >= BATCH_SIZE) {
+            Q_EMIT batchReady(batch);
+            batch.clear();
+        }
+    }
+
+    if (!batch.isEmpty()) {
+        Q_EMIT batchReady(batch);
+    }
+
+    qDebug() << "KActivities Stats: importados" << imported << "resultados nuevos";
+    Q_EMIT finished(imported, newest);
+}
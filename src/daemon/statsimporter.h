@@ -0,0 +1,77 @@
+/**
+ * @file statsimporter.h
+ * @brief Importación incremental de KActivities Stats en segundo plano
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Lee el histórico de KActivities Stats fuera del hilo principal, de modo
+ * que el daemon registra su servicio DBus sin esperar a recorrer todo el
+ * ResultSet. Solo se leen resultados más recientes que la marca de agua
+ * de la última sincronización.
+ */
+
+#ifndef STATSIMPORTER_H
+#define STATSIMPORTER_H
+
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+/**
+ * @struct ImportedStat
+ * @brief Resultado de KActivities Stats pendiente de fusionar
+ */
+struct ImportedStat {
+    QString resource;               ///< Recurso tal como lo reporta KActivities
+    double score = 0.0;             ///< Puntuación de uso de KActivities
+    qint64 lastUpdate = 0;          ///< Último uso (segundos epoch)
+};
+
+Q_DECLARE_METATYPE(QVector<ImportedStat>)
+
+/**
+ * @class StatsImporter
+ * @brief Worker que recorre KActivities Stats en su propio hilo
+ * 
+ * Se mueve a un QThread y se arranca con run(). Emite los resultados en
+ * lotes (batchReady) para que el hilo principal los fusione poco a poco,
+ * y termina con finished() indicando la nueva marca de agua.
+ * 
+ * @see UsageTracker::startStatsImport()
+ */
+class StatsImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor
+     * @param watermark Último uso ya importado (segundos epoch, 0 = todo)
+     */
+    explicit StatsImporter(qint64 watermark, QObject *parent = nullptr);
+
+    /// Número de resultados por lote enviado al hilo principal
+    static constexpr int BATCH_SIZE = 100;
+
+public Q_SLOTS:
+    /**
+     * @brief Recorre los resultados más recientes que la marca de agua
+     * 
+     * Consulta por orden de uso reciente y se detiene en cuanto alcanza
+     * resultados ya importados. Respeta QThread::requestInterruption().
+     */
+    void run();
+
+Q_SIGNALS:
+    /// Lote de resultados listo para fusionar
+    void batchReady(const QVector<ImportedStat> &batch);
+
+    /// Importación terminada; @p watermark es el uso más reciente visto
+    void finished(int imported, qint64 watermark);
+
+private:
+    qint64 m_watermark;
+};
+
+#endif // STATSIMPORTER_H
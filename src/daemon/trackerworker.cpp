@@ -0,0 +1,1305 @@
+/**
+ * @file trackerworker.cpp
+ * @brief Implementación del hilo de ingesta y persistencia
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "trackerworker.h"
+#include "kamdimporter.h"
+#include "snapshot.h"
+#include "weardecay.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+//! Lee [WearFormula]; los valores fuera de rango se recortan (ver WearFormula::sanitized())
+WearFormula readWearFormula(const KSharedConfigPtr &configFile)
+{
+    const KConfigGroup group(configFile, QStringLiteral("WearFormula"));
+    WearFormula formula;
+    formula.launchWeight = group.readEntry(QStringLiteral("launchWeight"), formula.launchWeight);
+    formula.minuteWeight = group.readEntry(QStringLiteral("minuteWeight"), formula.minuteWeight);
+    const QString curve = group.readEntry(QStringLiteral("curve"), WearFormula::curveName(formula.curve));
+    bool ok = false;
+    formula.curve = WearFormula::curveFromName(curve, &ok);
+    if (!ok) {
+        qWarning() << "Curva de desgaste desconocida:" << curve << "- se usa linear";
+    }
+    formula.curveScale = group.readEntry(QStringLiteral("curveScale"), formula.curveScale);
+    formula.cap = group.readEntry(QStringLiteral("cap"), formula.cap);
+    return formula.sanitized();
+}
+
+//! Último uso conocido de una app (apertura o reset; el sello del desgaste si no hay ninguno)
+qint64 lastTouched(const AppWearInfo &info)
+{
+    const qint64 touched = qMax(info.lastOpenTime, info.lastResetTime);
+    return touched > 0 ? touched : info.wearStamp;
+}
+
+} // namespace
+
+//! Carga el estado persistido y prepara los timers (aún sin arrancar)
+TrackerWorker::TrackerWorker(PerfCounters &counters, bool useSnapshot)
+    : m_counters(counters)
+    , m_useSnapshot(useSnapshot)
+{
+    qRegisterMetaType<QVector<ImportedStat>>();
+    qRegisterMetaType<WearStatePtr>();
+
+    // Timer de escritura diferida: agrupa todos los cambios de un intervalo
+    m_saveTimer = new QTimer(this);
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(DEFAULT_SAVE_INTERVAL_SECONDS * 1000);
+    connect(m_saveTimer, &QTimer::timeout, this, &TrackerWorker::saveConfig);
+
+    // Timer de notificación: limita la frecuencia de wearLevelsChanged()
+    m_notifyTimer = new QTimer(this);
+    m_notifyTimer->setSingleShot(true);
+    m_notifyTimer->setInterval(DEFAULT_NOTIFY_INTERVAL_MS);
+    connect(m_notifyTimer, &QTimer::timeout, this, &TrackerWorker::emitPendingLevelChanges);
+
+    // Checkpoint de sesiones abiertas: solo corre mientras haya apps activas
+    m_monotonicClock.start();
+    m_activityCheckTimer = new QTimer(this);
+    m_activityCheckTimer->setInterval(DEFAULT_CHECKPOINT_INTERVAL_SECONDS * 1000);
+    connect(m_activityCheckTimer, &QTimer::timeout, this, &TrackerWorker::checkActiveApplications);
+
+    // Desalojo de particiones de actividad: solo corre mientras haya alguna que no sea la actual
+    m_partitionTimer = new QTimer(this);
+    m_partitionTimer->setSingleShot(true);
+    m_partitionTimer->setInterval(DEFAULT_ACTIVITY_IDLE_MINUTES * 60000);
+    connect(m_partitionTimer, &QTimer::timeout, this, &TrackerWorker::evictIdlePartitions);
+
+    // Nivel frío: revisión periódica de las apps que dejaron de usarse
+    m_coldTimer = new QTimer(this);
+    m_coldTimer->setInterval(COLD_CHECK_INTERVAL_MINUTES * 60000);
+    connect(m_coldTimer, &QTimer::timeout, this, &TrackerWorker::checkColdApps);
+
+    loadConfig();
+    m_resolver = new AppResolver(m_counters, m_resolverCacheSize, this);
+    m_cold.load(m_store);
+    const bool migrated = migrateLegacyIds() > 0;
+    seedWearScores();
+
+    for (AppHandle handle = 0; handle < m_store.size(); ++handle) {
+        updateRank(handle);
+    }
+
+    // Degradar antes de cargar el historial: el de las apps frías no llega a memoria
+    if (demoteColdApps() > 0 || migrated) {
+        saveConfig();
+    }
+    if (m_coldAfterSeconds > 0) {
+        m_coldTimer->start();
+    }
+    m_history.load(UsageHistory::defaultPath(), m_store);
+
+    // La fórmula pudo cambiar con el daemon parado; nadie escucha aún, sin señales
+    recomputeAllLevels();
+    m_pendingLevelChanges.clear();
+
+    m_topWorn = m_ranking.top(m_topWornSize);
+    m_rankingChanged = false;
+    m_queue.reset(new SpscQueue<UsageEvent>(m_queueCapacity));
+}
+
+//! Productor: encola sin bloquear y despierta al worker una vez por ráfaga
+bool TrackerWorker::enqueue(UsageEvent &&event)
+{
+    if (!m_queue->push(std::move(event))) {
+        m_counters.eventsDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // La barrera ordena el push frente a la lectura del flag (ver drainEvents())
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_drainScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(this, &TrackerWorker::drainEvents, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+//! Consumidor: vacía la cola entera y publica un único estado para el lote
+void TrackerWorker::drainEvents()
+{
+    // Bajar el flag antes de leer: todo push posterior programa otro vaciado
+    m_drainScheduled.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    UsageEvent event;
+    while (m_queue->pop(event)) {
+        processEvent(event);
+    }
+    publishState();
+}
+
+void TrackerWorker::processEvent(const UsageEvent &event)
+{
+    switch (event.type) {
+    case UsageEvent::Opened:
+        processOpened(event.resource, event.monotonicMs, event.activity);
+        break;
+    case UsageEvent::Closed:
+        processClosed(event.resource, event.monotonicMs);
+        break;
+    case UsageEvent::Focused:
+        processFocused(event.resource, event.monotonicMs, event.activity);
+        break;
+    case UsageEvent::Reset:
+        processReset(event.resource);
+        break;
+    case UsageEvent::ActivityChanged:
+        processActivityChanged(event.resource);
+        break;
+    case UsageEvent::Promote:
+        if (m_store.find(event.resource) == AppStore::InvalidHandle) {
+            promoteCold(event.resource);
+        }
+        break;
+    }
+}
+
+void TrackerWorker::flush()
+{
+    drainEvents();
+    // Contabilizar el tiempo de las sesiones aún abiertas antes de guardar
+    checkActiveApplications();
+    m_saveTimer->stop();
+    saveConfig();
+}
+
+void TrackerWorker::shutdown()
+{
+    if (m_importThread) {
+        m_importThread->requestInterruption();
+        m_importThread->quit();
+        m_importThread->wait();
+    }
+    // El guardado final no debe reprogramar nada: tras esto el hilo termina
+    m_shuttingDown = true;
+    flush();
+    emitPendingLevelChanges();
+    for (QTimer *timer : {m_saveTimer, m_notifyTimer, m_activityCheckTimer, m_partitionTimer, m_coldTimer}) {
+        timer->stop();
+    }
+}
+
+//! Marca la app como modificada y arranca la escritura diferida
+void TrackerWorker::markDirty(AppHandle handle)
+{
+    m_store.info(handle).dirty = true;
+    m_changedSincePublish.insert(handle);
+
+    if (!m_shuttingDown && !m_saveTimer->isActive()) {
+        m_saveTimer->start();
+    }
+}
+
+WearStatePtr TrackerWorker::takeState()
+{
+    auto *state = new WearState;
+    state->store = m_store;
+    state->activeApps = m_activeApplications.size();
+    state->halfLifeSeconds = m_halfLifeSeconds;
+    state->formula = m_formula;
+    state->history = m_history;
+    state->topWorn = m_topWorn;
+    state->activity = m_currentActivity;
+    state->coldApps = m_cold.ids();
+    state->remapped = m_storeRemapped;
+    m_storeRemapped = false;
+    if (const ActivityPartitions::Partition *partition = m_partitions.resident(m_currentActivity)) {
+        state->activityStore = partition->store;
+    }
+    m_activityStateChanged = false;
+    state->changed.reserve(m_changedSincePublish.size());
+    for (AppHandle handle : qAsConst(m_changedSincePublish)) {
+        state->changed.append(handle);
+    }
+    m_changedSincePublish.clear();
+    return WearStatePtr(state);
+}
+
+//! Publica el estado tras un lote; las ráfagas producen lotes grandes, no más copias
+void TrackerWorker::publishState()
+{
+    if (m_changedSincePublish.isEmpty() && !m_activityStateChanged && !m_storeRemapped) {
+        return;
+    }
+
+    // El ranking solo se recorre si alguna clave cambió: O(topWornSize)
+    bool membershipChanged = false;
+    if (m_rankingChanged) {
+        m_rankingChanged = false;
+        QVector<AppHandle> top = m_ranking.top(m_topWornSize);
+        QVector<AppHandle> before = m_topWorn;
+        QVector<AppHandle> after = top;
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        membershipChanged = before != after;
+        m_topWorn = std::move(top);
+    }
+
+    const WearStatePtr state = takeState();
+    m_shm.publish(m_store, state->changed);
+    Q_EMIT statePublished(state);
+
+    // Después del estado: quien reaccione con getTopWorn() ya ve el nuevo
+    if (membershipChanged) {
+        QStringList appIds;
+        appIds.reserve(m_topWorn.size());
+        for (AppHandle handle : qAsConst(m_topWorn)) {
+            appIds.append(m_store.appId(handle));
+        }
+        Q_EMIT topWornChanged(appIds);
+        m_counters.signalsEmitted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (m_activitySwitched) {
+        m_activitySwitched = false;
+        Q_EMIT activityChanged(m_currentActivity);
+        m_counters.signalsEmitted.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TrackerWorker::openSharedMemory()
+{
+    m_shm.setHalfLifeSeconds(static_cast<quint32>(m_halfLifeSeconds));
+    m_shm.setWearFormula(m_formula);
+    if (m_sharedMemoryEnabled && m_shm.open(m_store)) {
+        qDebug() << "Memoria compartida publicada en" << WearShm::segmentName();
+    }
+}
+
+//! Apertura de recurso (lanzamiento de aplicación)
+/*!
+ * **Proceso:**
+ * 1. Resuelve el recurso a su id de desktop (AppResolver, caché LRU) y lo
+ *    interna a un handle; los documentos y otros recursos se descartan
+ * 2. Registra la aplicación en la lista de activas con el instante de llegada
+ * 3. Incrementa el contador de lanzamientos
+ * 4. Recalcula el desgaste usando la fórmula ponderada
+ * 5. Programa la escritura diferida de los cambios a KConfig
+ */
+void TrackerWorker::processOpened(const QString &resource, qint64 monotonicMs, const QString &activity)
+{
+    const QString appId = m_resolver->resolve(resource);
+    if (appId.isEmpty()) {
+        m_counters.eventsFiltered.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Inicializar o localizar el registro de la aplicación (promocionándola si estaba fría)
+    const AppHandle handle = internApp(appId);
+
+    // Registrar que la aplicación está activa (para tracking de tiempo)
+    startSession(handle, monotonicMs, true, activity);
+
+    // Ráfaga de aperturas de la misma app (documentos, ventanas): la sesión
+    // lleva la cuenta para los cierres, pero solo la primera es un lanzamiento
+    if (handle >= m_lastLaunchMs.size()) {
+        const int oldSize = m_lastLaunchMs.size();
+        m_lastLaunchMs.resize(m_store.size());
+        std::fill(m_lastLaunchMs.begin() + oldSize, m_lastLaunchMs.end(), -1);
+    }
+    qint64 &lastLaunchMs = m_lastLaunchMs[handle];
+    if (lastLaunchMs >= 0 && monotonicMs - lastLaunchMs < m_launchCoalesceMs) {
+        m_counters.eventsCoalesced.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    lastLaunchMs = monotonicMs;
+
+    // Incrementar estadísticas
+    AppWearInfo &info = m_store.info(handle);
+    info.launches++;
+    info.lastOpenTime = QDateTime::currentSecsSinceEpoch();
+    m_history.recordLaunch(handle, info.lastOpenTime);
+
+    // Misma cuenta en la partición de la actividad (sin historial ni ranking)
+    if (AppWearInfo *activityInfo = partitionInfo(activity, appId)) {
+        activityInfo->launches++;
+        activityInfo->lastOpenTime = info.lastOpenTime;
+        addPartitionWear(*activityInfo, m_formula.launchWeight, info.lastOpenTime);
+    }
+
+    // Recalcular desgaste con nueva fórmula ponderada
+    addWear(handle, m_formula.launchWeight);
+    updateWearLevel(handle);
+    markDirty(handle);
+    m_counters.eventsProcessed.fetch_add(1, std::memory_order_relaxed);
+}
+
+//! Cierre de un recurso: cierra la sesión y suma su duración exacta
+void TrackerWorker::processClosed(const QString &resource, qint64 monotonicMs)
+{
+    const AppHandle handle = m_store.find(m_resolver->resolve(resource));
+    auto it = m_activeApplications.find(handle);
+    if (it == m_activeApplications.end()) {
+        m_counters.eventsFiltered.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Con varias ventanas abiertas, la sesión termina al cerrar la última
+    m_counters.eventsProcessed.fetch_add(1, std::memory_order_relaxed);
+    if (--it->openCount > 0) {
+        return;
+    }
+
+    const qint64 elapsedMs = sessionEndMs(*it, monotonicMs) - it->startMs;
+    const QString activity = it->activity;
+    m_activeApplications.erase(it);
+    addActiveTime(handle, elapsedMs, activity);
+    m_changedSincePublish.insert(handle);  // activeApps cambia aunque no sume tiempo
+    qDebug() << "App cerrada:" << m_store.appId(handle) << "tras" << elapsedMs / 1000 << "s";
+
+    if (m_activeApplications.isEmpty()) {
+        m_activityCheckTimer->stop();
+    }
+}
+
+//! Un cambio de foco mantiene viva la sesión, o la reabre si la app se abrió antes que el daemon
+void TrackerWorker::processFocused(const QString &resource, qint64 monotonicMs, const QString &activity)
+{
+    const AppHandle handle = m_store.find(m_resolver->resolve(resource));
+    if (handle == AppStore::InvalidHandle) {
+        m_counters.eventsFiltered.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto it = m_activeApplications.find(handle);
+    if (it != m_activeApplications.end()) {
+        // Tras un hueco mayor que el límite, el tiempo sin foco no cuenta
+        const qint64 end = sessionEndMs(*it, monotonicMs);
+        if (end < monotonicMs) {
+            addActiveTime(handle, end - it->startMs, it->activity);
+            it->startMs = monotonicMs;
+        }
+        it->lastSeenMs = monotonicMs;
+    } else {
+        startSession(handle, monotonicMs, false, activity);
+        m_changedSincePublish.insert(handle);
+    }
+    m_counters.eventsProcessed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TrackerWorker::processReset(const QString &appId)
+{
+    AppHandle handle = m_store.find(appId);
+    if (handle == AppStore::InvalidHandle) {
+        handle = promoteCold(appId);
+    }
+    if (handle == AppStore::InvalidHandle) {
+        return;
+    }
+
+    AppWearInfo &info = m_store.info(handle);
+
+    // Resetear desgaste pero mantener historial (el nivel se pone a 0 abajo)
+    info.reconstructions++;
+    info.lastResetTime = QDateTime::currentSecsSinceEpoch();
+    info.wearScore = 0.0f;
+    info.wearStamp = info.lastResetTime;
+    updateRank(handle);
+
+    qDebug() << "App" << appId << "reseteada. Reconstrucciones:" << info.reconstructions;
+
+    // Programar guardado
+    markDirty(handle);
+
+    // La reconstrucción se ve en la actividad actual: su partición también vuelve a 0
+    if (ActivityPartitions::Partition *partition = m_partitions.acquire(m_currentActivity, m_monotonicClock.elapsed())) {
+        const AppHandle activityHandle = partition->store.find(appId);
+        if (activityHandle != AppStore::InvalidHandle) {
+            AppWearInfo &activityInfo = partition->store.info(activityHandle);
+            activityInfo.reconstructions++;
+            activityInfo.lastResetTime = info.lastResetTime;
+            activityInfo.wearScore = 0.0f;
+            activityInfo.wearStamp = info.lastResetTime;
+            activityInfo.wearLevel = 0;
+            partition->dirty = true;
+            m_activityStateChanged = true;
+        }
+    }
+
+    // Emitir señales
+    setWearLevel(handle, 0);
+    Q_EMIT wearLevelReset(appId);
+    m_counters.signalsEmitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+//! La carga de la partición ocurre aquí; DBus sigue sirviendo el estado publicado
+void TrackerWorker::processActivityChanged(const QString &activity)
+{
+    if (activity == m_currentActivity) {
+        return;
+    }
+
+    m_currentActivity = activity;
+    m_partitions.acquire(activity, m_monotonicClock.elapsed());
+    m_activityStateChanged = true;
+    m_activitySwitched = true;
+    qDebug() << "Actividad actual:" << activity;
+
+    // La partición anterior queda residente hasta que lleve m_activityIdleMs sin uso
+    if (m_partitions.residentCount() > 1 && !m_partitionTimer->isActive()) {
+        m_partitionTimer->start();
+    }
+}
+
+QString TrackerWorker::targetActivity(const QString &activity) const
+{
+    // ActivityManager usa ":current"/":global" como comodines
+    return activity.isEmpty() || activity.startsWith(QLatin1Char(':')) ? m_currentActivity : activity;
+}
+
+AppWearInfo *TrackerWorker::partitionInfo(const QString &activity, const QString &appId)
+{
+    const QString target = targetActivity(activity);
+    ActivityPartitions::Partition *partition = m_partitions.acquire(target, m_monotonicClock.elapsed());
+    if (!partition) {
+        return nullptr;
+    }
+
+    partition->dirty = true;
+    if (target == m_currentActivity) {
+        m_activityStateChanged = true;
+    } else if (!m_partitionTimer->isActive()) {
+        m_partitionTimer->start();  // Evento de otra actividad: su partición también caduca
+    }
+    return &partition->store.info(partition->store.intern(appId));
+}
+
+void TrackerWorker::evictIdlePartitions()
+{
+    const qint64 bytes = m_partitions.evictIdle(m_monotonicClock.elapsed(), m_activityIdleMs, m_currentActivity);
+    m_counters.bytesWritten.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+    if (m_partitions.residentCount() > 1) {
+        m_partitionTimer->start();
+    }
+}
+
+qint64 TrackerWorker::sessionEndMs(const ActiveSession &session, qint64 monotonicMs) const
+{
+    return qMax(session.startMs, qMin(monotonicMs, session.lastSeenMs + m_sessionIdleMs));
+}
+
+//! Abre (o refuerza) la sesión activa de una app con timestamp monotónico
+void TrackerWorker::startSession(AppHandle handle, qint64 monotonicMs, bool countOpen, const QString &activity)
+{
+    auto it = m_activeApplications.find(handle);
+    if (it != m_activeApplications.end()) {
+        if (countOpen) {
+            // Tras un hueco mayor que el límite, el tiempo sin uso no cuenta
+            const qint64 end = sessionEndMs(*it, monotonicMs);
+            if (end < monotonicMs) {
+                addActiveTime(handle, end - it->startMs, it->activity);
+                it->startMs = monotonicMs;
+            }
+            it->openCount++;
+            it->lastSeenMs = monotonicMs;
+        }
+        return;
+    }
+
+    ActiveSession session;
+    session.startMs = monotonicMs;
+    session.lastSeenMs = monotonicMs;
+    session.activity = targetActivity(activity);
+    m_activeApplications.insert(handle, session);
+
+    if (!m_activityCheckTimer->isActive()) {
+        m_activityCheckTimer->start();
+    }
+}
+
+//! Suma tiempo activo a una app y recalcula su desgaste
+void TrackerWorker::addActiveTime(AppHandle handle, qint64 elapsedMs, const QString &activity)
+{
+    if (elapsedMs <= 0) {
+        return;
+    }
+
+    const qint64 seconds = (elapsedMs + 500) / 1000;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    m_store.info(handle).activeTimeSeconds += seconds;
+    m_history.recordActive(handle, now, seconds);
+    if (AppWearInfo *activityInfo = partitionInfo(activity, m_store.appId(handle))) {
+        activityInfo->activeTimeSeconds += seconds;
+        addPartitionWear(*activityInfo, (seconds / 60.0f) * m_formula.minuteWeight, now);
+    }
+    addWear(handle, (seconds / 60.0f) * m_formula.minuteWeight);
+    updateWearLevel(handle);
+    markDirty(handle);
+}
+
+//! Recalcula y actualiza el nivel de desgaste de una aplicación
+/*!
+ * **Fórmula de desgaste ponderada (realista y elegante):**
+ * ```
+ * desgaste = (launches × launchWeight) + (activeMinutes × minuteWeight)
+ *          = (launches × 1.0) + (activeMinutes × 0.01)     (por defecto)
+ * ```
+ * 
+ * **Ejemplos:**
+ * - VS Code abierto 50 veces, 0 min activo: desgaste = 50
+ * - Firefox abierto 2 veces, 2880 min activos (2 días): desgaste = 2 + 28.8 = 30.8
+ * - Editor de texto 100 lanzamientos, 1 min promedio: desgaste ≈ 101
+ * 
+ * **Normalización:** El desgaste pasa por la curva de [WearFormula]
+ * (linear por defecto) y se recorta al tope (100 por defecto); ver wearformula.h.
+ * 
+ * **Con decaimiento** (General/wearHalfLifeHours > 0) la fórmula no usa
+ * los totales: cada lanzamiento y cada minuto suman el mismo peso a
+ * wearScore (ver addWear()), que pierde la mitad de su valor por semivida.
+ * Lo reciente domina y las apps intensivas dejan de saturar todas en 100.
+ * 
+ * Solo notifica al Plasmoid si el nivel entero cambió (ver setWearLevel()).
+ * 
+ * @param handle Handle de la aplicación a actualizar
+ */
+void TrackerWorker::updateWearLevel(AppHandle handle)
+{
+    updateRank(handle);
+    setWearLevel(handle, wearLevelOf(m_store.info(handle), QDateTime::currentSecsSinceEpoch()));
+}
+
+//! Fórmula de updateWearLevel() sobre cualquier registro (global o de partición)
+int TrackerWorker::wearLevelOf(const AppWearInfo &info, qint64 nowSecs) const
+{
+    if (m_halfLifeSeconds > 0) {
+        return m_formula.levelAt(info.wearScore, info.wearStamp, nowSecs, m_halfLifeSeconds);
+    }
+    return m_formula.level(m_formula.rawWear(info.launches, info.activeTimeSeconds));
+}
+
+//! Pasada por lotes: brutos a arrays contiguos, curva vectorizada y comparación al final
+int TrackerWorker::recomputeAllLevels()
+{
+    const int count = m_store.size();
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    std::vector<float> raw(count);
+    std::vector<qint32> levels(count);
+
+    if (m_halfLifeSeconds > 0) {
+        for (AppHandle handle = 0; handle < count; ++handle) {
+            const AppWearInfo &info = m_store.info(handle);
+            raw[handle] = static_cast<float>(WearDecay::decayed(info.wearScore, info.wearStamp, now, m_halfLifeSeconds));
+        }
+    } else {
+        std::vector<float> launches(count);
+        std::vector<float> minutes(count);
+        for (AppHandle handle = 0; handle < count; ++handle) {
+            const AppWearInfo &info = m_store.info(handle);
+            launches[handle] = static_cast<float>(info.launches);
+            minutes[handle] = info.activeTimeSeconds / 60.0f;
+        }
+        m_formula.rawWear(launches.data(), minutes.data(), raw.data(), count);
+    }
+    m_formula.levels(raw.data(), levels.data(), count);
+
+    int changed = 0;
+    for (AppHandle handle = 0; handle < count; ++handle) {
+        AppWearInfo &info = m_store.info(handle);
+        if (info.wearLevel == levels[handle]) {
+            continue;
+        }
+        info.wearLevel = levels[handle];
+        markDirty(handle);
+        m_pendingLevelChanges.insert(m_store.appId(handle), info.wearLevel);
+        ++changed;
+    }
+
+    // Las particiones residentes son pequeñas: basta la fórmula escalar. Las
+    // que están en disco se ponen al día cuando sus apps vuelven a usarse
+    const QStringList activities = m_partitions.residentActivities();
+    for (const QString &activity : activities) {
+        ActivityPartitions::Partition *partition = m_partitions.resident(activity);
+        for (AppHandle handle = 0; handle < partition->store.size(); ++handle) {
+            AppWearInfo &info = partition->store.info(handle);
+            const int level = wearLevelOf(info, now);
+            if (info.wearLevel != level) {
+                info.wearLevel = level;
+                partition->dirty = true;
+                m_activityStateChanged |= activity == m_currentActivity;
+            }
+        }
+    }
+    return changed;
+}
+
+void TrackerWorker::reloadWearFormula()
+{
+    KSharedConfigPtr configFile = KSharedConfig::openConfig(QStringLiteral("iconwearrc"));
+    configFile->reparseConfiguration();
+    const WearFormula formula = readWearFormula(configFile);
+    if (formula == m_formula) {
+        return;
+    }
+
+    // Con semivida los pesos solo afectan al uso nuevo (la puntuación ya
+    // acumulada no guarda por separado lanzamientos y minutos); curva y
+    // tope se aplican al instante a todas las apps
+    m_formula = formula;
+    m_shm.setWearFormula(m_formula);
+
+    QElapsedTimer timer;
+    timer.start();
+    const int changed = recomputeAllLevels();
+    qDebug() << "Fórmula de desgaste recargada:" << WearFormula::curveName(m_formula.curve)
+             << "-" << changed << "de" << m_store.size() << "apps cambiaron de nivel en"
+             << timer.nsecsElapsed() / 1000 << "µs";
+
+    // Una única señal en lote con todos los cambios, sin esperar al timer
+    m_notifyTimer->stop();
+    emitPendingLevelChanges();
+    publishState();
+}
+
+//! Suma desgaste al par (puntuación, instante) sin tocar ninguna otra app
+void TrackerWorker::addWear(AppHandle handle, float amount)
+{
+    AppWearInfo &info = m_store.info(handle);
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const double current = WearDecay::decayed(info.wearScore, info.wearStamp, now, m_halfLifeSeconds);
+
+    if (m_halfLifeSeconds > 0) {
+        info.wearLevel = m_formula.level(current);
+    }
+    info.wearScore = static_cast<float>(current + amount);
+    info.wearStamp = now;
+}
+
+//! Las particiones no notifican: su nivel se guarda ya evaluado
+void TrackerWorker::addPartitionWear(AppWearInfo &info, float amount, qint64 nowSecs) const
+{
+    info.wearScore = static_cast<float>(WearDecay::decayed(info.wearScore, info.wearStamp, nowSecs, m_halfLifeSeconds) + amount);
+    info.wearStamp = nowSecs;
+    info.wearLevel = wearLevelOf(info, nowSecs);
+}
+
+//! Una sola vez por app: la puntuación parte de la fórmula acumulativa
+void TrackerWorker::seedWearScores()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    for (AppHandle handle = 0; handle < m_store.size(); ++handle) {
+        AppWearInfo &info = m_store.info(handle);
+        if (info.wearStamp != 0) {
+            continue;
+        }
+        info.wearScore = m_formula.rawWear(info.launches, info.activeTimeSeconds);
+        info.wearStamp = info.lastOpenTime > 0 ? info.lastOpenTime : now;
+        info.dirty = true;  // Se persiste con el siguiente guardado
+    }
+}
+
+//! Handle de una app, promocionándola desde el nivel frío o registrándola si es nueva
+AppHandle TrackerWorker::internApp(const QString &appId)
+{
+    const AppHandle handle = m_store.find(appId);
+    if (handle != AppStore::InvalidHandle) {
+        return handle;
+    }
+    const AppHandle promoted = promoteCold(appId);
+    return promoted != AppStore::InvalidHandle ? promoted : m_store.intern(appId);
+}
+
+AppHandle TrackerWorker::promoteCold(const QString &appId)
+{
+    AppWearInfo info;
+    if (!m_cold.take(appId, info)) {
+        return AppStore::InvalidHandle;
+    }
+
+    const AppHandle handle = m_store.intern(appId);
+    m_store.info(handle) = info;
+    m_history.restore(UsageHistory::defaultPath(), handle, appId);
+    updateRank(handle);
+    markDirty(handle);
+    m_counters.appsPromoted.fetch_add(1, std::memory_order_relaxed);
+    qDebug() << "App promocionada desde el nivel frío:" << appId;
+    return handle;
+}
+
+//! Saca del almacén las apps sin uso en m_coldAfterSeconds y recompacta los handles
+/*!
+ * Los handles son índices densos, así que degradar reconstruye el AppStore
+ * y traduce todo lo indexado por handle (sesiones, historial, ranking,
+ * memoria compartida). Es O(N) y solo ocurre cuando hay algo que degradar.
+ *
+ * Nunca se degradan apps con sesión abierta ni las del ranking publicado.
+ */
+int TrackerWorker::demoteColdApps()
+{
+    if (m_coldAfterSeconds <= 0) {
+        return 0;
+    }
+
+    const qint64 cutoff = QDateTime::currentSecsSinceEpoch() - m_coldAfterSeconds;
+    const QVector<AppHandle> top = m_ranking.top(m_topWornSize);
+    int demoted = 0;
+    for (AppHandle handle = 0; handle < m_store.size(); ++handle) {
+        if (lastTouched(m_store.info(handle)) < cutoff && !m_activeApplications.contains(handle)
+            && !top.contains(handle)) {
+            ++demoted;
+        }
+    }
+    if (demoted == 0) {
+        return 0;
+    }
+
+    QVector<AppHandle> newHandles(m_store.size(), AppStore::InvalidHandle);
+    AppStore hot;
+    hot.reserve(m_store.size() - demoted);
+    for (AppHandle handle = 0; handle < m_store.size(); ++handle) {
+        const AppWearInfo &info = m_store.info(handle);
+        const QString &appId = m_store.appId(handle);
+        if (lastTouched(info) < cutoff && !m_activeApplications.contains(handle) && !top.contains(handle)) {
+            m_cold.add(appId, info);
+            m_demotedGroups.append(appId);
+            continue;
+        }
+        const AppHandle newHandle = hot.intern(appId);
+        hot.info(newHandle) = info;
+        newHandles[handle] = newHandle;
+    }
+
+    QHash<AppHandle, ActiveSession> sessions;
+    sessions.reserve(m_activeApplications.size());
+    for (auto it = m_activeApplications.constBegin(); it != m_activeApplications.constEnd(); ++it) {
+        sessions.insert(newHandles.at(it.key()), it.value());
+    }
+    m_activeApplications = std::move(sessions);
+
+    QVector<qint64> lastLaunchMs(hot.size(), -1);
+    for (AppHandle handle = 0; handle < m_lastLaunchMs.size(); ++handle) {
+        if (newHandles.at(handle) != AppStore::InvalidHandle) {
+            lastLaunchMs[newHandles.at(handle)] = m_lastLaunchMs.at(handle);
+        }
+    }
+    m_lastLaunchMs = std::move(lastLaunchMs);
+    m_history.remap(newHandles, hot.size());
+
+    m_store = std::move(hot);
+    m_ranking.clear();
+    for (AppHandle handle = 0; handle < m_store.size(); ++handle) {
+        updateRank(handle);
+    }
+    m_topWorn = m_ranking.top(m_topWornSize);
+    m_rankingChanged = false;
+
+    // Todo handle cambió: los lectores tiran sus cachés y la memoria compartida se rehace
+    m_changedSincePublish.clear();
+    m_storeRemapped = true;
+    m_shm.republish(m_store);
+    m_snapshotStale = m_useSnapshot;
+
+    m_counters.appsDemoted.fetch_add(demoted, std::memory_order_relaxed);
+    qDebug() << demoted << "apps degradadas al nivel frío;" << m_store.size() << "residentes";
+    return demoted;
+}
+
+//! Une bajo su id de desktop las apps guardadas con el recurso en bruto ("firefox", "/usr/bin/firefox")
+/*!
+ * Antes de AppResolver cada recurso se guardaba tal cual llegaba, así que
+ * una misma app puede estar repartida en varios grupos. Solo se resuelven
+ * los ids sin sufijo .desktop (los demás se resuelven a sí mismos): con un
+ * archivo ya migrado el índice no se construye al arrancar. Las entradas que
+ * acaban en el mismo id suman lanzamientos, tiempo activo y reconstrucciones
+ * y se quedan con el máximo de la puntuación y de los sellos de tiempo.
+ *
+ * Las apps frías con id antiguo se promocionan para fusionarse (y
+ * demoteColdApps() las vuelve a degradar con el nuevo). El historial y las
+ * particiones por actividad de los ids antiguos no se fusionan: se quedan
+ * en disco con el id anterior y dejan de leerse.
+ */
+int TrackerWorker::migrateLegacyIds()
+{
+    const QLatin1String desktopSuffix(".desktop");
+    QHash<QString, QString> renamed;
+
+    for (AppHandle handle = 0; handle < m_store.size(); ++handle) {
+        const QString &appId = m_store.appId(handle);
+        if (appId.endsWith(desktopSuffix)) {
+            continue;
+        }
+        const QString resolved = m_resolver->resolve(appId);
+        if (!resolved.isEmpty() && resolved != appId) {
+            renamed.insert(appId, resolved);
+        }
+    }
+    const QSet<QString> coldIds = m_cold.ids();
+    for (const QString &appId : coldIds) {
+        if (appId.endsWith(desktopSuffix)) {
+            continue;
+        }
+        const QString resolved = m_resolver->resolve(appId);
+        AppWearInfo info;
+        if (!resolved.isEmpty() && resolved != appId && m_cold.take(appId, info)) {
+            m_store.info(m_store.intern(appId)) = info;
+            renamed.insert(appId, resolved);
+        }
+    }
+    if (renamed.isEmpty()) {
+        return 0;
+    }
+
+    AppStore merged;
+    merged.reserve(m_store.size());
+    for (AppHandle handle = 0; handle < m_store.size(); ++handle) {
+        const QString &appId = m_store.appId(handle);
+        const AppWearInfo &info = m_store.info(handle);
+        const QString target = renamed.value(appId, appId);
+        AppHandle mergedHandle = merged.find(target);
+        if (mergedHandle == AppStore::InvalidHandle) {
+            // El id nuevo puede estar frío: sus métricas también entran en la suma
+            AppWearInfo cold;
+            if (target != appId && m_cold.take(target, cold)) {
+                mergedHandle = merged.intern(target);
+                merged.info(mergedHandle) = cold;
+            }
+        }
+        if (mergedHandle == AppStore::InvalidHandle) {
+            mergedHandle = merged.intern(target);
+            merged.info(mergedHandle) = info;
+        } else {
+            AppWearInfo &into = merged.info(mergedHandle);
+            into.launches += info.launches;
+            into.activeTimeSeconds += info.activeTimeSeconds;
+            into.reconstructions += info.reconstructions;
+            into.lastOpenTime = qMax(into.lastOpenTime, info.lastOpenTime);
+            into.lastResetTime = qMax(into.lastResetTime, info.lastResetTime);
+            into.wearStamp = qMax(into.wearStamp, info.wearStamp);
+            into.wearScore = qMax(into.wearScore, info.wearScore);
+            into.wearLevel = qMax(into.wearLevel, info.wearLevel);
+        }
+        if (target != appId) {
+            merged.info(mergedHandle).dirty = true;
+            m_demotedGroups.append(appId);
+        }
+    }
+
+    m_store = std::move(merged);
+    m_snapshotStale = m_useSnapshot;
+
+    qDebug() << renamed.size() << "ids antiguos migrados a ids de desktop;" << m_store.size() << "residentes";
+    return renamed.size();
+}
+
+void TrackerWorker::checkColdApps()
+{
+    if (demoteColdApps() > 0) {
+        m_saveTimer->stop();
+        saveConfig();
+        publishState();
+    }
+}
+
+void TrackerWorker::updateRank(AppHandle handle)
+{
+    const AppWearInfo &info = m_store.info(handle);
+    if (m_ranking.update(handle, WearDecay::rankKey(info.wearScore, info.wearStamp, m_halfLifeSeconds))) {
+        m_rankingChanged = true;
+    }
+}
+
+//! Aplica un nuevo nivel y notifica solo si realmente cambió
+bool TrackerWorker::setWearLevel(AppHandle handle, int level)
+{
+    AppWearInfo &info = m_store.info(handle);
+    if (info.wearLevel == level) {
+        return false;
+    }
+    
+    info.wearLevel = level;
+    markDirty(handle);
+    
+    // Señal individual (compatibilidad) + acumulación para la señal en lote
+    const QString &appId = m_store.appId(handle);
+    Q_EMIT wearLevelChanged(appId, level);
+    m_counters.signalsEmitted.fetch_add(1, std::memory_order_relaxed);
+    m_pendingLevelChanges.insert(appId, level);
+    if (!m_notifyTimer->isActive()) {
+        m_notifyTimer->start();
+    }
+    return true;
+}
+
+//! Emite en una sola señal todos los cambios acumulados en el intervalo
+void TrackerWorker::emitPendingLevelChanges()
+{
+    if (m_pendingLevelChanges.isEmpty()) {
+        return;
+    }
+    
+    const WearLevelMap changes = m_pendingLevelChanges;
+    m_pendingLevelChanges.clear();
+    Q_EMIT wearLevelsChanged(changes);
+    m_counters.signalsEmitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+//! Checkpoint: acumula el tiempo transcurrido de las sesiones abiertas
+/*!
+ * Vuelca el tiempo de sesiones largas para que el desgaste avance y no se
+ * pierda tiempo si el daemon termina con apps abiertas. Normalmente el
+ * cierre lo decide processClosed(); una sesión sin aperturas ni foco en
+ * General/sessionIdleMinutes suma solo hasta ese límite y se cierra aquí,
+ * para que un ResourceClosed perdido no acumule desgaste sin fin.
+ */
+void TrackerWorker::checkActiveApplications()
+{
+    const qint64 now = m_monotonicClock.elapsed();
+
+    for (auto it = m_activeApplications.begin(); it != m_activeApplications.end();) {
+        const AppHandle handle = it.key();
+        const qint64 end = sessionEndMs(*it, now);
+        addActiveTime(handle, end - it->startMs, it->activity);
+        it->startMs = end;
+
+        if (now - it->lastSeenMs >= m_sessionIdleMs) {
+            qDebug() << "Sesión de" << m_store.appId(handle) << "cerrada por inactividad";
+            m_changedSincePublish.insert(handle);  // activeApps cambia
+            it = m_activeApplications.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (m_activeApplications.isEmpty()) {
+        m_activityCheckTimer->stop();
+    }
+    publishState();
+}
+
+void TrackerWorker::loadConfig()
+{
+    KSharedConfigPtr configFile = KSharedConfig::openConfig(QStringLiteral("iconwearrc"));
+
+    KConfigGroup general(configFile, QStringLiteral("General"));
+    const int saveInterval = general.readEntry(QStringLiteral("saveIntervalSeconds"), DEFAULT_SAVE_INTERVAL_SECONDS);
+    m_saveTimer->setInterval(qMax(1, saveInterval) * 1000);
+    const int notifyInterval = general.readEntry(QStringLiteral("notifyIntervalMs"), DEFAULT_NOTIFY_INTERVAL_MS);
+    m_notifyTimer->setInterval(qMax(0, notifyInterval));
+    m_statsWatermark = general.readEntry(QStringLiteral("statsWatermark"), 0LL);
+    const int checkpointInterval = general.readEntry(QStringLiteral("checkpointIntervalSeconds"), DEFAULT_CHECKPOINT_INTERVAL_SECONDS);
+    m_activityCheckTimer->setInterval(qMax(1, checkpointInterval) * 1000);
+    m_sessionIdleMs = qMax(1, general.readEntry(QStringLiteral("sessionIdleMinutes"), DEFAULT_SESSION_IDLE_MINUTES)) * 60000LL;
+    m_queueCapacity = qMax(64, general.readEntry(QStringLiteral("eventQueueCapacity"), DEFAULT_EVENT_QUEUE_CAPACITY));
+    m_sharedMemoryEnabled = general.readEntry(QStringLiteral("sharedMemory"), true);
+    m_topWornSize = qMax(1, general.readEntry(QStringLiteral("topWornSize"), DEFAULT_TOP_WORN_SIZE));
+    m_resolverCacheSize = qMax(1, general.readEntry(QStringLiteral("resolverCacheSize"), DEFAULT_RESOLVER_CACHE_SIZE));
+    m_activityIdleMs = qBound(1, general.readEntry(QStringLiteral("activityIdleMinutes"), DEFAULT_ACTIVITY_IDLE_MINUTES), 24 * 60) * 60000LL;
+    m_partitionTimer->setInterval(static_cast<int>(m_activityIdleMs));
+    m_launchCoalesceMs = qMax(0, general.readEntry(QStringLiteral("launchCoalesceMs"), DEFAULT_LAUNCH_COALESCE_MS));
+    m_admissionConfig.ignoredAgents = general.readEntry(QStringLiteral("ignoredAgents"), QStringList());
+    m_admissionConfig.ratePerSecond = qMax(0, general.readEntry(QStringLiteral("admissionRate"), DEFAULT_ADMISSION_RATE));
+    m_admissionConfig.burst = qMax(1, general.readEntry(QStringLiteral("admissionBurst"), DEFAULT_ADMISSION_BURST));
+    const double halfLifeHours = general.readEntry(QStringLiteral("wearHalfLifeHours"), 0.0);
+    // Acotada a 32 bits: es lo que anuncia la cabecera de memoria compartida
+    m_halfLifeSeconds = halfLifeHours > 0.0 ? qBound<qint64>(1, qRound64(halfLifeHours * 3600.0), 0xffffffffLL) : 0;
+    m_formula = readWearFormula(configFile);
+    m_coldAfterSeconds = qMax(0, general.readEntry(QStringLiteral("coldAfterDays"), DEFAULT_COLD_AFTER_DAYS)) * 86400LL;
+
+    m_generation = general.readEntry(QStringLiteral("generation"), 0u);
+
+    // Camino rápido: snapshot binario mapeado en memoria, si no es más
+    // antiguo que iconwearrc (corte entre las dos escrituras de saveConfig())
+    if (m_useSnapshot) {
+        quint32 snapshotGeneration = 0;
+        if (WearSnapshot::load(WearSnapshot::defaultPath(), m_store, &snapshotGeneration)) {
+            if (snapshotGeneration >= m_generation) {
+                m_generation = snapshotGeneration;
+                m_loadedFromSnapshot = true;
+                qDebug() << "Snapshot cargado para" << m_store.size() << "aplicaciones";
+                return;
+            }
+            qWarning() << "Snapshot de la generación" << snapshotGeneration << "más antiguo que iconwearrc ("
+                       << m_generation << "); se carga iconwearrc";
+            m_store.clear();
+        }
+    } else {
+        // Sin snapshot solo se escribe iconwearrc: el archivo quedaría atrás
+        QFile::remove(WearSnapshot::defaultPath());
+    }
+
+    // Respaldo/importación: cada app se guarda como subgrupo de [Applications]
+    m_snapshotStale = m_useSnapshot;
+    KConfigGroup config(configFile, QStringLiteral("Applications"));
+    const QStringList keys = config.groupList();
+    m_store.reserve(keys.size());
+    
+    for (const QString &appId : keys) {
+        AppWearInfo &info = m_store.info(m_store.intern(appId));
+        KConfigGroup appGroup = config.group(appId);
+        info.wearLevel = appGroup.readEntry(QStringLiteral("wearLevel"), 0);
+        info.launches = appGroup.readEntry(QStringLiteral("launches"), 0);
+        info.activeTimeSeconds = appGroup.readEntry(QStringLiteral("activeTimeSeconds"), 0LL);
+        info.reconstructions = appGroup.readEntry(QStringLiteral("reconstructions"), 0);
+        info.lastOpenTime = appGroup.readEntry(QStringLiteral("lastOpenTime"), 0LL);
+        info.lastResetTime = appGroup.readEntry(QStringLiteral("lastResetTime"), 0LL);
+        info.wearScore = appGroup.readEntry(QStringLiteral("wearScore"), 0.0f);
+        info.wearStamp = appGroup.readEntry(QStringLiteral("wearStamp"), 0LL);
+    }
+    
+    qDebug() << "Configuración cargada para" << keys.size() << "aplicaciones";
+}
+
+//! Escribe solo los grupos de las apps modificadas desde el último guardado
+void TrackerWorker::saveConfig()
+{
+    ScopedLatency latency(m_counters.saveConfigLatency);
+    KConfigGroup config(KSharedConfig::openConfig(QStringLiteral("iconwearrc")), QStringLiteral("Applications"));
+    int written = 0;
+    quint64 bytesWritten = 0;
+
+    // Nivel frío antes que el principal: una app degradada no puede faltar de ambos
+    const qint64 coldBytes = m_cold.save();
+    const bool coldSaved = coldBytes >= 0;
+    if (coldSaved) {
+        bytesWritten += coldBytes;
+        for (const QString &appId : qAsConst(m_demotedGroups)) {
+            config.group(appId).deleteGroup();
+            ++written;
+        }
+        m_demotedGroups.clear();
+    } else {
+        qWarning() << "No se pudo escribir el nivel frío; las apps degradadas siguen en el snapshot";
+    }
+    
+    for (AppHandle handle = 0; handle < m_store.size(); ++handle) {
+        AppWearInfo &info = m_store.info(handle);
+        if (!info.dirty) {
+            continue;
+        }
+        
+        KConfigGroup appGroup = config.group(m_store.appId(handle));
+        appGroup.writeEntry(QStringLiteral("wearLevel"), info.wearLevel);
+        appGroup.writeEntry(QStringLiteral("launches"), info.launches);
+        appGroup.writeEntry(QStringLiteral("activeTimeSeconds"), info.activeTimeSeconds);
+        appGroup.writeEntry(QStringLiteral("reconstructions"), info.reconstructions);
+        appGroup.writeEntry(QStringLiteral("lastOpenTime"), info.lastOpenTime);
+        appGroup.writeEntry(QStringLiteral("lastResetTime"), info.lastResetTime);
+        appGroup.writeEntry(QStringLiteral("wearScore"), info.wearScore);
+        appGroup.writeEntry(QStringLiteral("wearStamp"), info.wearStamp);
+        info.dirty = false;
+        ++written;
+    }
+    
+    if (written > 0) {
+        // La generación viaja con iconwearrc y después con el snapshot
+        ++m_generation;
+        KConfigGroup(config.config(), QStringLiteral("General")).writeEntry(QStringLiteral("generation"), m_generation);
+        config.sync();
+        // KConfig reescribe el archivo entero al sincronizar
+        bytesWritten += QFileInfo(QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+                                  + QStringLiteral("/iconwearrc")).size();
+        qDebug() << "Configuración guardada para" << written << "aplicaciones";
+    }
+    
+    if (m_useSnapshot && coldSaved && (written > 0 || m_snapshotStale)) {
+        const qint64 snapshotBytes = WearSnapshot::write(WearSnapshot::defaultPath(), m_store, m_generation);
+        if (snapshotBytes >= 0) {
+            m_snapshotStale = false;
+            bytesWritten += snapshotBytes;
+        }
+    }
+
+    // Las apps promocionadas ya están en el principal: limpiarlas del frío en el próximo guardado
+    if (!m_useSnapshot || !m_snapshotStale) {
+        m_cold.commitPromotions();
+    }
+    if ((!coldSaved || m_cold.isDirty()) && !m_shuttingDown && !m_saveTimer->isActive()) {
+        m_saveTimer->start();
+    }
+    
+    // Historial: solo los registros de las apps con uso nuevo, en su sitio
+    const qint64 historyBytes = m_history.save(UsageHistory::defaultPath(), m_store);
+    if (historyBytes > 0) {
+        bytesWritten += historyBytes;
+    }
+
+    // Particiones de actividad residentes con cambios (snapshot completo cada una)
+    bytesWritten += m_partitions.saveDirty();
+    
+    if (bytesWritten > 0) {
+        m_counters.savesPerformed.fetch_add(1, std::memory_order_relaxed);
+        m_counters.bytesWritten.fetch_add(bytesWritten, std::memory_order_relaxed);
+    }
+}
+
+void TrackerWorker::startStatsImport()
+{
+    if (m_importThread) {
+        return;
+    }
+
+    m_statsImported = 0;
+    m_importThread = new QThread(this);
+    auto *importer = new StatsImporter(m_statsWatermark);
+    importer->moveToThread(m_importThread);
+
+    connect(m_importThread, &QThread::started, importer, &StatsImporter::run);
+    connect(importer, &StatsImporter::batchReady, this, &TrackerWorker::mergeImportedStats);
+    connect(importer, &StatsImporter::finished, this, &TrackerWorker::onStatsImportFinished);
+    connect(importer, &StatsImporter::finished, m_importThread, &QThread::quit);
+    connect(m_importThread, &QThread::finished, importer, &QObject::deleteLater);
+    connect(m_importThread, &QThread::finished, m_importThread, &QObject::deleteLater);
+
+    m_importThread->start(QThread::LowPriority);
+}
+
+//! Fusiona resultados de KActivities sin pisar el desgaste ya calculado
+void TrackerWorker::mergeImportedStats(const QVector<ImportedStat> &batch)
+{
+    ScopedLatency latency(m_counters.statsMergeLatency);
+
+    for (const ImportedStat &stat : batch) {
+        const QString appId = m_resolver->resolve(stat.resource);
+        if (appId.isEmpty()) {
+            continue;
+        }
+        const AppHandle handle = internApp(appId);
+        AppWearInfo &info = m_store.info(handle);
+
+        // App nunca vista por el daemon: estimar lanzamientos desde la puntuación
+        if (info.launches == 0) {
+            info.launches = qMax(1, qRound(stat.score));
+            // Con semivida, el uso importado pesa según su antigüedad
+            addWear(handle, static_cast<float>(WearDecay::decayed(info.launches * m_formula.launchWeight, stat.lastUpdate,
+                                                                  QDateTime::currentSecsSinceEpoch(), m_halfLifeSeconds)));
+        }
+        info.lastOpenTime = qMax(info.lastOpenTime, stat.lastUpdate);
+
+        updateWearLevel(handle);
+        markDirty(handle);
+    }
+    publishState();
+
+    m_statsImported += batch.size();
+    Q_EMIT statsImportProgress(m_statsImported);
+    m_counters.signalsEmitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+int TrackerWorker::importKamdDatabase(const QString &databasePath, int threads)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    KamdImporter importer(databasePath, threads, m_halfLifeSeconds, now);
+    if (!importer.run()) {
+        qWarning() << "No se pudo leer" << databasePath << ":" << importer.errorString();
+        return -1;
+    }
+    const qint64 readMs = timer.elapsed();
+
+    // Totales por app (global) y por (actividad, app): varios recursos y
+    // agentes acaban en la misma app
+    struct Totals {
+        int launches = 0;
+        qint64 activeSeconds = 0;
+        qint64 lastUse = 0;
+        double score = 0.0;
+    };
+    QHash<QString, Totals> apps;
+    QHash<QString, QHash<QString, Totals>> activities;
+
+    for (const KamdUsage &usage : importer.results()) {
+        QString appId = m_resolver->resolve(usage.resource);
+        const bool launch = !appId.isEmpty();
+        if (!launch) {
+            // Documento: el tiempo es de la app que lo abrió, si está instalada
+            appId = m_resolver->resolve(usage.agent);
+            if (appId == usage.agent && !appId.endsWith(QLatin1String(".desktop"))) {
+                appId.clear();
+            }
+        }
+        if (appId.isEmpty()) {
+            continue;
+        }
+
+        const double score = (launch ? usage.eventWeight * m_formula.launchWeight : 0.0)
+            + usage.minuteWeight * m_formula.minuteWeight;
+        for (Totals *totals : {&apps[appId], &activities[usage.activity][appId]}) {
+            totals->launches += launch ? usage.events : 0;
+            totals->activeSeconds += usage.activeSeconds;
+            totals->lastUse = qMax(totals->lastUse, usage.lastUse);
+            totals->score += score;
+        }
+    }
+
+    // Máximo entre lo guardado y lo importado: idempotente
+    const auto applyTotals = [this, now](AppWearInfo &info, const Totals &totals) {
+        if (totals.launches <= info.launches && totals.activeSeconds <= info.activeTimeSeconds) {
+            return false;
+        }
+        info.launches = qMax(info.launches, totals.launches);
+        info.activeTimeSeconds = qMax(info.activeTimeSeconds, totals.activeSeconds);
+        info.lastOpenTime = qMax(info.lastOpenTime, totals.lastUse);
+        info.wearScore = static_cast<float>(qMax(WearDecay::decayed(info.wearScore, info.wearStamp, now, m_halfLifeSeconds),
+                                                 totals.score));
+        info.wearStamp = now;
+        return true;
+    };
+
+    int updated = 0;
+    for (auto it = apps.constBegin(); it != apps.constEnd(); ++it) {
+        const AppHandle handle = internApp(it.key());
+        if (applyTotals(m_store.info(handle), it.value())) {
+            updateWearLevel(handle);
+            markDirty(handle);
+            ++updated;
+        }
+    }
+    for (auto activity = activities.constBegin(); activity != activities.constEnd(); ++activity) {
+        ActivityPartitions::Partition *partition = m_partitions.acquire(activity.key(), m_monotonicClock.elapsed());
+        if (!partition) {
+            continue;  // Eventos sin actividad (o con un id no válido): solo cuentan en el global
+        }
+        for (auto it = activity->constBegin(); it != activity->constEnd(); ++it) {
+            AppWearInfo &info = partition->store.info(partition->store.intern(it.key()));
+            if (applyTotals(info, it.value())) {
+                info.wearLevel = wearLevelOf(info, now);
+                partition->dirty = true;
+            }
+        }
+    }
+
+    // KActivities Stats no debe volver a sumar lo ya importado
+    if (importer.watermark() > m_statsWatermark) {
+        m_statsWatermark = importer.watermark();
+        KConfigGroup general(KSharedConfig::openConfig(QStringLiteral("iconwearrc")), QStringLiteral("General"));
+        general.writeEntry(QStringLiteral("statsWatermark"), m_statsWatermark);
+        general.sync();
+    }
+
+    m_saveTimer->stop();
+    saveConfig();
+
+    qInfo() << "Importados" << importer.eventsRead() << "eventos de" << databasePath
+            << "con" << importer.threadsUsed() << "hilos:" << updated << "apps actualizadas,"
+            << activities.size() << "actividades, lectura" << readMs << "ms, total" << timer.elapsed() << "ms";
+    return updated;
+}
+
+void TrackerWorker::onStatsImportFinished(int imported, qint64 watermark)
+{
+    if (watermark > m_statsWatermark) {
+        m_statsWatermark = watermark;
+        KConfigGroup general(KSharedConfig::openConfig(QStringLiteral("iconwearrc")), QStringLiteral("General"));
+        general.writeEntry(QStringLiteral("statsWatermark"), m_statsWatermark);
+        general.sync();
+    }
+
+    Q_EMIT statsImportFinished(imported);
+    m_counters.signalsEmitted.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,603 @@
+/**
+ * @file trackerworker.h
+ * @brief Hilo de ingesta y persistencia del rastreador de uso
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * TrackerWorker es el único dueño del estado (AppStore, sesiones) y de la
+ * persistencia (iconwearrc y snapshot). Vive en su propio QThread: los
+ * eventos de ActivityManager le llegan por una cola SPSC sin bloqueos y
+ * los lectores (slots DBus de UsageTracker) consultan el último WearState
+ * publicado, de modo que un `sync()` lento nunca retrasa una respuesta.
+ */
+
+#ifndef TRACKERWORKER_H
+#define TRACKERWORKER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <memory>
+
+#include "activitypartitions.h"
+#include "admissionfilter.h"
+#include "appresolver.h"
+#include "appstore.h"
+#include "coldtier.h"
+#include "perfcounters.h"
+#include "shmpublisher.h"
+#include "spscqueue.h"
+#include "statsimporter.h"
+#include "usagehistory.h"
+#include "wearformula.h"
+#include "wearranking.h"
+#include "wearmetrics.h"
+
+/**
+ * @struct ActiveSession
+ * @brief Sesión abierta de una aplicación (entre ResourceOpened y ResourceClosed)
+ *
+ * Usa timestamps del reloj monotónico para que los cambios de hora del
+ * sistema no alteren la duración medida.
+ */
+struct ActiveSession {
+    qint64 startMs = 0;             ///< Inicio del tramo aún no contabilizado (ms monotónicos)
+    qint64 lastSeenMs = 0;          ///< Última apertura o foco de la app (ms monotónicos)
+    int openCount = 1;              ///< Recursos abiertos de la app (ventanas/documentos)
+    QString activity;               ///< Actividad a la que se imputa el tiempo (la de apertura)
+};
+
+/**
+ * @struct UsageEvent
+ * @brief Evento de entrada encolado hacia el worker
+ */
+struct UsageEvent {
+    enum Type : quint8 {
+        Opened,                     ///< ResourceOpened
+        Closed,                     ///< ResourceClosed
+        Focused,                    ///< ResourceFocused
+        Reset,                      ///< resetWearLevel() pedido por DBus
+        ActivityChanged,            ///< Cambió la actividad actual de KDE
+        Promote                     ///< Consulta DBus de una app del nivel frío (appId en resource)
+    };
+
+    Type type = Opened;
+    qint64 monotonicMs = 0;         ///< Instante de llegada (reloj de TrackerWorker)
+    QString resource;               ///< Recurso de ActivityManager, appId en Reset o actividad en ActivityChanged
+    QString activity;               ///< Actividad del evento (vacía = la actual)
+};
+
+/**
+ * @struct WearState
+ * @brief Estado inmutable publicado por el worker para los lectores
+ *
+ * La copia de AppStore es implícitamente compartida: publicar cuesta unos
+ * pocos contadores de referencia, y cuando el worker vuelve a escribir solo
+ * se duplican las páginas que toca (ver AppStore).
+ */
+struct WearState {
+    AppStore store;                 ///< Copia consistente de todas las métricas
+    int activeApps = 0;             ///< Apps con sesión abierta
+    QVector<AppHandle> changed;     ///< Handles modificados desde la publicación anterior
+    qint64 halfLifeSeconds = 0;     ///< Semivida del desgaste (0 = sin decaimiento)
+    WearFormula formula;            ///< Fórmula con la que se evalúan los niveles
+    UsageHistory history;           ///< Uso por horas y días de cada app
+    QVector<AppHandle> topWorn;     ///< Apps más gastadas (General/topWornSize), de mayor a menor
+    QString activity;               ///< Actividad actual (vacía si aún no se conoce)
+    AppStore activityStore;         ///< Partición de la actividad actual (ver activitypartitions.h)
+    QSet<QString> coldApps;         ///< appIds en el nivel frío (ver coldtier.h)
+    bool remapped = false;          ///< Los handles cambiaron: descartar todo lo indexado por handle
+
+    /// Nivel de una app en @p nowSecs con la semivida y la fórmula de este estado
+    int levelAt(const AppWearInfo &info, qint64 nowSecs) const
+    {
+        if (halfLifeSeconds <= 0) {
+            return info.wearLevel;
+        }
+        return formula.levelAt(info.wearScore, info.wearStamp, nowSecs, halfLifeSeconds);
+    }
+};
+
+/// Referencia compartida a un estado publicado (nunca se modifica)
+typedef QSharedPointer<const WearState> WearStatePtr;
+
+Q_DECLARE_METATYPE(WearStatePtr)
+
+/**
+ * @class TrackerWorker
+ * @brief Aplica los eventos de uso, calcula el desgaste y persiste el estado
+ *
+ * **Hilos:**
+ * - enqueue() y monotonicMs() se llaman desde el hilo de UsageTracker
+ *   (un único productor).
+ * - Todo lo demás se ejecuta en el hilo del worker.
+ *
+ * Tras cada lote de cambios publica un WearState nuevo con statePublished().
+ */
+class TrackerWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Carga el estado persistido (en el hilo que lo construye)
+     * @param counters Contadores compartidos con UsageTracker
+     * @param useSnapshot Cargar/escribir el snapshot binario (ver snapshot.h)
+     */
+    TrackerWorker(PerfCounters &counters, bool useSnapshot);
+
+    /**
+     * @brief Encola un evento para el worker (hilo productor)
+     * @param event Evento a aplicar
+     * @return false si la cola estaba llena y el evento se descartó
+     *
+     * Despierta al worker solo si no tenía ya un vaciado pendiente, así que
+     * una ráfaga de eventos cuesta una única llamada encolada de Qt.
+     */
+    bool enqueue(UsageEvent &&event);
+
+    /// Milisegundos del reloj monotónico compartido (seguro desde cualquier hilo)
+    qint64 monotonicMs() const { return m_monotonicClock.elapsed(); }
+
+    /// Eventos en cola pendientes de aplicar (aproximado)
+    int queuedEvents() const { return m_queue->size(); }
+
+    /// El estado inicial se cargó del snapshot (no de KConfig)
+    bool loadedFromSnapshot() const { return m_loadedFromSnapshot; }
+
+    /// Parámetros de admisión leídos de [General] para el filtro del productor
+    AdmissionFilter::Config admissionConfig() const { return m_admissionConfig; }
+
+    /**
+     * @brief Crea el segmento de memoria compartida y publica el estado
+     * 
+     * No hace nada si General/sharedMemory es false. Se ejecuta en el hilo
+     * del worker, a través de UsageTracker::openSharedMemory(), que solo
+     * llama el daemon; los microbenchmarks y las pruebas no lo llaman para
+     * no pisar el segmento del daemon de la sesión.
+     */
+    void openSharedMemory();
+
+    /**
+     * @brief Construye un WearState con el estado actual
+     *
+     * Vacía la lista de handles modificados. Usado para el estado inicial
+     * (antes de arrancar el hilo) y por publishState().
+     */
+    WearStatePtr takeState();
+
+    /**
+     * @brief Importa de una vez el histórico de kactivitymanagerd y lo guarda
+     * @param databasePath Base de datos de kactivitymanagerd (ver KamdImporter)
+     * @param threads Hilos lectores (<= 0: uno por núcleo)
+     * @return Apps actualizadas, o -1 si la base de datos no se pudo leer
+     *
+     * Modo sin conexión (`iconwear-daemon --import-kamd`), sin hilo propio
+     * ni DBus. Los recursos que son apps cuentan lanzamientos y tiempo; los
+     * documentos solo suman tiempo a la app del agente que los abrió. Cada
+     * app queda con el máximo entre lo guardado y lo importado, así que
+     * repetir la importación no duplica nada. Escribe el estado en un único
+     * saveConfig() y adelanta la marca de agua de KActivities Stats.
+     */
+    int importKamdDatabase(const QString &databasePath, int threads);
+
+public Q_SLOTS:
+    /**
+     * @brief Aplica los eventos pendientes, guarda todo y espera a disco
+     *
+     * Se invoca de forma bloqueante desde UsageTracker::flush().
+     */
+    void flush();
+
+    /**
+     * @brief Flush final: detiene la importación y todos los timers
+     *
+     * Debe ejecutarse en el hilo del worker antes de terminarlo. Después
+     * ningún guardado ni cambio vuelve a armar un timer, así que el worker
+     * puede destruirse al terminar su hilo.
+     */
+    void shutdown();
+
+    /// Arranca la importación incremental de KActivities Stats
+    void startStatsImport();
+
+    /**
+     * @brief Relee [WearFormula] de iconwearrc y recalcula todos los niveles
+     *
+     * Si la fórmula cambió, una sola pasada por lotes (recomputeAllLevels())
+     * actualiza todas las apps y se emite una única wearLevelsChanged() con
+     * las que cambiaron de nivel, sin señales individuales.
+     */
+    void reloadWearFormula();
+
+Q_SIGNALS:
+    /// Ver UsageTracker::wearLevelChanged()
+    void wearLevelChanged(const QString &appId, int newLevel);
+
+    /// Ver UsageTracker::wearLevelsChanged()
+    void wearLevelsChanged(const WearLevelMap &levels);
+
+    /// Ver UsageTracker::wearLevelReset()
+    void wearLevelReset(const QString &appId);
+
+    /// Ver UsageTracker::statsImportProgress()
+    void statsImportProgress(int imported);
+
+    /// Ver UsageTracker::statsImportFinished()
+    void statsImportFinished(int imported);
+
+    /// Ver UsageTracker::topWornChanged()
+    void topWornChanged(const QStringList &appIds);
+
+    /// Ver UsageTracker::activityChanged(); se emite tras publicar la partición nueva
+    void activityChanged(const QString &activity);
+
+    /**
+     * @brief Nuevo estado publicado para los lectores
+     * @param state Estado consistente tras el último lote de cambios
+     */
+    void statePublished(const WearStatePtr &state);
+
+private Q_SLOTS:
+    /// Aplica todos los eventos de la cola y publica el resultado
+    void drainEvents();
+
+    /// Guarda y libera las particiones de actividad sin uso reciente
+    void evictIdlePartitions();
+
+    /// Degrada las apps sin uso reciente y, si hubo alguna, guarda y publica
+    void checkColdApps();
+
+    /// Checkpoint del tiempo activo de las sesiones abiertas
+    void checkActiveApplications();
+
+    /**
+     * @brief Persiste el estado pendiente a KConfig y al snapshot
+     *
+     * Escribe únicamente los grupos de las aplicaciones marcadas como
+     * modificadas (AppWearInfo::dirty) y sincroniza el archivo una sola vez.
+     * Si hubo cambios, reescribe también el snapshot binario completo, y el
+     * de cada partición de actividad residente modificada.
+     */
+    void saveConfig();
+
+    /// Emite wearLevelsChanged() con los cambios acumulados
+    void emitPendingLevelChanges();
+
+    /// Fusiona un lote de resultados de KActivities Stats
+    void mergeImportedStats(const QVector<ImportedStat> &batch);
+
+    /// Persiste la nueva marca de agua al terminar la importación
+    void onStatsImportFinished(int imported, qint64 watermark);
+
+private:
+    /// Los microbenchmarks (bench/trackerbench.cpp) miden los caminos privados
+    friend class TrackerBench;
+
+    /// Aplica un evento desencolado
+    void processEvent(const UsageEvent &event);
+
+    /// Apertura: cuenta un lanzamiento y abre o refuerza la sesión
+    void processOpened(const QString &resource, qint64 monotonicMs, const QString &activity);
+
+    /// Cierre: suma la duración exacta al cerrarse el último recurso
+    void processClosed(const QString &resource, qint64 monotonicMs);
+
+    /// Foco: mantiene viva la sesión o reabre la de apps abiertas antes de arrancar el daemon
+    void processFocused(const QString &resource, qint64 monotonicMs, const QString &activity);
+
+    /// Reset: pone el desgaste a 0 y cuenta una reconstrucción
+    void processReset(const QString &appId);
+
+    /// Cambio de actividad: carga su partición aquí, fuera del hilo DBus
+    void processActivityChanged(const QString &activity);
+
+    /// Actividad a la que se imputa un evento (la actual si viene vacía o es ":current")
+    QString targetActivity(const QString &activity) const;
+
+    /**
+     * @brief Registro de una app en la partición de una actividad
+     * @return nullptr si la actividad es desconocida o inválida
+     *
+     * Carga la partición si no estaba residente y la marca como modificada.
+     */
+    AppWearInfo *partitionInfo(const QString &activity, const QString &appId);
+
+    /**
+     * @brief Recalcula el nivel de desgaste de una aplicación
+     *
+     * `desgaste = (launches * launchWeight) + (activeMinutes * minuteWeight)`,
+     * pasado por la curva y el tope de m_formula y aplicado con
+     * setWearLevel(). Con semivida, el nivel sale de wearScore decaído hasta ahora.
+     */
+    void updateWearLevel(AppHandle handle);
+
+    /// Nivel de desgaste de un registro (fórmula de updateWearLevel()) en @p nowSecs
+    int wearLevelOf(const AppWearInfo &info, qint64 nowSecs) const;
+
+    /**
+     * @brief Recalcula el nivel de todas las apps con m_formula en una pasada
+     * @return Apps cuyo nivel cambió
+     *
+     * Copia el desgaste bruto a arrays contiguos, evalúa la curva sobre el
+     * bloque entero (WearFormula::levels()) y solo entonces compara con los
+     * niveles guardados. Los cambios se acumulan en m_pendingLevelChanges
+     * sin señales individuales; quien llama decide cuándo emitirlos.
+     */
+    int recomputeAllLevels();
+
+    /**
+     * @brief Aplica un nivel de desgaste y notifica solo si cambió
+     * @return true si el nivel era distinto al anterior
+     */
+    bool setWearLevel(AppHandle handle, int level);
+
+    /**
+     * @brief Suma desgaste a la puntuación con decaimiento (O(1))
+     * @param amount Desgaste a sumar en el instante actual
+     *
+     * Lleva wearScore/wearStamp al instante actual antes de sumar, y con
+     * semivida también wearLevel, para que setWearLevel() compare contra el
+     * nivel que ven los lectores y no contra el del último evento.
+     */
+    void addWear(AppHandle handle, float amount);
+
+    /// Igual que addWear() para un registro de partición, recalculando su nivel
+    void addPartitionWear(AppWearInfo &info, float amount, qint64 nowSecs) const;
+
+    /// Inicializa wearScore en apps guardadas antes de existir el decaimiento
+    void seedWearScores();
+
+    /// Recoloca una app en m_ranking tras cambiar su wearScore (O(log N))
+    void updateRank(AppHandle handle);
+
+    /// Handle de una app: residente, promocionada desde el nivel frío o nueva
+    AppHandle internApp(const QString &appId);
+
+    /**
+     * @brief Trae una app del nivel frío al almacén residente
+     * @return Su nuevo handle, o InvalidHandle si no estaba fría
+     *
+     * Recupera también su historial del archivo usage.history.
+     */
+    AppHandle promoteCold(const QString &appId);
+
+    /**
+     * @brief Degrada al nivel frío las apps sin uso en General/coldAfterDays
+     * @return Apps degradadas; si hay alguna, todos los handles cambian
+     */
+    int demoteColdApps();
+
+    /**
+     * @brief Fusiona las apps guardadas con ids anteriores a AppResolver
+     * @return Ids antiguos migrados; si hay alguno, todos los handles cambian
+     *
+     * Solo se llama al cargar, antes de construir el ranking y el historial.
+     */
+    int migrateLegacyIds();
+
+    /**
+     * @brief Fin contable de una sesión en @p monotonicMs
+     *
+     * Una sesión sin aperturas ni foco en m_sessionIdleMs (un cierre perdido
+     * por un cuelgue o una suspensión) no suma más allá de ese límite.
+     */
+    qint64 sessionEndMs(const ActiveSession &session, qint64 monotonicMs) const;
+
+    /// Abre la sesión activa de una app o incrementa su contador
+    void startSession(AppHandle handle, qint64 monotonicMs, bool countOpen, const QString &activity);
+
+    /// Suma tiempo activo a una app (y a su partición de actividad) y recalcula su desgaste
+    void addActiveTime(AppHandle handle, qint64 elapsedMs, const QString &activity);
+
+
+    /// Carga [General] y el estado desde el snapshot o, si falla, desde KConfig
+    void loadConfig();
+
+    /**
+     * @brief Marca una aplicación como modificada y programa la escritura
+     *
+     * Único punto por el que pasa toda modificación de AppWearInfo: también
+     * la apunta para la siguiente publicación de WearState.
+     */
+    void markDirty(AppHandle handle);
+
+    /// Publica un WearState si hubo cambios desde la última publicación
+    void publishState();
+
+    /// Intervalo por defecto de escritura diferida (General/saveIntervalSeconds)
+    static constexpr int DEFAULT_SAVE_INTERVAL_SECONDS = 30;
+
+    /// Intervalo mínimo por defecto entre señales en lote (General/notifyIntervalMs)
+    static constexpr int DEFAULT_NOTIFY_INTERVAL_MS = 1000;
+
+    /// Intervalo por defecto de checkpoint de sesiones (General/checkpointIntervalSeconds)
+    static constexpr int DEFAULT_CHECKPOINT_INTERVAL_SECONDS = 300;
+
+    /// Minutos sin apertura ni foco tras los que una sesión se da por cerrada (General/sessionIdleMinutes)
+    static constexpr int DEFAULT_SESSION_IDLE_MINUTES = 60;
+
+    /// Capacidad por defecto de la cola de eventos (General/eventQueueCapacity)
+    static constexpr int DEFAULT_EVENT_QUEUE_CAPACITY = 16384;
+
+    /// Resoluciones de recursos en caché (General/resolverCacheSize)
+    static constexpr int DEFAULT_RESOLVER_CACHE_SIZE = 4096;
+
+    /// Tamaño por defecto del ranking publicado (General/topWornSize)
+    static constexpr int DEFAULT_TOP_WORN_SIZE = 20;
+
+    /// Minutos sin uso tras los que se desaloja una partición (General/activityIdleMinutes)
+    static constexpr int DEFAULT_ACTIVITY_IDLE_MINUTES = 15;
+
+    /// Ventana por defecto para agrupar aperturas repetidas (General/launchCoalesceMs)
+    static constexpr int DEFAULT_LAUNCH_COALESCE_MS = 2000;
+
+    /// Eventos admitidos por segundo por defecto (General/admissionRate)
+    static constexpr int DEFAULT_ADMISSION_RATE = 2000;
+
+    /// Ráfaga máxima admitida por defecto (General/admissionBurst)
+    static constexpr int DEFAULT_ADMISSION_BURST = 500;
+
+    /// Días sin uso tras los que una app pasa al nivel frío (General/coldAfterDays; 0 = nunca)
+    static constexpr int DEFAULT_COLD_AFTER_DAYS = 180;
+
+    /// Cada cuánto se buscan apps que degradar
+    static constexpr int COLD_CHECK_INTERVAL_MINUTES = 60;
+
+    // ============= Miembros Privados =============
+
+    /// Contadores de rendimiento (propiedad de UsageTracker)
+    PerfCounters &m_counters;
+
+    /// Almacén principal: appId internado -> AppWearInfo con todas las métricas
+    AppStore m_store;
+
+    /// Sesiones de aplicaciones actualmente abiertas
+    QHash<AppHandle, ActiveSession> m_activeApplications;
+
+    /// Reloj monotónico compartido con el productor (solo se lee tras arrancar)
+    QElapsedTimer m_monotonicClock;
+
+    /// Cola de eventos de entrada (productor: hilo de UsageTracker)
+    std::unique_ptr<SpscQueue<UsageEvent>> m_queue;
+
+    /// Hay un drainEvents() encolado que aún no empezó a vaciar
+    std::atomic<bool> m_drainScheduled{false};
+
+    /// Handles modificados desde la última publicación
+    QSet<AppHandle> m_changedSincePublish;
+
+    /// Timer de checkpoint; solo activo mientras haya sesiones abiertas
+    QTimer *m_activityCheckTimer;
+
+    /// Inactividad tras la que una sesión deja de sumar tiempo y se cierra (ms)
+    qint64 m_sessionIdleMs = DEFAULT_SESSION_IDLE_MINUTES * 60000LL;
+
+    /// Timer de disparo único que ejecuta saveConfig() tras acumular cambios
+    QTimer *m_saveTimer;
+
+    /// Cambios de nivel pendientes de emitir en wearLevelsChanged()
+    WearLevelMap m_pendingLevelChanges;
+
+    /// Timer de disparo único que limita la frecuencia de wearLevelsChanged()
+    QTimer *m_notifyTimer;
+
+    /// Hilo de la importación de KActivities Stats (nulo cuando no corre)
+    QPointer<QThread> m_importThread;
+
+    /// Último uso ya importado de KActivities Stats (segundos epoch)
+    qint64 m_statsWatermark = 0;
+
+    /// Resultados fusionados en la importación en curso
+    int m_statsImported = 0;
+
+    /// Capacidad de la cola leída de [General]
+    int m_queueCapacity = DEFAULT_EVENT_QUEUE_CAPACITY;
+
+    /// Recurso de ActivityManager -> id de desktop (hijo del worker, vive en su hilo)
+    AppResolver *m_resolver;
+
+    /// Capacidad de la caché de m_resolver leída de [General]
+    int m_resolverCacheSize = DEFAULT_RESOLVER_CACHE_SIZE;
+
+    /// Aperturas de una misma app más próximas que esto cuentan como una
+    int m_launchCoalesceMs = DEFAULT_LAUNCH_COALESCE_MS;
+
+    /// Último lanzamiento contado de cada app (reloj monotónico, por handle)
+    QVector<qint64> m_lastLaunchMs;
+
+    /// Configuración de AdmissionFilter leída de [General]
+    AdmissionFilter::Config m_admissionConfig;
+
+    /// Desgaste por actividad; solo la actual y las usadas hace poco están en memoria
+    ActivityPartitions m_partitions;
+
+    /// Actividad actual de KDE (vacía hasta el primer CurrentActivityChanged)
+    QString m_currentActivity;
+
+    /// Timer de desalojo; solo activo mientras haya particiones además de la actual
+    QTimer *m_partitionTimer;
+
+    /// Inactividad tras la que se desaloja una partición (ms)
+    qint64 m_activityIdleMs = DEFAULT_ACTIVITY_IDLE_MINUTES * 60000LL;
+
+    /// La partición actual cambió desde la última publicación
+    bool m_activityStateChanged = false;
+
+    /// Hay que emitir activityChanged() tras la próxima publicación
+    bool m_activitySwitched = false;
+
+    /// Apps degradadas por falta de uso; fuera de m_store y de los guardados periódicos
+    ColdTier m_cold;
+
+    /// Inactividad tras la que una app se degrada (s); 0 = sin nivel frío
+    qint64 m_coldAfterSeconds = DEFAULT_COLD_AFTER_DAYS * 86400LL;
+
+    /// Timer de revisión del nivel frío
+    QTimer *m_coldTimer;
+
+    /// Apps degradadas o migradas a otro id cuyo grupo de iconwearrc falta borrar
+    QStringList m_demotedGroups;
+
+    /// Los handles se recompactaron desde la última publicación
+    bool m_storeRemapped = false;
+
+    /// Uso por horas y días de cada app (usage.history)
+    UsageHistory m_history;
+
+    /// Apps ordenadas por desgaste (WearDecay::rankKey())
+    WearRanking m_ranking;
+
+    /// Ranking publicado en el último WearState
+    QVector<AppHandle> m_topWorn;
+
+    /// m_ranking cambió desde la última publicación
+    bool m_rankingChanged = false;
+
+    /// Apps del ranking publicado (General/topWornSize)
+    int m_topWornSize = DEFAULT_TOP_WORN_SIZE;
+
+    /// Tabla de desgaste en memoria compartida para lectores locales
+    ShmPublisher m_shm;
+
+    /// Publicar en memoria compartida (General/sharedMemory)
+    bool m_sharedMemoryEnabled = true;
+
+    /// Semivida del desgaste (General/wearHalfLifeHours); 0 = desgaste acumulativo
+    qint64 m_halfLifeSeconds = 0;
+
+    /// Pesos, curva y tope del desgaste (grupo [WearFormula])
+    WearFormula m_formula;
+
+    /// Usar el snapshot binario como formato principal de arranque
+    bool m_useSnapshot;
+
+    /// El estado actual se cargó del snapshot (no de KConfig)
+    bool m_loadedFromSnapshot = false;
+
+    /// El snapshot en disco no refleja el estado (p. ej. tras cargar de KConfig)
+    bool m_snapshotStale = false;
+
+    /// shutdown() en curso: los guardados ya no programan otros
+    bool m_shuttingDown = false;
+
+    /**
+     * @brief Generación del último guardado (General/generation y cabecera del snapshot)
+     *
+     * Crece con cada guardado de iconwearrc, que se escribe antes que el
+     * snapshot; al arrancar solo se usa un snapshot de generación >= la de
+     * iconwearrc.
+     */
+    quint32 m_generation = 0;
+};
+
+#endif // TRACKERWORKER_H
@@ -0,0 +1,391 @@
+/**
+ * @file usagehistory.cpp
+ * @brief Implementación del historial de uso por buckets
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "usagehistory.h"
+#include <QByteArray>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+#include <cstring>
+
+namespace {
+
+/// "IWHI" en little-endian
+constexpr quint32 HISTORY_MAGIC = 0x49485749;
+constexpr quint16 HISTORY_VERSION = 1;
+
+/// Longitud máxima del appId persistido; los más largos solo viven en memoria
+constexpr int MAX_APP_ID_BYTES = 110;
+
+struct HistoryFileHeader {
+    quint32 magic;          ///< HISTORY_MAGIC
+    quint16 version;        ///< HISTORY_VERSION
+    quint16 headerSize;     ///< sizeof(HistoryFileHeader)
+    quint32 recordSize;     ///< RECORD_SIZE
+    quint32 hourBuckets;    ///< UsageHistory::HOUR_BUCKETS
+    quint32 dayBuckets;     ///< UsageHistory::DAY_BUCKETS
+    quint32 reserved[3];    ///< Reservado (0)
+};
+
+struct HistoryRecordHeader {
+    qint64 hourNewest;                  ///< Ring::newest de las horas (-1 = vacío)
+    qint64 dayNewest;                   ///< Ring::newest de los días (-1 = vacío)
+    quint16 idLength;                   ///< Bytes válidos de appId
+    char appId[MAX_APP_ID_BYTES];       ///< appId en UTF-8, sin terminador
+};
+
+static_assert(sizeof(HistoryFileHeader) == 32, "HistoryFileHeader debe medir 32 bytes");
+static_assert(sizeof(HistoryRecordHeader) == 128, "HistoryRecordHeader debe medir 128 bytes");
+
+constexpr qint64 COLUMNS_SIZE = 2 * qint64(sizeof(quint32)) * (UsageHistory::HOUR_BUCKETS + UsageHistory::DAY_BUCKETS);
+constexpr qint64 RECORD_SIZE = qint64(sizeof(HistoryRecordHeader)) + COLUMNS_SIZE;
+
+/// Copia una columna del archivo y avanza el cursor
+void readColumn(const uchar *&cursor, QVector<quint32> &column, int size)
+{
+    column.resize(size);
+    std::memcpy(column.data(), cursor, size_t(size) * sizeof(quint32));
+    cursor += size_t(size) * sizeof(quint32);
+}
+
+/// Escribe una columna (ceros si el anillo está vacío) y avanza el cursor
+void writeColumn(char *&cursor, const QVector<quint32> &column, int size)
+{
+    if (column.size() == size) {
+        std::memcpy(cursor, column.constData(), size_t(size) * sizeof(quint32));
+    } else {
+        std::memset(cursor, 0, size_t(size) * sizeof(quint32));
+    }
+    cursor += size_t(size) * sizeof(quint32);
+}
+
+/// Cabecera de un archivo de este formato y con estas dimensiones
+bool isCompatible(const HistoryFileHeader &header)
+{
+    return header.magic == HISTORY_MAGIC && header.version == HISTORY_VERSION
+        && header.headerSize == sizeof(HistoryFileHeader) && header.recordSize == RECORD_SIZE
+        && header.hourBuckets == UsageHistory::HOUR_BUCKETS && header.dayBuckets == UsageHistory::DAY_BUCKETS;
+}
+
+} // namespace
+
+QString UsageHistory::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+        + QStringLiteral("/iconwear/usage.history");
+}
+
+UsageHistory::AppHistory &UsageHistory::app(AppHandle handle)
+{
+    if (handle >= m_apps.size()) {
+        m_apps.resize(handle + 1);
+    }
+    return m_apps[handle];
+}
+
+void UsageHistory::add(Ring &ring, int size, qint64 bucket, quint32 launches, quint32 seconds)
+{
+    if (ring.launches.isEmpty()) {
+        ring.launches.fill(0, size);
+        ring.activeSeconds.fill(0, size);
+        ring.newest = bucket;
+    }
+
+    if (bucket > ring.newest) {
+        // Los huecos que pasan a representar buckets nuevos se vacían; el
+        // avance está acotado por el tamaño del anillo
+        const qint64 advance = qMin<qint64>(bucket - ring.newest, size);
+        for (qint64 b = bucket - advance + 1; b <= bucket; ++b) {
+            const int slot = static_cast<int>(b % size);
+            ring.launches[slot] = 0;
+            ring.activeSeconds[slot] = 0;
+        }
+        ring.newest = bucket;
+    } else if (bucket <= ring.newest - size) {
+        return;  // Más antiguo que la ventana
+    }
+
+    const int slot = static_cast<int>(bucket % size);
+    ring.launches[slot] += launches;
+    ring.activeSeconds[slot] += seconds;
+}
+
+void UsageHistory::spread(Ring &ring, int size, qint64 width, qint64 endSecs, qint64 seconds)
+{
+    qint64 until = endSecs;
+    while (seconds > 0 && until > 0) {
+        const qint64 bucket = (until - 1) / width;
+        if (!ring.launches.isEmpty() && bucket <= ring.newest - size) {
+            break;  // El resto cae fuera de la ventana
+        }
+        const qint64 chunk = qMin(seconds, until - bucket * width);
+        add(ring, size, bucket, 0, static_cast<quint32>(chunk));
+        seconds -= chunk;
+        until = bucket * width;
+    }
+}
+
+void UsageHistory::recordLaunch(AppHandle handle, qint64 nowSecs)
+{
+    AppHistory &history = app(handle);
+    add(history.hours, HOUR_BUCKETS, nowSecs / HOUR_SECONDS, 1, 0);
+    add(history.days, DAY_BUCKETS, nowSecs / DAY_SECONDS, 1, 0);
+    history.dirty = true;
+    m_hasDirty = true;
+}
+
+void UsageHistory::recordActive(AppHandle handle, qint64 endSecs, qint64 seconds)
+{
+    if (seconds <= 0) {
+        return;
+    }
+    AppHistory &history = app(handle);
+    spread(history.hours, HOUR_BUCKETS, HOUR_SECONDS, endSecs, seconds);
+    spread(history.days, DAY_BUCKETS, DAY_SECONDS, endSecs, seconds);
+    history.dirty = true;
+    m_hasDirty = true;
+}
+
+UsageBucketList UsageHistory::queryRing(const Ring &ring, int size, qint64 width, qint64 from, qint64 to)
+{
+    UsageBucketList result;
+    if (ring.launches.isEmpty() || to <= from) {
+        return result;
+    }
+
+    // Solo la intersección del rango con la ventana: O(min(rango, tamaño))
+    const qint64 first = qMax(qMax<qint64>(from, 0) / width, ring.newest - size + 1);
+    const qint64 last = qMin((to - 1) / width, ring.newest);
+    for (qint64 bucket = first; bucket <= last; ++bucket) {
+        const int slot = static_cast<int>(bucket % size);
+        if (ring.launches.at(slot) == 0 && ring.activeSeconds.at(slot) == 0) {
+            continue;
+        }
+        UsageBucket entry;
+        entry.start = bucket * width;
+        entry.launches = static_cast<int>(ring.launches.at(slot));
+        entry.activeSeconds = static_cast<int>(ring.activeSeconds.at(slot));
+        result.append(entry);
+    }
+    return result;
+}
+
+UsageBucketList UsageHistory::query(AppHandle handle, qint64 from, qint64 to, Granularity granularity) const
+{
+    if (handle < 0 || handle >= m_apps.size()) {
+        return UsageBucketList();
+    }
+    const AppHistory &history = m_apps.at(handle);
+    if (granularity == Hour) {
+        return queryRing(history.hours, HOUR_BUCKETS, HOUR_SECONDS, from, to);
+    }
+    return queryRing(history.days, DAY_BUCKETS, DAY_SECONDS, from, to);
+}
+
+bool UsageHistory::load(const QString &path, const AppStore &store)
+{
+    m_apps.clear();
+    m_fileSlots = 0;
+    m_rewrite = true;
+    m_hasDirty = false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size < static_cast<qint64>(sizeof(HistoryFileHeader))) {
+        return false;
+    }
+    const uchar *data = file.map(0, size);
+    if (!data) {
+        qWarning() << "No se pudo mapear el historial:" << path;
+        return false;
+    }
+
+    HistoryFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (!isCompatible(header)) {
+        qWarning() << "Historial incompatible, se reescribirá:" << path;
+        return false;
+    }
+
+    // Un registro final a medias (escritura interrumpida) se descarta
+    const int records = static_cast<int>((size - static_cast<qint64>(sizeof(HistoryFileHeader))) / RECORD_SIZE);
+    for (int slot = 0; slot < records; ++slot) {
+        const uchar *cursor = data + sizeof(HistoryFileHeader) + slot * RECORD_SIZE;
+        HistoryRecordHeader record;
+        std::memcpy(&record, cursor, sizeof(record));
+        cursor += sizeof(record);
+
+        if (record.idLength == 0 || record.idLength > MAX_APP_ID_BYTES) {
+            continue;
+        }
+        const AppHandle handle = store.find(QString::fromUtf8(record.appId, record.idLength));
+        if (handle == AppStore::InvalidHandle) {
+            continue;  // El hueco queda ocupado; no se reutiliza
+        }
+
+        readRecord(record.hourNewest, record.dayNewest, cursor, slot, app(handle));
+    }
+
+    m_fileSlots = records;
+    m_rewrite = false;
+    return true;
+}
+
+void UsageHistory::readRecord(qint64 hourNewest, qint64 dayNewest, const uchar *columns, int slot, AppHistory &history)
+{
+    history.fileSlot = slot;
+    history.dirty = false;
+    history.hours.newest = hourNewest;
+    history.days.newest = dayNewest;
+    readColumn(columns, history.hours.launches, HOUR_BUCKETS);
+    readColumn(columns, history.hours.activeSeconds, HOUR_BUCKETS);
+    readColumn(columns, history.days.launches, DAY_BUCKETS);
+    readColumn(columns, history.days.activeSeconds, DAY_BUCKETS);
+    if (history.hours.newest < 0) {
+        history.hours = Ring();
+    }
+    if (history.days.newest < 0) {
+        history.days = Ring();
+    }
+}
+
+bool UsageHistory::restore(const QString &path, AppHandle handle, const QString &appId)
+{
+    const QByteArray id = appId.toUtf8();
+    if (m_rewrite || id.isEmpty() || id.size() > MAX_APP_ID_BYTES) {
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = file.size();
+    const uchar *data = size >= static_cast<qint64>(sizeof(HistoryFileHeader)) ? file.map(0, size) : nullptr;
+    if (!data) {
+        return false;
+    }
+    HistoryFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (!isCompatible(header)) {
+        return false;
+    }
+
+    // Solo se miran los appIds; el último registro de la app es el vigente
+    const int records = qMin(m_fileSlots, static_cast<int>((size - static_cast<qint64>(sizeof(HistoryFileHeader))) / RECORD_SIZE));
+    for (int slot = records - 1; slot >= 0; --slot) {
+        const uchar *cursor = data + sizeof(HistoryFileHeader) + slot * RECORD_SIZE;
+        HistoryRecordHeader record;
+        std::memcpy(&record, cursor, sizeof(record));
+        if (record.idLength != id.size() || std::memcmp(record.appId, id.constData(), id.size()) != 0) {
+            continue;
+        }
+        readRecord(record.hourNewest, record.dayNewest, cursor + sizeof(record), slot, app(handle));
+        return true;
+    }
+    return false;
+}
+
+void UsageHistory::remap(const QVector<AppHandle> &newHandles, int size)
+{
+    // Las apps que desaparecen no tienen uso sin guardar: llevan meses sin abrirse
+    QVector<AppHistory> apps(size);
+    const int count = qMin(m_apps.size(), newHandles.size());
+    for (AppHandle handle = 0; handle < count; ++handle) {
+        const AppHandle target = newHandles.at(handle);
+        if (target != AppStore::InvalidHandle) {
+            apps[target] = m_apps.at(handle);
+        }
+    }
+    m_apps = std::move(apps);
+}
+
+qint64 UsageHistory::save(const QString &path, const AppStore &store)
+{
+    if (!m_hasDirty && (!m_rewrite || m_apps.isEmpty())) {
+        return 0;
+    }
+    QDir().mkpath(path.section(QLatin1Char('/'), 0, -2));
+
+    QIODevice::OpenMode mode = QIODevice::ReadWrite;
+    if (m_rewrite) {
+        mode |= QIODevice::Truncate;
+        m_fileSlots = 0;
+        for (AppHistory &history : m_apps) {
+            history.fileSlot = -1;
+            history.dirty = !history.hours.launches.isEmpty() || !history.days.launches.isEmpty();
+        }
+    }
+
+    QFile file(path);
+    if (!file.open(mode)) {
+        qWarning() << "No se pudo escribir el historial:" << path;
+        return -1;
+    }
+
+    qint64 written = 0;
+    if (m_rewrite) {
+        HistoryFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = HISTORY_MAGIC;
+        header.version = HISTORY_VERSION;
+        header.headerSize = sizeof(HistoryFileHeader);
+        header.recordSize = RECORD_SIZE;
+        header.hourBuckets = HOUR_BUCKETS;
+        header.dayBuckets = DAY_BUCKETS;
+        written += file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        m_rewrite = false;
+    }
+
+    QByteArray buffer(static_cast<int>(RECORD_SIZE), Qt::Uninitialized);
+    for (AppHandle handle = 0; handle < m_apps.size(); ++handle) {
+        AppHistory &history = m_apps[handle];
+        if (!history.dirty) {
+            continue;
+        }
+
+        const QByteArray id = store.appId(handle).toUtf8();
+        if (id.size() > MAX_APP_ID_BYTES) {
+            history.dirty = false;  // Solo en memoria
+            continue;
+        }
+        if (history.fileSlot < 0) {
+            history.fileSlot = m_fileSlots++;
+        }
+
+        HistoryRecordHeader record;
+        std::memset(&record, 0, sizeof(record));
+        record.hourNewest = history.hours.launches.isEmpty() ? -1 : history.hours.newest;
+        record.dayNewest = history.days.launches.isEmpty() ? -1 : history.days.newest;
+        record.idLength = static_cast<quint16>(id.size());
+        std::memcpy(record.appId, id.constData(), id.size());
+
+        char *cursor = buffer.data();
+        std::memcpy(cursor, &record, sizeof(record));
+        cursor += sizeof(record);
+        writeColumn(cursor, history.hours.launches, HOUR_BUCKETS);
+        writeColumn(cursor, history.hours.activeSeconds, HOUR_BUCKETS);
+        writeColumn(cursor, history.days.launches, DAY_BUCKETS);
+        writeColumn(cursor, history.days.activeSeconds, DAY_BUCKETS);
+
+        if (!file.seek(static_cast<qint64>(sizeof(HistoryFileHeader)) + history.fileSlot * RECORD_SIZE)
+            || file.write(buffer) != buffer.size()) {
+            qWarning() << "Error escribiendo el historial:" << path;
+            return -1;
+        }
+        history.dirty = false;
+        written += buffer.size();
+    }
+
+    m_hasDirty = false;
+    return written;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file usagehistory.h
+ * @brief Historial de uso por app en buckets horarios y diarios
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Cada app tiene dos búferes circulares de tamaño fijo: las últimas
+ * HOUR_BUCKETS horas y los últimos DAY_BUCKETS días (UTC). Cada bucket
+ * guarda lanzamientos y segundos activos en columnas separadas. Los días
+ * son el agregado de sus horas, así que cuando una hora sale de la ventana
+ * horaria su uso sigue contado en el día correspondiente.
+ * 
+ * La memoria por app es fija (~4 KB) y solo se reserva la primera vez que
+ * la app registra uso. Las consultas recorren solo los buckets del rango
+ * pedido dentro de la ventana, nunca el historial completo.
+ * 
+ * **Archivo** (~/.local/share/iconwear/usage.history, orden de bytes nativo):
+ * ```
+ * HistoryFileHeader                    (32 bytes)
+ * registro × N                         (RECORD_SIZE bytes cada uno)
+ *   HistoryRecordHeader                (128 bytes: appId y bucket más reciente)
+ *   quint32 launches[HOUR_BUCKETS], activeSeconds[HOUR_BUCKETS]
+ *   quint32 launches[DAY_BUCKETS],  activeSeconds[DAY_BUCKETS]
+ * ```
+ * Cada app ocupa siempre el mismo registro, así que guardar reescribe en
+ * su sitio solo los registros de las apps que cambiaron.
+ */
+
+#ifndef USAGEHISTORY_H
+#define USAGEHISTORY_H
+
+#include <QString>
+#include <QVector>
+
+#include "appstore.h"
+#include "wearmetrics.h"
+
+/**
+ * @class UsageHistory
+ * @brief Tabla de historiales indexada por AppHandle
+ * 
+ * Tipo valor con datos implícitamente compartidos: TrackerWorker escribe
+ * y publica copias en WearState igual que con AppStore.
+ */
+class UsageHistory
+{
+public:
+    /// Resolución de una consulta
+    enum Granularity {
+        Hour,
+        Day
+    };
+
+    /// Horas en la ventana horaria (una semana)
+    static constexpr int HOUR_BUCKETS = 24 * 7;
+
+    /// Días en la ventana diaria (un año)
+    static constexpr int DAY_BUCKETS = 366;
+
+    static constexpr qint64 HOUR_SECONDS = 3600;
+    static constexpr qint64 DAY_SECONDS = 86400;
+
+    /// Cuenta un lanzamiento en el instante @p nowSecs (segundos epoch)
+    void recordLaunch(AppHandle handle, qint64 nowSecs);
+
+    /**
+     * @brief Reparte tiempo activo entre los buckets que abarca
+     * @param endSecs Fin del intervalo activo (segundos epoch)
+     * @param seconds Duración del intervalo, que termina en @p endSecs
+     */
+    void recordActive(AppHandle handle, qint64 endSecs, qint64 seconds);
+
+    /**
+     * @brief Buckets con uso de una app en [from, to)
+     * @param handle App; los handles sin historial devuelven una lista vacía
+     * @param from Inicio del rango (segundos epoch)
+     * @param to Fin del rango, exclusivo
+     * @param granularity Hour o Day
+     * @return Solo los buckets no vacíos, en orden cronológico; lo anterior
+     *         a la ventana de esa granularidad no está disponible
+     */
+    UsageBucketList query(AppHandle handle, qint64 from, qint64 to, Granularity granularity) const;
+
+    /**
+     * @brief Carga el archivo de historial
+     * @param path Ruta del archivo
+     * @param store Apps conocidas; los registros de apps ausentes se ignoran
+     * @return false si el archivo falta o no es compatible (se reescribirá)
+     */
+    bool load(const QString &path, const AppStore &store);
+
+    /**
+     * @brief Recupera del archivo el historial de una app recién promocionada
+     * @param handle Handle que tiene ahora la app
+     * @return false si el archivo no tiene registro de la app
+     *
+     * Los registros de las apps frías siguen en el archivo; load() solo
+     * los ignora. Ver ColdTier.
+     */
+    bool restore(const QString &path, AppHandle handle, const QString &appId);
+
+    /**
+     * @brief Traduce la tabla a los handles de un AppStore recompactado
+     * @param newHandles Handle antiguo -> nuevo, o AppStore::InvalidHandle si la app salió
+     * @param size Apps del almacén nuevo
+     */
+    void remap(const QVector<AppHandle> &newHandles, int size);
+
+    /**
+     * @brief Escribe los registros de las apps modificadas
+     * @return Bytes escritos, o -1 si hubo un error
+     */
+    qint64 save(const QString &path, const AppStore &store);
+
+    /// Ruta por defecto (~/.local/share/iconwear/usage.history)
+    static QString defaultPath();
+
+private:
+    /// Búfer circular de un ancho de bucket; vacío hasta el primer uso
+    struct Ring {
+        qint64 newest = -1;                 ///< Número del bucket más reciente (tiempo / ancho)
+        QVector<quint32> launches;          ///< Columna de lanzamientos
+        QVector<quint32> activeSeconds;     ///< Columna de segundos activos
+    };
+
+    struct AppHistory {
+        Ring hours;
+        Ring days;
+        int fileSlot = -1;                  ///< Registro en el archivo, -1 si aún no tiene
+        bool dirty = false;                 ///< Pendiente de escribir
+    };
+
+    /// Historial de una app, ampliando la tabla si hace falta
+    AppHistory &app(AppHandle handle);
+
+    /// Copia un registro del archivo (@p columns apunta tras su cabecera)
+    static void readRecord(qint64 hourNewest, qint64 dayNewest, const uchar *columns, int slot, AppHistory &history);
+
+    /// Suma uso al bucket @p bucket, avanzando la ventana si es más reciente
+    static void add(Ring &ring, int size, qint64 bucket, quint32 launches, quint32 seconds);
+
+    /// Reparte @p seconds hacia atrás desde @p endSecs en buckets de @p width
+    static void spread(Ring &ring, int size, qint64 width, qint64 endSecs, qint64 seconds);
+
+    static UsageBucketList queryRing(const Ring &ring, int size, qint64 width, qint64 from, qint64 to);
+
+    /// handle -> historial (las apps sin uso registrado tienen anillos vacíos)
+    QVector<AppHistory> m_apps;
+
+    /// Registros ya asignados en el archivo
+    int m_fileSlots = 0;
+
+    /// El archivo falta o es incompatible: reescribirlo entero al guardar
+    bool m_rewrite = true;
+
+    /// Alguna app tiene uso sin guardar
+    bool m_hasDirty = false;
+};
+
+#endif // USAGEHISTORY_H
@@ -8,31 +8,70 @@
  */
 
 #include "usagetracker.h"
-#include <KActivities/Stats/ResultModel>
-#include <KActivities/Stats/Query>
-#include <KConfigGroup>
-#include <KSharedConfig>
+#include "activitypartitions.h"
+#include "coldtier.h"
+#include "datasetexporter.h"
+#include "snapshot.h"
+#include <QDateTime>
 #include <QDBusConnection>
+#include <QDBusError>
 #include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QDebug>
-#include <QTimer>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <KConfigGroup>
+#include <KSharedConfig>
 
-using namespace KActivities::Stats;
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
 
 //! Inicialización del servicio de rastreo de aplicaciones
-UsageTracker::UsageTracker(QObject *parent) : QObject(parent)
+UsageTracker::UsageTracker(QObject *parent, bool useSnapshot)
+    : QObject(parent)
 {
-    loadConfig();
-    updateStats();
+    registerWearMetricsTypes();
+
+    // El worker carga el estado aquí, antes de arrancar su hilo, para que
+    // el primer estado publicado esté disponible al registrar el servicio
+    m_worker = new TrackerWorker(m_counters, useSnapshot);
+    m_loadedFromSnapshot = m_worker->loadedFromSnapshot();
+    m_state = m_worker->takeState();
+    m_admission.configure(m_worker->admissionConfig());
+
+    m_worker->moveToThread(&m_workerThread);
+    m_workerThread.setObjectName(QStringLiteral("iconwear-worker"));
 
-    // Timer para verificar aplicaciones activas cada 30 segundos
-    m_activityCheckTimer = new QTimer(this);
-    connect(m_activityCheckTimer, &QTimer::timeout, this, &UsageTracker::checkActiveApplications);
-    m_activityCheckTimer->start(30000);  // Cada 30 segundos
+    // El worker, sus timers y el QFileSystemWatcher de AppResolver se
+    // destruyen en su propio hilo, al terminar su event loop
+    connect(&m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
 
-    // Conectar a las señales de ActivityManager para escuchar aperturas de recursos
+    // Las señales del worker se reemiten desde este objeto (el exportado por DBus)
+    connect(m_worker, &TrackerWorker::statePublished, this, &UsageTracker::onStatePublished);
+    connect(m_worker, &TrackerWorker::wearLevelChanged, this, &UsageTracker::wearLevelChanged);
+    connect(m_worker, &TrackerWorker::wearLevelsChanged, this, &UsageTracker::wearLevelsChanged);
+    connect(m_worker, &TrackerWorker::wearLevelReset, this, &UsageTracker::wearLevelReset);
+    connect(m_worker, &TrackerWorker::statsImportProgress, this, &UsageTracker::statsImportProgress);
+    connect(m_worker, &TrackerWorker::statsImportFinished, this, &UsageTracker::statsImportFinished);
+    connect(m_worker, &TrackerWorker::topWornChanged, this, &UsageTracker::topWornChanged);
+    connect(m_worker, &TrackerWorker::activityChanged, this, &UsageTracker::activityChanged);
+
+    m_workerThread.start();
+
+    // Fórmula de desgaste: solo los cambios notificados del grupo WearFormula
+    // (kwriteconfig5 --notify); las escrituras del propio daemon no notifican
+    m_configWatcher = KConfigWatcher::create(KSharedConfig::openConfig(QStringLiteral("iconwearrc")));
+    connect(m_configWatcher.data(), &KConfigWatcher::configChanged, this, [this](const KConfigGroup &group) {
+        if (group.name() == QLatin1String("WearFormula")) {
+            reloadWearFormula();
+        }
+    });
+
+    // Conectar a las señales de ActivityManager para escuchar aperturas,
+    // cierres y cambios de foco de recursos
     QDBusConnection::sessionBus().connect(
         QStringLiteral("org.kde.ActivityManager"),
         QStringLiteral("/Resources"),
@@ -40,196 +79,201 @@ UsageTracker::UsageTracker(QObject *parent) : QObject(parent)
         QStringLiteral("ResourceOpened"),
         this, SLOT(onResourceOpened(QString, QString, QString))
     );
+    QDBusConnection::sessionBus().connect(
+        QStringLiteral("org.kde.ActivityManager"),
+        QStringLiteral("/Resources"),
+        QStringLiteral("org.kde.ActivityManager.Resources"),
+        QStringLiteral("ResourceClosed"),
+        this, SLOT(onResourceClosed(QString, QString, QString))
+    );
+    QDBusConnection::sessionBus().connect(
+        QStringLiteral("org.kde.ActivityManager"),
+        QStringLiteral("/Resources"),
+        QStringLiteral("org.kde.ActivityManager.Resources"),
+        QStringLiteral("ResourceFocused"),
+        this, SLOT(onResourceFocused(QString, QString, QString))
+    );
+
+    // Actividad actual: la señal para los cambios y una consulta asíncrona
+    // para el valor inicial (sin bloquear el arranque si kactivitymanagerd tarda)
+    QDBusConnection::sessionBus().connect(
+        QStringLiteral("org.kde.ActivityManager"),
+        QStringLiteral("/ActivityManager/Activities"),
+        QStringLiteral("org.kde.ActivityManager.Activities"),
+        QStringLiteral("CurrentActivityChanged"),
+        this, SLOT(onCurrentActivityChanged(QString))
+    );
+    const QDBusMessage currentActivity = QDBusMessage::createMethodCall(
+        QStringLiteral("org.kde.ActivityManager"),
+        QStringLiteral("/ActivityManager/Activities"),
+        QStringLiteral("org.kde.ActivityManager.Activities"),
+        QStringLiteral("CurrentActivity"));
+    auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(currentActivity), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *call) {
+        const QDBusPendingReply<QString> reply = *call;
+        if (reply.isValid()) {
+            onCurrentActivityChanged(reply.value());
+        }
+        call->deleteLater();
+    });
 }
 
-//! Maneja el evento de apertura de recurso (lanzamiento de aplicación)
-/*!
- * Slot conectado a la señal ResourceOpened de KActivities::ActivityManager.
- * Se dispara cada vez que el usuario abre/lanza una aplicación.
- * 
- * **Proceso:**
- * 1. Extrae el appId del recurso (elimina ruta de carpeta si existe)
- * 2. Registra la aplicación en la lista de activas con timestamp actual
- * 3. Incrementa el contador de lanzamientos
- * 4. Recalcula el desgaste usando la fórmula ponderada
- * 5. Persiste los cambios a KConfig
- * 
- * @param activity ID de la actividad (no usado actualmente)
- * @param agent Servicio que reportó el evento (ej: "org.kde.plasma.desktop")
- * @param resource Ruta o URI del recurso abierto (ej: "/usr/bin/firefox")
- */
-void UsageTracker::onResourceOpened(const QString &activity, const QString &agent, const QString &resource)
+UsageTracker::~UsageTracker()
 {
-    Q_UNUSED(activity);
-    qDebug() << "Resource opened:" << resource << "by agent:" << agent;
-    
-    // Extraer appId limpio (último componente de la ruta)
-    QString appId = resource;
-    if (resource.contains(QLatin1Char('/'))) {
-        appId = resource.section(QLatin1Char('/'), -1);
+    // Los hilos de exportación no pueden sobrevivir a este objeto: se cancelan
+    // todos a la vez y se esperan antes de parar el worker
+    for (const RunningExport &running : qAsConst(m_exports)) {
+        running.exporter->cancel();
     }
-
-    // Registrar que la aplicación está activa (para tracking de tiempo)
-    if (!m_activeApplications.contains(appId)) {
-        m_activeApplications[appId] = QDateTime::currentDateTime();
+    const QList<QThread *> exportThreads = m_exports.keys();
+    for (QThread *thread : exportThreads) {
+        disconnect(thread, nullptr, this, nullptr);
+        thread->wait();
+        finishExport(thread);
+        delete thread;
     }
 
-    // Inicializar o actualizar registro de la aplicación
-    if (!m_appWearData.contains(appId)) {
-        m_appWearData[appId] = AppWearInfo();
-    }
-    
-    // Incrementar estadísticas
-    m_appWearData[appId].launches++;
-    m_appWearData[appId].lastOpenTime = QDateTime::currentDateTime();
-    
-    // Recalcular desgaste con nueva fórmula ponderada
-    updateWearLevel(appId);
-    saveConfig();
+    QMetaObject::invokeMethod(m_worker, &TrackerWorker::shutdown, Qt::BlockingQueuedConnection);
+    m_workerThread.quit();
+    m_workerThread.wait();  // También espera al deleteLater del worker
+    m_worker = nullptr;
 }
 
-//! Recalcula y actualiza el nivel de desgaste de una aplicación
-/*!
- * **Fórmula de desgaste ponderada (realista y elegante):**
- * ```
- * desgaste = (launches × LAUNCH_WEAR_FACTOR) + (activeMinutes × TIME_WEAR_FACTOR)
- *          = (launches × 1.0) + (activeMinutes × 0.01)
- * ```
- * 
- * **Ejemplos:**
- * - VS Code abierto 50 veces, 0 min activo: desgaste = 50
- * - Firefox abierto 2 veces, 2880 min activos (2 días): desgaste = 2 + 28.8 = 30.8
- * - Editor de texto 100 lanzamientos, 1 min promedio: desgaste ≈ 101
- * 
- * **Normalización:** Se capped a MAX_WEAR_LEVEL (100) para evitar sobrepasarse.
- * 
- * Emite señal wearLevelChanged() para notificar al Plasmoid.
- * 
- * @param appId Identificador de la aplicación a actualizar
- */
-void UsageTracker::updateWearLevel(const QString &appId)
+void UsageTracker::flush()
 {
-    if (!m_appWearData.contains(appId)) {
-        return;
-    }
+    QMetaObject::invokeMethod(m_worker, &TrackerWorker::flush, Qt::BlockingQueuedConnection);
+}
 
-    AppWearInfo &info = m_appWearData[appId];
-    
-    // Calcular componentes de desgaste (ponderado)
-    float wearFromLaunches = info.launches * LAUNCH_WEAR_FACTOR;
-    float wearFromTime = (info.activeTimeSeconds / 60.0f) * TIME_WEAR_FACTOR;  // Convertir segundos a minutos
-    
-    int totalWear = static_cast<int>(wearFromLaunches + wearFromTime);
-    info.wearLevel = qMin(MAX_WEAR_LEVEL, totalWear);
-    
-    qDebug() << "App:" << appId 
-             << "| Launches:" << info.launches 
-             << "| Active mins:" << (info.activeTimeSeconds / 60.0f)
-             << "| Total wear:" << info.wearLevel;
-    
-    Q_EMIT wearLevelChanged(appId, info.wearLevel);
+void UsageTracker::startStatsImport()
+{
+    QMetaObject::invokeMethod(m_worker, &TrackerWorker::startStatsImport, Qt::QueuedConnection);
 }
 
-//! Verifica aplicaciones activas y acumula tiempo de sesión
-void UsageTracker::checkActiveApplications()
+void UsageTracker::openSharedMemory()
 {
-    QDateTime now = QDateTime::currentDateTime();
-    QStringList appsToRemove;
+    QMetaObject::invokeMethod(m_worker, &TrackerWorker::openSharedMemory, Qt::BlockingQueuedConnection);
+}
 
-    for (auto it = m_activeApplications.begin(); it != m_activeApplications.end(); ++it) {
-        QString appId = it.key();
-        QDateTime openTime = it.value();
-        
-        qint64 secondsElapsed = openTime.secsTo(now);
-        
-        // Timeout: si > 5 min sin actividad, se asume que fue cerrada
-        if (secondsElapsed > 300) {
-            appsToRemove.append(appId);
-        } else {
-            // Acumular +30 segundos (el timer ejecuta cada 30 seg)
-            if (m_appWearData.contains(appId)) {
-                m_appWearData[appId].activeTimeSeconds += 30;
-                updateWearLevel(appId);
-            }
-        }
-    }
+//! Filtra, limita y encola el evento con su instante de llegada; el worker hace el resto
+void UsageTracker::enqueueEvent(UsageEvent::Type type, const QString &activity, const QString &agent, const QString &resource)
+{
+    m_counters.eventsReceived.fetch_add(1, std::memory_order_relaxed);
 
-    // Remover aplicaciones inactivas
-    for (const QString &appId : appsToRemove) {
-        m_activeApplications.remove(appId);
-        qDebug() << "App cerrada (inactiva):" << appId;
+    const qint64 now = m_worker->monotonicMs();
+    const AdmissionFilter::Kind kind = type == UsageEvent::Opened ? AdmissionFilter::Open
+                                     : type == UsageEvent::Closed ? AdmissionFilter::Close
+                                                                  : AdmissionFilter::Focus;
+    switch (m_admission.admit(agent, resource, kind, now)) {
+    case AdmissionFilter::Admitted:
+        break;
+    case AdmissionFilter::Filtered:
+        m_counters.eventsFiltered.fetch_add(1, std::memory_order_relaxed);
+        return;
+    case AdmissionFilter::Throttled:
+        m_counters.eventsThrottled.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
 
-    if (!appsToRemove.isEmpty()) {
-        saveConfig();
+    UsageEvent event;
+    event.type = type;
+    event.monotonicMs = now;
+    event.resource = resource;
+    event.activity = activity;
+    if (!m_worker->enqueue(std::move(event))) {
+        qWarning() << "Cola de eventos llena, evento descartado:" << resource;
     }
 }
 
-void UsageTracker::loadConfig()
+//! Maneja el evento de apertura de recurso (lanzamiento de aplicación)
+/*!
+ * Slot conectado a la señal ResourceOpened de KActivities::ActivityManager.
+ * Se dispara cada vez que el usuario abre/lanza una aplicación. Solo
+ * encola: ver TrackerWorker::processOpened().
+ */
+void UsageTracker::onResourceOpened(const QString &activity, const QString &agent, const QString &resource)
 {
-    KConfigGroup config(KSharedConfig::openConfig(QStringLiteral("iconwearrc")), QStringLiteral("Applications"));
-    const QStringList keys = config.keyList();
-    
-    for (const QString &appId : keys) {
-        AppWearInfo info;
-        KConfigGroup appGroup = config.group(appId);
-        info.wearLevel = appGroup.readEntry(QStringLiteral("wearLevel"), 0);
-        info.launches = appGroup.readEntry(QStringLiteral("launches"), 0);
-        info.activeTimeSeconds = appGroup.readEntry(QStringLiteral("activeTimeSeconds"), 0LL);
-        info.reconstructions = appGroup.readEntry(QStringLiteral("reconstructions"), 0);
-        m_appWearData[appId] = info;
+    enqueueEvent(UsageEvent::Opened, activity, agent, resource);
+}
+
+void UsageTracker::onResourceClosed(const QString &activity, const QString &agent, const QString &resource)
+{
+    enqueueEvent(UsageEvent::Closed, activity, agent, resource);
+}
+
+void UsageTracker::onResourceFocused(const QString &activity, const QString &agent, const QString &resource)
+{
+    enqueueEvent(UsageEvent::Focused, activity, agent, resource);
+}
+
+//! Como los resets: se aplica en el worker en orden con los eventos ya encolados
+void UsageTracker::onCurrentActivityChanged(const QString &activity)
+{
+    UsageEvent event;
+    event.type = UsageEvent::ActivityChanged;
+    event.monotonicMs = m_worker->monotonicMs();
+    event.resource = activity;
+    if (!m_worker->enqueue(std::move(event))) {
+        qWarning() << "Cola de eventos llena, cambio de actividad descartado:" << activity;
     }
-    
-    qDebug() << "Configuración cargada para" << keys.size() << "aplicaciones";
 }
 
-void UsageTracker::saveConfig()
+//! Sustituye el estado de lectura e invalida solo lo que cambió
+void UsageTracker::onStatePublished(const WearStatePtr &state)
 {
-    KConfigGroup config(KSharedConfig::openConfig(QStringLiteral("iconwearrc")), QStringLiteral("Applications"));
-    
-    // Limpiar configuración antigua
-    config.deleteGroup();
-    
-    // Guardar datos actuales
-    for (auto it = m_appWearData.begin(); it != m_appWearData.end(); ++it) {
-        const QString &appId = it.key();
-        const AppWearInfo &info = it.value();
-        
-        KConfigGroup appGroup = config.group(appId);
-        appGroup.writeEntry(QStringLiteral("wearLevel"), info.wearLevel);
-        appGroup.writeEntry(QStringLiteral("launches"), info.launches);
-        appGroup.writeEntry(QStringLiteral("activeTimeSeconds"), info.activeTimeSeconds);
-        appGroup.writeEntry(QStringLiteral("reconstructions"), info.reconstructions);
+    m_state = state;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    // Nivel frío recompactado: los handles cacheados ya no son válidos
+    if (state->remapped) {
+        m_metricsJsonCache.clear();
+        m_metricsCacheValid = false;
+        m_coldStore.clear();
+        m_coldStoreLoaded = false;
+        return;
+    }
+
+    for (AppHandle handle : state->changed) {
+        m_metricsJsonCache.remove(handle);
+        if (m_metricsCacheValid) {
+            m_metricsCache.insert(state->store.appId(handle), toWearMetrics(state->store.info(handle), now));
+        }
     }
-    
-    config.sync();
 }
 
 int UsageTracker::getWearLevel(const QString &appId)
 {
-    if (m_appWearData.contains(appId)) {
-        return m_appWearData[appId].wearLevel;
-    }
-    return 0;
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    const AppWearInfo *info = lookup(appId);
+    return info ? currentWearLevel(*info, QDateTime::currentSecsSinceEpoch()) : 0;
 }
 
 QString UsageTracker::getMetrics(const QString &appId)
 {
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    const AppWearInfo *info = lookup(appId);
+    const AppHandle handle = m_state->store.find(appId);
+    const int wearLevel = info ? currentWearLevel(*info, QDateTime::currentSecsSinceEpoch()) : 0;
+
+    // Con semivida el nivel avanza sin eventos: la entrada solo vale si coincide
+    auto cached = m_metricsJsonCache.constFind(handle);
+    if (cached != m_metricsJsonCache.constEnd() && cached->wearLevel == wearLevel) {
+        return cached->json;
+    }
+
     QJsonObject metrics;
     
-    if (m_appWearData.contains(appId)) {
-        const AppWearInfo &info = m_appWearData[appId];
+    if (info) {
         metrics[QStringLiteral("appId")] = appId;
-        metrics[QStringLiteral("wearLevel")] = info.wearLevel;
-        metrics[QStringLiteral("launches")] = info.launches;
-        metrics[QStringLiteral("activeMinutes")] = static_cast<int>(info.activeTimeSeconds / 60);
-        metrics[QStringLiteral("reconstructions")] = info.reconstructions;
+        metrics[QStringLiteral("wearLevel")] = wearLevel;
+        metrics[QStringLiteral("launches")] = info->launches;
+        metrics[QStringLiteral("activeMinutes")] = static_cast<int>(info->activeTimeSeconds / 60);
+        metrics[QStringLiteral("reconstructions")] = info->reconstructions;
         
-        if (info.lastOpenTime.isValid()) {
-            metrics[QStringLiteral("lastOpenTime")] = info.lastOpenTime.toString(Qt::ISODate);
+        if (info->lastOpenTime > 0) {
+            metrics[QStringLiteral("lastOpenTime")] = QDateTime::fromSecsSinceEpoch(info->lastOpenTime).toString(Qt::ISODate);
         }
-        if (info.lastResetTime.isValid()) {
-            metrics[QStringLiteral("lastResetTime")] = info.lastResetTime.toString(Qt::ISODate);
+        if (info->lastResetTime > 0) {
+            metrics[QStringLiteral("lastResetTime")] = QDateTime::fromSecsSinceEpoch(info->lastResetTime).toString(Qt::ISODate);
         }
     } else {
         metrics[QStringLiteral("appId")] = appId;
@@ -240,65 +284,263 @@ QString UsageTracker::getMetrics(const QString &appId)
     }
     
     QJsonDocument doc(metrics);
-    return QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+    const QString json = QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+    
+    // Solo se cachean apps residentes; onStatePublished() invalida la entrada
+    if (handle != AppStore::InvalidHandle) {
+        m_metricsJsonCache.insert(handle, CachedMetricsJson{wearLevel, json});
+    }
+    return json;
 }
 
 void UsageTracker::resetWearLevel(const QString &appId)
 {
-    if (!m_appWearData.contains(appId)) {
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    if (m_state->store.find(appId) == AppStore::InvalidHandle && !m_state->coldApps.contains(appId)) {
         return;
     }
-    
-    AppWearInfo &info = m_appWearData[appId];
-    
-    // Resetear desgaste pero mantener historial
-    info.wearLevel = 0;
-    info.reconstructions++;
-    info.lastResetTime = QDateTime::currentDateTime();
-    
-    qDebug() << "App" << appId << "reseteada. Reconstrucciones:" << info.reconstructions;
-    
-    // Guardar configuración
-    saveConfig();
-    
-    // Emitir señales
-    Q_EMIT wearLevelChanged(appId, 0);
-    Q_EMIT wearLevelReset(appId);
+
+    // Se aplica en el worker (que promociona antes una app fría), en orden con los eventos ya encolados
+    UsageEvent event;
+    event.type = UsageEvent::Reset;
+    event.resource = appId;
+    if (!m_worker->enqueue(std::move(event))) {
+        qWarning() << "Cola de eventos llena, reset descartado:" << appId;
+    }
 }
 
 int UsageTracker::getReconstructions(const QString &appId)
 {
-    if (m_appWearData.contains(appId)) {
-        return m_appWearData[appId].reconstructions;
-    }
-    return 0;
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    const AppWearInfo *info = lookup(appId);
+    return info ? info->reconstructions : 0;
 }
 
-void UsageTracker::updateStats()
+WearLevelMap UsageTracker::getWearLevels(const QStringList &appIds)
 {
-    // Query for frequently used applications
-    Query query;
-    query.setAgents(QStringList{QStringLiteral("plasma-desktop")});
-    query.setOrdering(Terms::HighScoredFirst);
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    WearLevelMap levels;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (const QString &appId : appIds) {
+        const AppWearInfo *info = lookup(appId);
+        levels.insert(appId, info ? currentWearLevel(*info, now) : 0);
+    }
+    return levels;
+}
 
-    ResultSet results(query);
+WearMetricsMap UsageTracker::getMetricsBatch(const QStringList &appIds)
+{
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    WearMetricsMap result;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (const QString &appId : appIds) {
+        const AppWearInfo *info = lookup(appId);
+        result.insert(appId, info ? toWearMetrics(*info, now) : WearMetrics());
+    }
+    return result;
+}
 
-    for (const ResultSet::Result &result : results) {
-        QString resource = result.resource(); // This is often the desktop file path or URL
-        double score = result.score();
-        
-        // Map score to 0-100 wear level
-        // This is a placeholder mapping logic
-        int wearLevel = qMin(100, static_cast<int>(score * 10)); 
-        
-        QString appId = resource;
-        if (resource.contains(QLatin1Char('/'))) {
-            appId = resource.section(QLatin1Char('/'), -1);
+WearMetricsMap UsageTracker::getAllMetrics()
+{
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (!m_metricsCacheValid) {
+        m_metricsCache.clear();
+        for (AppHandle handle = 0; handle < m_state->store.size(); ++handle) {
+            m_metricsCache.insert(m_state->store.appId(handle), toWearMetrics(m_state->store.info(handle), now));
+        }
+        // Las frías se listan sin promocionarlas: este listado no es uso
+        const AppStore &cold = coldStore();
+        for (AppHandle handle = 0; handle < cold.size(); ++handle) {
+            const QString &appId = cold.appId(handle);
+            if (m_state->coldApps.contains(appId) && !m_metricsCache.contains(appId)) {
+                m_metricsCache.insert(appId, toWearMetrics(cold.info(handle), now));
+            }
         }
+        m_metricsCacheValid = true;
+    }
+    if (m_state->halfLifeSeconds <= 0) {
+        return m_metricsCache;
+    }
 
-        if (m_appWearData[appId].wearLevel != wearLevel) {
-            m_appWearData[appId].wearLevel = wearLevel;
-            Q_EMIT wearLevelChanged(appId, wearLevel);
+    // La respuesta ya es O(n); reevaluar cada nivel es O(1) por app
+    for (auto it = m_metricsCache.begin(); it != m_metricsCache.end(); ++it) {
+        AppHandle handle = m_state->store.find(it.key());
+        if (handle != AppStore::InvalidHandle) {
+            it->wearLevel = currentWearLevel(m_state->store.info(handle), now);
+        } else if ((handle = m_coldStore.find(it.key())) != AppStore::InvalidHandle) {
+            it->wearLevel = currentWearLevel(m_coldStore.info(handle), now);
         }
     }
+    return m_metricsCache;
+}
+
+UsageBucketList UsageTracker::getUsageHistory(const QString &appId, qlonglong from, qlonglong to, const QString &granularity)
+{
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    UsageHistory::Granularity resolution;
+    if (granularity == QLatin1String("hour")) {
+        resolution = UsageHistory::Hour;
+    } else if (granularity == QLatin1String("day")) {
+        resolution = UsageHistory::Day;
+    } else {
+        qWarning() << "Granularidad desconocida en getUsageHistory:" << granularity;
+        return UsageBucketList();
+    }
+
+    // Una app fría responde vacío esta vez; la promoción recupera su historial
+    lookup(appId);
+    return m_state->history.query(m_state->store.find(appId), from, to, resolution);
+}
+
+QStringList UsageTracker::getTopWorn(int k)
+{
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    const QVector<AppHandle> &top = m_state->topWorn;
+    const int count = qBound(0, k, top.size());
+
+    QStringList appIds;
+    appIds.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        appIds.append(m_state->store.appId(top.at(i)));
+    }
+    return appIds;
+}
+
+QString UsageTracker::getCurrentActivity()
+{
+    return m_state->activity;
+}
+
+WearMetricsMap UsageTracker::getActivityMetrics(const QString &activity)
+{
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    const QString target = activity.isEmpty() ? m_state->activity : activity;
+
+    // Actividad actual: partición publicada. Otras: su snapshot, sin tocar el worker
+    AppStore stored;
+    const AppStore *store = &m_state->activityStore;
+    if (target != m_state->activity) {
+        ActivityPartitions::loadFromDisk(ActivityPartitions::defaultDirectory(), target, stored);
+        store = &stored;
+    }
+
+    WearMetricsMap metrics;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (AppHandle handle = 0; handle < store->size(); ++handle) {
+        metrics.insert(store->appId(handle), toWearMetrics(store->info(handle), now));
+    }
+    return metrics;
+}
+
+void UsageTracker::reloadWearFormula()
+{
+    QMetaObject::invokeMethod(m_worker, &TrackerWorker::reloadWearFormula, Qt::QueuedConnection);
+}
+
+//! Primero el estado residente; una app fría se lee de su archivo y se pide su promoción
+const AppWearInfo *UsageTracker::lookup(const QString &appId)
+{
+    const AppHandle handle = m_state->store.find(appId);
+    if (handle != AppStore::InvalidHandle) {
+        return &m_state->store.info(handle);
+    }
+    if (!m_state->coldApps.contains(appId)) {
+        return nullptr;
+    }
+
+    UsageEvent event;
+    event.type = UsageEvent::Promote;
+    event.resource = appId;
+    if (!m_worker->enqueue(std::move(event))) {
+        qWarning() << "Cola de eventos llena, promoción descartada:" << appId;
+    }
+
+    const AppStore &cold = coldStore();
+    const AppHandle coldHandle = cold.find(appId);
+    return coldHandle != AppStore::InvalidHandle ? &cold.info(coldHandle) : nullptr;
+}
+
+const AppStore &UsageTracker::coldStore()
+{
+    if (!m_coldStoreLoaded && !m_state->coldApps.isEmpty()) {
+        WearSnapshot::load(ColdTier::defaultPath(), m_coldStore);
+        m_coldStoreLoaded = true;
+    }
+    return m_coldStore;
+}
+
+//! Valida la petición, duplica el descriptor y deja la respuesta al hilo exportador
+int UsageTracker::exportDataset(const QDBusUnixFileDescriptor &fd, const QString &format)
+{
+    ScopedLatency latency(m_counters.dbusSlotLatency);
+    if (!calledFromDBus()) {
+        return -1;
+    }
+
+    DatasetExporter::Format kind;
+    if (!DatasetExporter::formatFromName(format, &kind)) {
+        sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("Unknown export format: %1").arg(format));
+        return -1;
+    }
+    if (!fd.isValid()) {
+        sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("Invalid file descriptor"));
+        return -1;
+    }
+    if (m_exports.size() >= MAX_CONCURRENT_EXPORTS) {
+        sendErrorReply(QDBusError::LimitsExceeded, QStringLiteral("Too many exports in progress"));
+        return -1;
+    }
+
+    // Copia propia: el hilo la cierra al terminar, sin depender del mensaje
+    const int output = ::fcntl(fd.fileDescriptor(), F_DUPFD_CLOEXEC, 0);
+    if (output < 0) {
+        sendErrorReply(QDBusError::Failed, QString::fromLocal8Bit(std::strerror(errno)));
+        return -1;
+    }
+
+    setDelayedReply(true);
+    auto exporter = std::make_shared<DatasetExporter>(m_state, kind, QDateTime::currentSecsSinceEpoch());
+    auto exported = std::make_shared<qint64>(-1);
+
+    // El hilo solo toca el exportador y el resultado, nunca este objeto
+    QThread *thread = QThread::create([exporter, exported, output] {
+        *exported = exporter->run(output);
+    });
+    thread->setObjectName(QStringLiteral("iconwear-export"));
+    connect(thread, &QThread::finished, this, [this, thread] {
+        finishExport(thread);
+        thread->deleteLater();
+    });
+    m_exports.insert(thread, RunningExport{exporter, exported, message()});
+    thread->start(QThread::LowPriority);
+    return 0;
+}
+
+void UsageTracker::finishExport(QThread *thread)
+{
+    const RunningExport running = m_exports.take(thread);
+    if (*running.exported >= 0) {
+        QDBusConnection::sessionBus().send(running.request.createReply(static_cast<int>(*running.exported)));
+    } else {
+        qWarning() << "Exportación interrumpida:" << running.exporter->errorString();
+        QDBusConnection::sessionBus().send(running.request.createErrorReply(QDBusError::Failed,
+                                                                            running.exporter->errorString()));
+    }
+}
+
+int UsageTracker::currentWearLevel(const AppWearInfo &info, qint64 nowSecs) const
+{
+    return m_state->levelAt(info, nowSecs);
+}
+
+WearMetrics UsageTracker::toWearMetrics(const AppWearInfo &info, qint64 nowSecs) const
+{
+    WearMetrics metrics;
+    metrics.wearLevel = currentWearLevel(info, nowSecs);
+    metrics.launches = info.launches;
+    metrics.reconstructions = info.reconstructions;
+    metrics.activeTimeSeconds = info.activeTimeSeconds;
+    metrics.lastOpenTime = info.lastOpenTime;
+    return metrics;
 }
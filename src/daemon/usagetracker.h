@@ -14,32 +14,19 @@
 #define USAGETRACKER_H
 
 #include <QObject>
-#include <QMap>
-#include <QDateTime>
-#include <QTimer>
-#include <KActivities/Stats/ResultSet>
+#include <QDBusContext>
+#include <QDBusMessage>
+#include <QDBusUnixFileDescriptor>
+#include <QHash>
+#include <QThread>
+#include <KConfigWatcher>
+#include "perfcounters.h"
+#include "trackerworker.h"
+#include "wearmetrics.h"
 
-/**
- * @struct AppWearInfo
- * @brief Información de desgaste para una aplicación individual
- * 
- * Estructura que almacena todas las métricas relacionadas con el desgaste
- * de una aplicación. El desgaste total se calcula como:
- * 
- * @code
- * desgaste = (launches * LAUNCH_WEAR_FACTOR) + (activeMinutes * TIME_WEAR_FACTOR)
- * @endcode
- * 
- * @see UsageTracker::updateWearLevel()
- */
-struct AppWearInfo {
-    int wearLevel = 0;              ///< Nivel de desgaste normalizado (0-100)
-    int launches = 0;               ///< Número total de lanzamientos de la app
-    qint64 activeTimeSeconds = 0;   ///< Tiempo total activo en segundos
-    int reconstructions = 0;         ///< Contador de veces que fue reseteada
-    QDateTime lastOpenTime;          ///< Timestamp de la última apertura
-    QDateTime lastResetTime;         ///< Timestamp del último reset
-};
+#include <memory>
+
+class DatasetExporter;
 
 /**
  * @class UsageTracker
@@ -51,24 +38,34 @@ struct AppWearInfo {
  * 
  * **Características principales:**
  * - Monitoreo en tiempo real de lanzamientos de aplicaciones
- * - Seguimiento de tiempo activo de cada aplicación
+ * - Seguimiento exacto del tiempo activo (apertura→cierre, reloj monotónico)
  * - Cálculo de desgaste ponderado (lanzamientos + tiempo activo)
- * - Persistencia de datos en KConfig (~/.config/iconwearrc)
+ * - Persistencia diferida e incremental en KConfig (~/.config/iconwearrc)
  * - Interfaz DBus para consultas remotas desde el Plasmoid
  * - Reset con contador de "reconstrucciones"
+ * - Desgaste por actividad de KDE además del agregado global
+ * 
+ * **Hilos:** este objeto solo sirve DBus. Los eventos se encolan sin
+ * bloqueos hacia un TrackerWorker en su propio hilo, dueño del estado y de
+ * la persistencia; las consultas se responden desde el último WearState
+ * publicado, así que una escritura lenta a disco no retrasa las respuestas.
  * 
  * **Señales DBus:**
  * - `wearLevelChanged(appId, newLevel)` - Emitido cuando cambia el desgaste
+ * - `wearLevelsChanged(levels)` - Cambios agrupados y limitados en frecuencia
  * - `wearLevelReset(appId)` - Emitido cuando se resetea una app
+ * - `topWornChanged(appIds)` - Cambió el ranking de apps más gastadas
+ * - `activityChanged(activity)` - Cambió la actividad actual de KDE
  * 
- * @note El cálculo de desgaste es **ponderado** para ser más realista:
+ * @note El cálculo de desgaste es **ponderado** para ser más realista
+ * (valores por defecto, configurables en [WearFormula]):
  * - +1 punto por cada lanzamiento
  * - +0.01 puntos por cada minuto activo
- * - Máximo 100 puntos (normalizado)
+ * - Curva lineal, máximo 100 puntos (normalizado)
  * 
  * @see AppWearInfo
  */
-class UsageTracker : public QObject
+class UsageTracker : public QObject, protected QDBusContext
 {
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "org.kde.iconwear.Tracker")
@@ -77,11 +74,75 @@ public:
     /**
      * @brief Constructor del rastreador de uso
      * @param parent Objeto padre de Qt (por defecto nullptr)
+     * @param useSnapshot Cargar/escribir el snapshot binario (ver snapshot.h);
+     *        con false se usa solo KConfig
      * 
      * Inicializa el servicio cargando datos guardados, configurando
      * conexiones DBus y activando el timer de monitoreo de aplicaciones.
      */
-    explicit UsageTracker(QObject *parent = nullptr);
+    explicit UsageTracker(QObject *parent = nullptr, bool useSnapshot = true);
+
+    /**
+     * @brief Destructor: persiste los cambios pendientes antes de salir
+     *
+     * Cancela las exportaciones en curso y espera a sus hilos antes de
+     * parar el worker.
+     */
+    ~UsageTracker() override;
+
+    /**
+     * @brief Escribe inmediatamente todos los cambios pendientes
+     *
+     * Espera a que el worker aplique la cola de eventos y guarde a disco.
+     * Se invoca al cerrar la aplicación (SIGTERM, fin de sesión) para
+     * garantizar que no se pierdan datos.
+     */
+    void flush();
+
+    /**
+     * @brief Arranca la importación incremental de KActivities Stats
+     * 
+     * Lanza un StatsImporter en un hilo de baja prioridad que lee solo los
+     * resultados más recientes que la marca de agua persistida
+     * (General/statsWatermark). Debe llamarse después de registrar el
+     * servicio DBus para no retrasar su disponibilidad al iniciar sesión.
+     * 
+     * El progreso se publica con statsImportProgress() y
+     * statsImportFinished().
+     */
+    void startStatsImport();
+
+    /**
+     * @brief Crea el segmento de memoria compartida y publica el estado
+     *
+     * Solo el daemon lo llama, una vez registrado el servicio DBus: un
+     * UsageTracker de un benchmark o de una prueba (o un segundo daemon que
+     * no consiguió el nombre) no debe reemplazar el segmento
+     * `/iconwear-<uid>` de la sesión. Bloquea hasta que el worker lo abre.
+     */
+    void openSharedMemory();
+
+    /**
+     * @brief Indica si el estado inicial se cargó del snapshot binario
+     * @return false si se usó KConfig (snapshot ausente, corrupto o desactivado)
+     */
+    bool loadedFromSnapshot() const { return m_loadedFromSnapshot; }
+
+    /// Contadores de rendimiento (expuestos por StatsAdaptor)
+    PerfCounters &counters() { return m_counters; }
+    const PerfCounters &counters() const { return m_counters; }
+
+    /// Número de aplicaciones rastreadas (según el último estado publicado)
+    int trackedAppCount() const { return m_state->store.size(); }
+
+    /// Número de aplicaciones en el nivel frío (fuera de memoria)
+    int coldAppCount() const { return m_state->coldApps.size(); }
+
+    /// Número de aplicaciones con sesión abierta (según el último estado publicado)
+    int activeAppCount() const { return m_state->activeApps; }
+
+    /// Eventos encolados que el worker aún no aplicó
+    int queuedEventCount() const { return m_worker->queuedEvents(); }
 
 public Q_SLOTS:
     /**
@@ -121,7 +182,8 @@ public Q_SLOTS:
      * Pone el desgaste a 0 pero mantiene un histórico de reconstrucciones.
      * Emite señal wearLevelReset() para activar animación en el Plasmoid.
      * 
-     * Persiste automáticamente los cambios en KConfig.
+     * El reset se encola al worker como un evento más y se aplica en
+     * orden con el resto; se persiste en la siguiente escritura diferida.
      * 
      * @see getReconstructions()
      */
@@ -136,6 +198,119 @@ public Q_SLOTS:
      */
     int getReconstructions(const QString &appId);
 
+    /**
+     * @brief Obtiene el nivel de desgaste de varias aplicaciones a la vez
+     * @param appIds Lista de identificadores a consultar
+     * @return Mapa appId -> desgaste (`a{si}`); las apps sin registro valen 0
+     * 
+     * Versión en lote de getWearLevel(): un panel con N iconos refresca
+     * todos sus niveles en un único viaje por el bus de sesión.
+     */
+    WearLevelMap getWearLevels(const QStringList &appIds);
+
+    /**
+     * @brief Obtiene las métricas tipadas de varias aplicaciones a la vez
+     * @param appIds Lista de identificadores a consultar
+     * @return Mapa appId -> WearMetrics (`a{s(iiixx)}`)
+     * 
+     * Equivalente a llamar getMetrics() por cada app pero sin JSON y en
+     * una sola llamada. Las apps sin registro devuelven métricas a cero.
+     */
+    WearMetricsMap getMetricsBatch(const QStringList &appIds);
+
+    /**
+     * @brief Obtiene las métricas de todas las aplicaciones rastreadas
+     * @return Mapa appId -> WearMetrics (`a{s(iiixx)}`)
+     * 
+     * La respuesta se mantiene en caché y solo se actualiza la entrada
+     * de una app cuando cambia su AppWearInfo.
+     */
+    WearMetricsMap getAllMetrics();
+
+    /**
+     * @brief Uso de una aplicación por horas o días
+     * @param appId Identificador de la aplicación
+     * @param from Inicio del rango (segundos epoch)
+     * @param to Fin del rango, exclusivo (segundos epoch)
+     * @param granularity "hour" (última semana) o "day" (último año)
+     * @return Buckets no vacíos del rango (`a(xii)`), en orden cronológico
+     * 
+     * Responde desde los búferes circulares de la app: el coste depende
+     * del rango pedido, no del historial acumulado. Los buckets van
+     * alineados a horas/días UTC.
+     * 
+     * @code
+     * # Uso diario de Krita en la última semana
+     * qdbus org.kde.iconwear /Tracker getUsageHistory org.kde.krita.desktop \
+     *     $(( $(date +%s) - 7*86400 )) $(date +%s) day
+     * @endcode
+     */
+    UsageBucketList getUsageHistory(const QString &appId, qlonglong from, qlonglong to, const QString &granularity);
+
+    /**
+     * @brief Las aplicaciones más gastadas, de mayor a menor
+     * @param k Número de apps; se limita a General/topWornSize (20 por defecto)
+     * @return appIds ordenados (`as`); las apps sin desgaste no aparecen
+     * 
+     * El daemon mantiene un índice ordenado que se actualiza en O(log N)
+     * con cada cambio de desgaste, así que la respuesta cuesta O(k) sin
+     * recorrer todas las apps. Con semivida el orden es el de los valores
+     * decaídos (ver WearDecay::rankKey()).
+     * 
+     * @see topWornChanged()
+     */
+    QStringList getTopWorn(int k);
+
+    /**
+     * @brief Actividad de KDE actual según el daemon
+     * @return Id de la actividad, o cadena vacía si aún no se conoce
+     */
+    QString getCurrentActivity();
+
+    /**
+     * @brief Métricas de todas las apps dentro de una actividad
+     * @param activity Id de la actividad; vacío = la actual
+     * @return Mapa appId -> métricas (`a{s(iiixx)}`) solo con el uso en esa actividad
+     * 
+     * La actividad actual se sirve desde el estado publicado. Las demás se
+     * leen de su snapshot en disco sin cargarlas en el worker, así que
+     * pueden ir por detrás hasta un intervalo de guardado. El agregado de
+     * todas las actividades sigue siendo getAllMetrics().
+     * 
+     * @see activityChanged()
+     */
+    WearMetricsMap getActivityMetrics(const QString &activity);
+
+    /**
+     * @brief Vuelve a leer la fórmula de desgaste de iconwearrc
+     * 
+     * Los cambios hechos con `kwriteconfig5 --notify` se aplican solos;
+     * este método sirve tras editar el archivo a mano. Si la fórmula
+     * cambió, el worker recalcula todos los niveles en una pasada y emite
+     * una única wearLevelsChanged() con las apps afectadas.
+     */
+    void reloadWearFormula();
+
+    /**
+     * @brief Vuelca todas las apps y su historial en un descriptor de archivo
+     * @param fd Extremo de escritura (tubería, socket o archivo) pasado por el bus
+     * @param format "json" (una línea JSON por app) o "binary" (ver datasetexporter.h)
+     * @return Apps exportadas, cuando el volcado termina
+     *
+     * La respuesta DBus es diferida: la exportación corre en un hilo propio
+     * sobre el último estado publicado y escribe app a app, sin construir
+     * la respuesta en memoria; el resto de slots sigue respondiendo. El
+     * descriptor se cierra al terminar, así que el lector ve fin de archivo
+     * antes de recibir la respuesta. Si el lector cierra antes, responde con
+     * error.
+     *
+     * @code
+     * # Exportar a un archivo desde Python (dbus-python)
+     * tracker.exportDataset(dbus.types.UnixFd(open("wear.ndjson", "w")), "json", timeout=600)
+     * @endcode
+     */
+    int exportDataset(const QDBusUnixFileDescriptor &fd, const QString &format);
+
 private Q_SLOTS:
     /**
      * @brief Maneja el evento de apertura de recurso (aplicación)
@@ -144,23 +319,48 @@ private Q_SLOTS:
      * @param resource Recurso abierto (ruta o URI de la aplicación)
      * 
      * Slot privado conectado a la señal ResourceOpened de ActivityManager.
-     * Incrementa el contador de lanzamientos y actualiza el desgaste.
+     * Solo encola el evento; el worker cuenta el lanzamiento y actualiza
+     * el desgaste.
      * 
-     * @note El parámetro `activity` no se usa actualmente pero se mantiene
-     *       por compatibilidad con la interfaz de ActivityManager.
+     * @note El lanzamiento cuenta en el agregado global y en la partición
+     *       de `activity` (o de la actividad actual si viene vacía).
      */
     void onResourceOpened(const QString &activity, const QString &agent, const QString &resource);
-    
+
     /**
-     * @brief Verifica aplicaciones activas y actualiza tiempo de sesión
+     * @brief Maneja el evento de cierre de recurso
      * 
-     * Slot privado conectado a un timer que se ejecuta cada 30 segundos.
-     * Detecta aplicaciones que se cerraron (sin actividad en 5 minutos)
-     * y acumula tiempo activo para las que siguen en ejecución.
+     * Slot privado conectado a la señal ResourceClosed de ActivityManager.
+     * Al cerrarse el último recurso de la app, el worker suma la duración
+     * exacta apertura→cierre (reloj monotónico) a su tiempo activo.
+     */
+    void onResourceClosed(const QString &activity, const QString &agent, const QString &resource);
+
+    /**
+     * @brief Maneja el evento de foco de un recurso
+     * 
+     * Si la app ya está rastreada pero no tiene sesión abierta (p. ej. se
+     * abrió antes de arrancar el daemon), el worker abre una sesión sin
+     * contar un lanzamiento.
+     */
+    void onResourceFocused(const QString &activity, const QString &agent, const QString &resource);
+
+    /**
+     * @brief Cambio de actividad de KDE (señal CurrentActivityChanged)
+     * @param activity Id de la nueva actividad actual
      * 
-     * Automáticamente persiste cambios cuando detecta inactividad.
+     * Solo encola: el worker carga la partición en su hilo y publica un
+     * estado nuevo, así que las consultas no esperan al disco.
      */
-    void checkActiveApplications();
+    void onCurrentActivityChanged(const QString &activity);
+
+    /**
+     * @brief Adopta un estado publicado por el worker
+     * @param state Nuevo estado consistente
+     * 
+     * Invalida solo las respuestas cacheadas de las apps que cambiaron.
+     */
+    void onStatePublished(const WearStatePtr &state);
 
 Q_SIGNALS:
     /**
@@ -169,9 +369,21 @@ Q_SIGNALS:
      * @param newLevel Nuevo nivel de desgaste (0-100)
      * 
      * Usada por el Plasmoid para actualizar visualización en tiempo real.
-     * Se emite cada vez que se calcula desgaste después de un evento.
+     * Solo se emite cuando el nivel entero cambia realmente.
+     * Se mantiene por compatibilidad; los clientes nuevos deberían
+     * escuchar wearLevelsChanged().
      */
     void wearLevelChanged(const QString &appId, int newLevel);
+
+    /**
+     * @brief Señal en lote con los niveles que cambiaron (`a{si}`)
+     * @param levels Mapa appId -> nuevo nivel, solo apps cuyo nivel cambió
+     * 
+     * Agrupa todos los cambios ocurridos dentro del intervalo de
+     * notificación (General/notifyIntervalMs), de modo que los
+     * oyentes del bus despiertan como mucho una vez por intervalo.
+     */
+    void wearLevelsChanged(const WearLevelMap &levels);
     
     /**
      * @brief Señal emitida cuando se resetea el desgaste de una app
@@ -184,74 +396,126 @@ Q_SIGNALS:
      */
     void wearLevelReset(const QString &appId);
 
-private:
     /**
-     * @brief Recalcula el nivel de desgaste de una aplicación
-     * @param appId Identificador de la aplicación
-     * 
-     * Calcula el desgaste usando la fórmula ponderada:
-     * `desgaste = (launches * LAUNCH_WEAR_FACTOR) + (activeMinutes * TIME_WEAR_FACTOR)`
-     * 
-     * Normaliza a 0-100 y emite señal wearLevelChanged().
-     * No persiste automáticamente (ver saveConfig()).
-     * 
-     * @see LAUNCH_WEAR_FACTOR, TIME_WEAR_FACTOR, MAX_WEAR_LEVEL
+     * @brief Progreso de la importación de KActivities Stats
+     * @param imported Resultados fusionados hasta ahora
      */
-    void updateWearLevel(const QString &appId);
-    
+    void statsImportProgress(int imported);
+
     /**
-     * @brief Actualiza estadísticas desde KActivitiesStats
-     * 
-     * Lee datos históricos de KActivities para inicializar o refrescar
-     * métricas. Se ejecuta al iniciar el daemon.
-     * 
-     * @note Actualmente es un placeholder para integración futura.
+     * @brief Fin de la importación de KActivities Stats
+     * @param imported Total de resultados nuevos fusionados
      */
-    void updateStats();
-    
+    void statsImportFinished(int imported);
+
     /**
-     * @brief Carga configuración guardada desde KConfig
-     * 
-     * Lee ~/.config/iconwearrc y restaura el estado de todas las
-     * aplicaciones (desgaste, lanzamientos, tiempo activo, etc.).
-     * Se ejecuta en el constructor.
+     * @brief Cambió qué apps forman el ranking de más gastadas
+     * @param appIds Ranking completo (General/topWornSize apps), de mayor a menor
      * 
-     * @see saveConfig()
+     * Solo se emite cuando entra o sale alguna app, no por reordenaciones
+     * internas; un lanzador puede mantenerse al día sin sondear.
      */
-    void loadConfig();
-    
+    void topWornChanged(const QStringList &appIds);
+
     /**
-     * @brief Persiste el estado actual a KConfig
+     * @brief Cambió la actividad actual y su partición ya está publicada
+     * @param activity Id de la nueva actividad
      * 
-     * Escribe todos los datos en ~/.config/iconwearrc/Applications
-     * para que sobrevivan reinicio de sesión.
-     * Se llama automáticamente después de cambios.
+     * Al recibirla, getActivityMetrics("") ya responde con la actividad nueva.
+     */
+    void activityChanged(const QString &activity);
+
+private:
+    /// Los microbenchmarks (bench/trackerbench.cpp) miden los caminos privados
+    friend class TrackerBench;
+
+    /// Responde a la llamada de una exportación terminada y la quita de m_exports
+    void finishExport(QThread *thread);
+
+    /// Pasa un evento de ActivityManager por m_admission y lo encola hacia el worker
+    void enqueueEvent(UsageEvent::Type type, const QString &activity, const QString &agent, const QString &resource);
+
+    /**
+     * @brief Nivel de desgaste actual de una app
      * 
-     * @see loadConfig()
+     * Sin semivida es el nivel guardado; con semivida se evalúa en O(1)
+     * a partir de wearScore/wearStamp con la fórmula publicada (ver
+     * weardecay.h y wearformula.h).
+     */
+    int currentWearLevel(const AppWearInfo &info, qint64 nowSecs) const;
+
+    /**
+     * @brief Métricas de una app, residente o fría
+     * @return nullptr si la app no se conoce
+     *
+     * Consultar una app fría la promociona: se encola UsageEvent::Promote y
+     * esta vez se responde con su registro del nivel frío.
+     */
+    const AppWearInfo *lookup(const QString &appId);
+
+    /// Registros del nivel frío, leídos del archivo la primera vez que se piden
+    const AppStore &coldStore();
+
+    /**
+     * @brief Convierte un AppWearInfo al formato DBus compacto
      */
-    void saveConfig();
+    WearMetrics toWearMetrics(const AppWearInfo &info, qint64 nowSecs) const;
+
+    /// Respuesta de getMetrics() cacheada y el nivel con el que se generó
+    struct CachedMetricsJson {
+        int wearLevel;
+        QString json;
+    };
     
-    // ============= Configuración de Factores de Desgaste =============
+    // ============= Miembros Privados =============
     
-    /// Desgaste agregado por cada lanzamiento de aplicación
-    static constexpr float LAUNCH_WEAR_FACTOR = 1.0f;
+    /// Contadores de rendimiento, siempre activos (compartidos con el worker)
+    PerfCounters m_counters;
     
-    /// Desgaste agregado por cada minuto de tiempo activo (más lento que lanzamientos)
-    static constexpr float TIME_WEAR_FACTOR = 0.01f;
+    /// Dueño del estado y la persistencia; vive en m_workerThread
+    TrackerWorker *m_worker;
     
-    /// Nivel máximo de desgaste (normalización superior)
-    static constexpr int MAX_WEAR_LEVEL = 100;
+    /// Hilo de ingesta y persistencia
+    QThread m_workerThread;
+
+    /// Prefiltro y límite de tasa aplicados antes de encolar
+    AdmissionFilter m_admission;
+
+    /// Avisa de cambios notificados en iconwearrc (grupo WearFormula)
+    KConfigWatcher::Ptr m_configWatcher;
     
-    // ============= Miembros Privados =============
+    /// Último estado publicado; todas las consultas DBus leen de aquí
+    WearStatePtr m_state;
     
-    /// Mapa principal: appId -> AppWearInfo con todas las métricas
-    QMap<QString, AppWearInfo> m_appWearData;
+    /// Caché de respuestas JSON de getMetrics() por handle
+    QHash<AppHandle, CachedMetricsJson> m_metricsJsonCache;
     
-    /// Mapa de aplicaciones actualmente en ejecución y su tiempo de apertura
-    QMap<QString, QDateTime> m_activeApplications;
+    /// Caché de getAllMetrics(); se actualiza entrada a entrada al publicar.
+    /// Con semivida los niveles se reevalúan al responder
+    WearMetricsMap m_metricsCache;
+    
+    /// Indica si m_metricsCache refleja todas las apps de m_state
+    bool m_metricsCacheValid = false;
+
+    /// Copia de solo lectura del nivel frío; se descarta en cada recompactación
+    AppStore m_coldStore;
+    bool m_coldStoreLoaded = false;
     
-    /// Timer que ejecuta checkActiveApplications() cada 30 segundos
-    QTimer *m_activityCheckTimer;
+    /// El estado inicial se cargó del snapshot (no de KConfig)
+    bool m_loadedFromSnapshot = false;
+
+    /// Exportación en curso en su propio hilo
+    struct RunningExport {
+        std::shared_ptr<DatasetExporter> exporter;
+        std::shared_ptr<qint64> exported;   ///< Apps exportadas, o -1 si falló
+        QDBusMessage request;               ///< Llamada pendiente de respuesta
+    };
+
+    /// Exportaciones en curso por hilo; el destructor las cancela y las espera
+    QHash<QThread *, RunningExport> m_exports;
+
+    /// Exportaciones simultáneas admitidas; las demás se rechazan
+    static constexpr int MAX_CONCURRENT_EXPORTS = 2;
 };
 
 #endif // USAGETRACKER_H
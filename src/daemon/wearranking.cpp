@@ -0,0 +1,55 @@
+/**
+ * @file wearranking.cpp
+ * @brief Implementación del índice ordenado de desgaste
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "wearranking.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr double NOT_INDEXED = -std::numeric_limits<double>::infinity();
+
+} // namespace
+
+bool WearRanking::update(AppHandle handle, double key)
+{
+    if (handle >= m_keyOf.size()) {
+        const int oldSize = m_keyOf.size();
+        m_keyOf.resize(handle + 1);
+        std::fill(m_keyOf.begin() + oldSize, m_keyOf.end(), NOT_INDEXED);
+    }
+
+    const double previous = m_keyOf.at(handle);
+    if (previous == key) {
+        return false;
+    }
+
+    if (previous != NOT_INDEXED) {
+        m_index.erase(Entry{previous, handle});
+    }
+    if (key != NOT_INDEXED) {
+        m_index.insert(Entry{key, handle});
+    }
+    m_keyOf[handle] = key;
+    return true;
+}
+
+QVector<AppHandle> WearRanking::top(int k) const
+{
+    QVector<AppHandle> result;
+    result.reserve(qMin(k, size()));
+    for (auto it = m_index.cbegin(); it != m_index.cend() && result.size() < k; ++it) {
+        result.append(it->handle);
+    }
+    return result;
+}
+
+void WearRanking::clear()
+{
+    m_index.clear();
+    m_keyOf.clear();
+}
@@ -0,0 +1,65 @@
+/**
+ * @file wearranking.h
+ * @brief Índice ordenado de apps por desgaste, mantenido incrementalmente
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ */
+
+#ifndef WEARRANKING_H
+#define WEARRANKING_H
+
+#include <QVector>
+
+#include <set>
+
+#include "appstore.h"
+
+/**
+ * @class WearRanking
+ * @brief Árbol ordenado (clave de desgaste, handle) con actualización O(log N)
+ * 
+ * La clave la calcula quien llama (ver WearDecay::rankKey()); este índice
+ * solo mantiene el orden. Las apps sin desgaste no se indexan.
+ * 
+ * @code
+ * ranking.update(handle, WearDecay::rankKey(info.wearScore, info.wearStamp, halfLife));
+ * const QVector<AppHandle> top = ranking.top(10);
+ * @endcode
+ */
+class WearRanking
+{
+public:
+    /**
+     * @brief Recoloca una app en el índice (O(log N))
+     * @param key Clave de orden; -infinito la saca del índice
+     * @return true si la clave cambió
+     */
+    bool update(AppHandle handle, double key);
+
+    /// Las @p k apps de mayor clave, de mayor a menor (O(k))
+    QVector<AppHandle> top(int k) const;
+
+    /// Apps indexadas
+    int size() const { return static_cast<int>(m_index.size()); }
+
+    void clear();
+
+private:
+    struct Entry {
+        double key;
+        AppHandle handle;
+
+        /// Mayor clave primero; a igual clave, el handle más antiguo
+        bool operator<(const Entry &other) const
+        {
+            return key != other.key ? key > other.key : handle < other.handle;
+        }
+    };
+
+    std::set<Entry> m_index;
+
+    /// handle -> clave con la que está indexado (-infinito si no lo está)
+    QVector<double> m_keyOf;
+};
+
+#endif // WEARRANKING_H
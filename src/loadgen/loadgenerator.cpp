@@ -0,0 +1,404 @@
+/**
+ * @file loadgenerator.cpp
+ * @brief Implementación del generador de carga
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "loadgenerator.h"
+#include <QCoreApplication>
+#include <QDBusConnectionInterface>
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <QDebug>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcessEnvironment>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+
+namespace {
+
+const QString BUS_NAME = QStringLiteral("iconwear-loadgen");
+
+//! Espera a que @p condition sea cierta procesando eventos, hasta @p timeoutMs
+template<typename Condition>
+bool waitFor(Condition condition, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        QThread::msleep(1);
+    }
+    return true;
+}
+
+//! Mismo appId que resuelve el daemon para las rutas .desktop que genera la carga
+QString expectedAppId(const QString &resource)
+{
+    return resource.section(QLatin1Char('/'), -1);
+}
+
+double percentile(QVector<double> sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    const int index = qBound(0, static_cast<int>(std::ceil(p * sorted.size())) - 1, sorted.size() - 1);
+    return sorted.at(index);
+}
+
+} // namespace
+
+LoadGenerator::LoadGenerator(const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_bus(BUS_NAME)
+    , m_rng(42)
+{
+}
+
+LoadGenerator::~LoadGenerator()
+{
+    stop();
+}
+
+int LoadGenerator::run()
+{
+    if (!loadTrace()) {
+        return 1;
+    }
+    if (!startBus()) {
+        qCritical() << "No se pudo arrancar dbus-daemon privado";
+        return 1;
+    }
+    if (!startDaemon()) {
+        qCritical() << "iconwear-daemon no registró org.kde.iconwear en el bus privado";
+        stop();
+        return 1;
+    }
+
+    double saturationRate = 0;
+    for (double rate : qAsConst(m_options.rates)) {
+        const StepResult result = runStep(rate);
+        printStep(result);
+        if (result.saturated) {
+            saturationRate = rate;
+            break;
+        }
+    }
+
+    QJsonObject summary;
+    summary[QStringLiteral("summary")] = true;
+    summary[QStringLiteral("saturationRate")] = saturationRate;  // 0 = no se alcanzó
+    std::printf("%s\n", QJsonDocument(summary).toJson(QJsonDocument::Compact).constData());
+
+    printCounters();
+    stop();
+    return 0;
+}
+
+bool LoadGenerator::loadTrace()
+{
+    if (m_options.tracePath.isEmpty()) {
+        // Distribución sintética: precalcular la CDF de Zipf (s = 1)
+        if (m_options.zipf) {
+            m_zipfCdf.resize(m_options.apps);
+            double sum = 0;
+            for (int i = 0; i < m_options.apps; ++i) {
+                sum += 1.0 / (i + 1);
+                m_zipfCdf[i] = sum;
+            }
+            for (double &value : m_zipfCdf) {
+                value /= sum;
+            }
+        }
+        return true;
+    }
+
+    // Formato: "<offset_ms> <agent> <resource>" por línea, '#' para comentarios
+    QFile file(m_options.tracePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCritical() << "No se pudo abrir la traza" << m_options.tracePath;
+        return false;
+    }
+
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+        const QStringList fields = line.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        if (fields.size() < 3) {
+            continue;
+        }
+        TraceEvent event;
+        event.offsetMs = fields.at(0).toLongLong();
+        event.agent = fields.at(1);
+        event.resource = fields.mid(2).join(QLatin1Char(' '));
+        m_trace.append(event);
+    }
+
+    if (m_trace.isEmpty()) {
+        qCritical() << "La traza no contiene eventos:" << m_options.tracePath;
+        return false;
+    }
+    return true;
+}
+
+bool LoadGenerator::startBus()
+{
+    m_busProcess.start(QStringLiteral("dbus-daemon"),
+                       {QStringLiteral("--session"), QStringLiteral("--nofork"), QStringLiteral("--print-address=1")});
+    if (!m_busProcess.waitForStarted(5000)) {
+        return false;
+    }
+    if (!waitFor([this] { return m_busProcess.canReadLine(); }, 5000)) {
+        return false;
+    }
+    m_busAddress = QString::fromUtf8(m_busProcess.readLine()).trimmed();
+
+    m_bus = QDBusConnection::connectToBus(m_busAddress, BUS_NAME);
+    if (!m_bus.isConnected()) {
+        return false;
+    }
+
+    m_activityManager = new FakeActivityManager(this);
+    return m_bus.registerService(QStringLiteral("org.kde.ActivityManager"))
+        && m_bus.registerObject(QStringLiteral("/Resources"), m_activityManager, QDBusConnection::ExportAllSignals);
+}
+
+bool LoadGenerator::startDaemon()
+{
+    // Configuración, datos y memoria compartida aislados: nunca se toca el estado real
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("DBUS_SESSION_BUS_ADDRESS"), m_busAddress);
+    env.insert(QStringLiteral("XDG_CONFIG_HOME"), m_homeDir.path() + QStringLiteral("/config"));
+    env.insert(QStringLiteral("XDG_DATA_HOME"), m_homeDir.path() + QStringLiteral("/data"));
+    env.insert(QStringLiteral("QT_LOGGING_RULES"), QStringLiteral("*.debug=false"));
+    env.insert(QStringLiteral("ICONWEAR_SHM_NAME"), QStringLiteral("/iconwear-loadgen-%1").arg(QCoreApplication::applicationPid()));
+    m_daemonProcess.setProcessEnvironment(env);
+
+    // Sin límite de admisión ni agrupación de aperturas: se mide la
+    // capacidad del camino de ingesta, no la política que la protege
+    const QString configDir = m_homeDir.path() + QStringLiteral("/config");
+    QDir().mkpath(configDir);
+    QFile config(configDir + QStringLiteral("/iconwearrc"));
+    if (config.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        config.write("[General]\nadmissionRate=0\nlaunchCoalesceMs=0\n");
+        config.close();
+    }
+
+    m_daemonProcess.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    m_daemonProcess.start(m_options.daemonPath, QStringList());
+    if (!m_daemonProcess.waitForStarted(5000)) {
+        return false;
+    }
+
+    const bool registered = waitFor([this] {
+        return m_bus.interface()->isServiceRegistered(QStringLiteral("org.kde.iconwear")).value();
+    }, 10000);
+    if (!registered) {
+        return false;
+    }
+
+    return m_bus.connect(QStringLiteral("org.kde.iconwear"), QStringLiteral("/Tracker"),
+                         QStringLiteral("org.kde.iconwear.Tracker"), QStringLiteral("wearLevelChanged"),
+                         this, SLOT(onWearLevelChanged(QString, int)));
+}
+
+TraceEvent LoadGenerator::nextEvent()
+{
+    if (!m_trace.isEmpty()) {
+        const TraceEvent event = m_trace.at(m_traceIndex);
+        m_traceIndex = (m_traceIndex + 1) % m_trace.size();
+        return event;
+    }
+
+    int app = 0;
+    if (m_options.zipf) {
+        const double u = m_rng.generateDouble();
+        app = static_cast<int>(std::lower_bound(m_zipfCdf.constBegin(), m_zipfCdf.constEnd(), u) - m_zipfCdf.constBegin());
+    } else {
+        app = static_cast<int>(m_rng.bounded(m_options.apps));
+    }
+
+    TraceEvent event;
+    event.agent = QStringLiteral("org.kde.plasmashell");
+    event.resource = QStringLiteral("/usr/share/applications/loadgen.app%1.desktop").arg(app);
+    return event;
+}
+
+void LoadGenerator::emitEvent(const TraceEvent &event)
+{
+    const QString appId = expectedAppId(event.resource);
+    if (!m_outstanding.contains(appId)) {
+        m_outstanding.insert(appId, m_clock.nsecsElapsed());
+    }
+    Q_EMIT m_activityManager->ResourceOpened(QString(), event.agent, event.resource);
+}
+
+void LoadGenerator::onWearLevelChanged(const QString &appId, int newLevel)
+{
+    Q_UNUSED(newLevel);
+    ++m_signalsReceived;
+
+    auto it = m_outstanding.find(appId);
+    if (it != m_outstanding.end()) {
+        m_latenciesMs.append((m_clock.nsecsElapsed() - it.value()) / 1e6);
+        m_outstanding.erase(it);
+    }
+}
+
+StepResult LoadGenerator::runStep(double rate)
+{
+    StepResult result;
+    result.targetRate = rate;
+    m_outstanding.clear();
+    m_latenciesMs.clear();
+    m_signalsReceived = 0;
+
+    const qint64 cpuBefore = daemonCpuTicks();
+    m_clock.start();
+    const qint64 durationMs = m_options.stepSeconds * 1000LL;
+    const bool replayOffsets = rate <= 0 && !m_trace.isEmpty();
+    const qint64 traceBase = replayOffsets ? m_trace.at(m_traceIndex).offsetMs : 0;
+
+    // Emisión pacing: en cada vuelta se emiten los eventos que ya "tocaban"
+    while (m_clock.elapsed() < durationMs) {
+        if (replayOffsets) {
+            while (m_trace.at(m_traceIndex).offsetMs - traceBase <= m_clock.elapsed()) {
+                emitEvent(nextEvent());
+                ++result.sent;
+                if (m_traceIndex == 0) {
+                    break;  // Fin de la traza
+                }
+            }
+            if (m_traceIndex == 0 && result.sent > 0) {
+                break;
+            }
+        } else {
+            const qint64 due = static_cast<qint64>(rate * m_clock.nsecsElapsed() / 1e9);
+            while (result.sent < due) {
+                emitEvent(nextEvent());
+                ++result.sent;
+            }
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    }
+    const double emitSeconds = m_clock.nsecsElapsed() / 1e9;
+
+    // Drenaje: dar tiempo a que lleguen las señales pendientes
+    waitFor([this] { return m_outstanding.isEmpty(); }, 2000);
+
+    const double stepSeconds = m_clock.nsecsElapsed() / 1e9;
+    const qint64 cpuAfter = daemonCpuTicks();
+
+    std::sort(m_latenciesMs.begin(), m_latenciesMs.end());
+    result.achievedRate = emitSeconds > 0 ? result.sent / emitSeconds : 0;
+    result.signalsReceived = m_signalsReceived;
+    result.p50Ms = percentile(m_latenciesMs, 0.50);
+    result.p95Ms = percentile(m_latenciesMs, 0.95);
+    result.p99Ms = percentile(m_latenciesMs, 0.99);
+    result.maxMs = m_latenciesMs.isEmpty() ? 0 : m_latenciesMs.last();
+    result.cpuPercent = stepSeconds > 0
+        ? 100.0 * (cpuAfter - cpuBefore) / sysconf(_SC_CLK_TCK) / stepSeconds
+        : 0;
+    result.rssBytes = daemonRssBytes();
+
+    // Saturado: latencia de cola por encima del umbral o eventos sin respuesta tras el drenaje
+    result.saturated = result.p99Ms > m_options.maxLatencyMs
+        || m_outstanding.size() > m_latenciesMs.size() / 10;
+    return result;
+}
+
+qint64 LoadGenerator::daemonCpuTicks() const
+{
+    QFile stat(QStringLiteral("/proc/%1/stat").arg(m_daemonProcess.processId()));
+    if (!stat.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    // Los campos 14 y 15 (utime, stime) siguen al nombre entre paréntesis
+    const QByteArray content = stat.readAll();
+    const QList<QByteArray> fields = content.mid(content.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 13) {
+        return 0;
+    }
+    return fields.at(11).toLongLong() + fields.at(12).toLongLong();
+}
+
+qint64 LoadGenerator::daemonRssBytes() const
+{
+    QFile statm(QStringLiteral("/proc/%1/statm").arg(m_daemonProcess.processId()));
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+}
+
+void LoadGenerator::printStep(const StepResult &result) const
+{
+    QJsonObject step;
+    step[QStringLiteral("targetRate")] = result.targetRate;
+    step[QStringLiteral("achievedRate")] = result.achievedRate;
+    step[QStringLiteral("sent")] = result.sent;
+    step[QStringLiteral("signals")] = result.signalsReceived;
+    step[QStringLiteral("p50Ms")] = result.p50Ms;
+    step[QStringLiteral("p95Ms")] = result.p95Ms;
+    step[QStringLiteral("p99Ms")] = result.p99Ms;
+    step[QStringLiteral("maxMs")] = result.maxMs;
+    step[QStringLiteral("cpuPercent")] = result.cpuPercent;
+    step[QStringLiteral("rssBytes")] = result.rssBytes;
+    step[QStringLiteral("saturated")] = result.saturated;
+    std::printf("%s\n", QJsonDocument(step).toJson(QJsonDocument::Compact).constData());
+    std::fflush(stdout);
+}
+
+void LoadGenerator::printCounters()
+{
+    // Contadores internos del daemon (org.kde.iconwear.Stats), si están disponibles
+    QDBusInterface stats(QStringLiteral("org.kde.iconwear"), QStringLiteral("/Tracker"),
+                         QStringLiteral("org.kde.iconwear.Stats"), m_bus);
+    const QDBusReply<QVariantMap> reply = stats.call(QStringLiteral("getCounters"));
+    if (!reply.isValid()) {
+        return;
+    }
+
+    QJsonObject counters = QJsonObject::fromVariantMap(reply.value());
+    counters[QStringLiteral("daemonCounters")] = true;
+    std::printf("%s\n", QJsonDocument(counters).toJson(QJsonDocument::Compact).constData());
+    std::fflush(stdout);
+}
+
+void LoadGenerator::stop()
+{
+    if (m_daemonProcess.state() != QProcess::NotRunning) {
+        m_daemonProcess.terminate();  // SIGTERM: el daemon hace flush y sale
+        if (!m_daemonProcess.waitForFinished(5000)) {
+            m_daemonProcess.kill();
+            m_daemonProcess.waitForFinished();
+        }
+    }
+    if (m_bus.isConnected()) {
+        QDBusConnection::disconnectFromBus(BUS_NAME);
+    }
+    if (m_busProcess.state() != QProcess::NotRunning) {
+        m_busProcess.terminate();
+        m_busProcess.waitForFinished(2000);
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * @file loadgenerator.h
+ * @brief Generador de carga y reproductor de eventos para iconwear-daemon
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Reproduce tormentas de eventos (indexadores, scripts que abren miles de
+ * recursos) sin escritorio real: levanta un dbus-daemon privado, publica
+ * en él un org.kde.ActivityManager falso y arranca el daemon contra ese bus.
+ * Mide la latencia evento → wearLevelChanged, el uso de CPU y la memoria
+ * residente del daemon, y el punto de saturación.
+ */
+
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QDBusConnection>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVector>
+
+/**
+ * @class FakeActivityManager
+ * @brief Sustituto de org.kde.ActivityManager en /Resources
+ * 
+ * Solo emite las señales que escucha UsageTracker. Al registrarse con
+ * ExportAllSignals, cada emisión Qt se convierte en una señal DBus.
+ */
+class FakeActivityManager : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.ActivityManager.Resources")
+
+public:
+    using QObject::QObject;
+
+Q_SIGNALS:
+    void ResourceOpened(const QString &activity, const QString &agent, const QString &resource);
+    void ResourceClosed(const QString &activity, const QString &agent, const QString &resource);
+};
+
+/**
+ * @struct TraceEvent
+ * @brief Evento a emitir (de una traza grabada o sintético)
+ */
+struct TraceEvent {
+    qint64 offsetMs = 0;            ///< Instante relativo en la traza (ms)
+    QString agent;                  ///< Agente que reporta el evento
+    QString resource;               ///< Recurso abierto
+};
+
+/**
+ * @struct StepResult
+ * @brief Resultado de un escalón de carga a tasa fija
+ */
+struct StepResult {
+    double targetRate = 0;          ///< Eventos/s pedidos
+    double achievedRate = 0;        ///< Eventos/s realmente emitidos
+    int sent = 0;                   ///< Eventos emitidos
+    int signalsReceived = 0;        ///< wearLevelChanged recibidos
+    double p50Ms = 0;               ///< Percentiles de latencia evento → señal
+    double p95Ms = 0;
+    double p99Ms = 0;
+    double maxMs = 0;
+    double cpuPercent = 0;          ///< CPU del daemon durante el escalón
+    qint64 rssBytes = 0;            ///< Memoria residente del daemon al final
+    bool saturated = false;         ///< El daemon no siguió el ritmo
+};
+
+/**
+ * @class LoadGenerator
+ * @brief Orquesta bus privado, daemon, emisión de eventos y mediciones
+ */
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Opciones de la ejecución (ver main.cpp para la línea de comandos)
+    struct Options {
+        QString daemonPath;                 ///< Ejecutable iconwear-daemon
+        QString tracePath;                  ///< Traza grabada (vacío = sintético)
+        QVector<double> rates;              ///< Escalones de tasa (eventos/s)
+        int stepSeconds = 5;                ///< Duración de cada escalón
+        int apps = 50000;                   ///< Apps distintas en modo sintético
+        bool zipf = false;                  ///< Distribución Zipf en lugar de uniforme
+        double maxLatencyMs = 100.0;        ///< p99 a partir del cual se considera saturado
+    };
+
+    explicit LoadGenerator(const Options &options, QObject *parent = nullptr);
+    ~LoadGenerator() override;
+
+    /**
+     * @brief Ejecuta todos los escalones e imprime los resultados
+     * @return 0 si todo fue bien, distinto de 0 si falló el arranque
+     */
+    int run();
+
+private Q_SLOTS:
+    /// Recibe wearLevelChanged del daemon en el bus privado
+    void onWearLevelChanged(const QString &appId, int newLevel);
+
+private:
+    bool startBus();
+    bool startDaemon();
+    bool loadTrace();
+    StepResult runStep(double rate);
+    TraceEvent nextEvent();
+    void emitEvent(const TraceEvent &event);
+    qint64 daemonCpuTicks() const;
+    qint64 daemonRssBytes() const;
+    void printStep(const StepResult &result) const;
+    void printCounters();
+    void stop();
+
+    Options m_options;
+    QProcess m_busProcess;
+    QProcess m_daemonProcess;
+    QTemporaryDir m_homeDir;                ///< XDG_CONFIG/DATA_HOME aislados
+    QString m_busAddress;
+    QDBusConnection m_bus;
+    FakeActivityManager *m_activityManager = nullptr;
+
+    QVector<TraceEvent> m_trace;
+    int m_traceIndex = 0;
+    QRandomGenerator m_rng;
+    QVector<double> m_zipfCdf;
+
+    QElapsedTimer m_clock;
+    QHash<QString, qint64> m_outstanding;   ///< appId -> envío más antiguo sin respuesta
+    QVector<double> m_latenciesMs;
+    int m_signalsReceived = 0;
+};
+
+#endif // LOADGENERATOR_H
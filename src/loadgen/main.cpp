@@ -0,0 +1,97 @@
+/**
+ * @file main.cpp
+ * @brief Punto de entrada de iconwear-loadgen
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * **Uso:**
+ * ```bash
+ * # Rampa sintética uniforme sobre 50k apps, 5 s por escalón
+ * ./iconwear-loadgen --daemon ./iconwear-daemon --rates 100,500,1000,5000,10000
+ * 
+ * # Distribución Zipf (pocas apps calientes, cola larga)
+ * ./iconwear-loadgen --daemon ./iconwear-daemon --zipf --apps 20000 --rates 1000,2000,4000
+ * 
+ * # Reproducir una traza grabada con sus tiempos originales (tasa 0)
+ * ./iconwear-loadgen --daemon ./iconwear-daemon --trace storm.trace --rates 0
+ * ```
+ * 
+ * Formato de traza: una línea `<offset_ms> <agent> <resource>` por evento,
+ * líneas que empiezan por `#` se ignoran.
+ * 
+ * Cada escalón imprime una línea JSON con tasa pedida/lograda, percentiles
+ * de latencia evento → wearLevelChanged, CPU y RSS del daemon. La ejecución
+ * se detiene en el primer escalón saturado; la línea final `summary` indica
+ * la tasa de saturación (0 si no se alcanzó).
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QStandardPaths>
+
+#include "loadgenerator.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("iconwear-loadgen"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Generador de carga para iconwear-daemon"));
+    parser.addHelpOption();
+
+    QCommandLineOption daemonOption(QStringLiteral("daemon"),
+                                    QStringLiteral("Ejecutable iconwear-daemon a medir."),
+                                    QStringLiteral("path"));
+    QCommandLineOption traceOption(QStringLiteral("trace"),
+                                   QStringLiteral("Traza grabada a reproducir (por defecto, carga sintética)."),
+                                   QStringLiteral("file"));
+    QCommandLineOption ratesOption(QStringLiteral("rates"),
+                                   QStringLiteral("Escalones de eventos/s separados por comas (0 = tiempos de la traza)."),
+                                   QStringLiteral("list"), QStringLiteral("100,500,1000,2000,5000,10000,20000"));
+    QCommandLineOption stepOption(QStringLiteral("step-seconds"),
+                                  QStringLiteral("Duración de cada escalón."),
+                                  QStringLiteral("seconds"), QStringLiteral("5"));
+    QCommandLineOption appsOption(QStringLiteral("apps"),
+                                  QStringLiteral("Número de apps distintas en modo sintético."),
+                                  QStringLiteral("count"), QStringLiteral("50000"));
+    QCommandLineOption zipfOption(QStringLiteral("zipf"),
+                                  QStringLiteral("Usar distribución Zipf en lugar de uniforme."));
+    QCommandLineOption latencyOption(QStringLiteral("max-latency-ms"),
+                                     QStringLiteral("p99 a partir del cual el escalón se considera saturado."),
+                                     QStringLiteral("ms"), QStringLiteral("100"));
+    parser.addOptions({daemonOption, traceOption, ratesOption, stepOption, appsOption, zipfOption, latencyOption});
+    parser.process(app);
+
+    LoadGenerator::Options options;
+    options.daemonPath = parser.isSet(daemonOption)
+        ? parser.value(daemonOption)
+        : QStandardPaths::findExecutable(QStringLiteral("iconwear-daemon"));
+    options.tracePath = parser.value(traceOption);
+    options.stepSeconds = qMax(1, parser.value(stepOption).toInt());
+    options.apps = qMax(1, parser.value(appsOption).toInt());
+    options.zipf = parser.isSet(zipfOption);
+    options.maxLatencyMs = parser.value(latencyOption).toDouble();
+
+    const QStringList rates = parser.value(ratesOption).split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &rate : rates) {
+        options.rates.append(rate.trimmed().toDouble());
+    }
+
+    if (options.daemonPath.isEmpty()) {
+        qCritical() << "No se encontró iconwear-daemon; use --daemon";
+        return 1;
+    }
+    if (options.rates.isEmpty()) {
+        qCritical() << "--rates no contiene ningún escalón";
+        return 1;
+    }
+    if (options.rates.contains(0) && options.tracePath.isEmpty()) {
+        qCritical() << "La tasa 0 (tiempos originales) requiere --trace";
+        return 1;
+    }
+
+    LoadGenerator generator(options);
+    return generator.run();
+}
@@ -0,0 +1,53 @@
+/**
+ * @file WearBackend.qml
+ * @brief Métricas de una app desde WearModel (plugin org.kde.iconwear)
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ *
+ * main.qml lo carga con un Loader para no depender del plugin al cargar
+ * el widget: sin él no hay datos del daemon, pero el icono y el slider
+ * siguen funcionando.
+ */
+
+import QtQuick
+import org.kde.iconwear
+
+Item {
+    id: backend
+    property string appId                 ///< App cuyas métricas se exponen
+
+    readonly property int wearLevel: metricsRow.object ? metricsRow.object.wearLevel : 0
+    readonly property int launches: metricsRow.object ? metricsRow.object.launches : 0
+    readonly property int activeMinutes: metricsRow.object ? metricsRow.object.activeMinutes : 0
+    readonly property int reconstructions: metricsRow.object ? metricsRow.object.reconstructions : 0
+
+    /// Reenvía WearModel.wearLevelReset (también los resets de otros clientes)
+    signal wearLevelReset(string appId)
+
+    function resetWearLevel(appId) {
+        wearModel.resetWearLevel(appId)
+    }
+
+    /**
+     * @brief Métricas de appId, empujadas por el daemon
+     * 
+     * Todas las instancias del plasmoid comparten una única conexión DBus
+     * (IconWearClient en el plugin); no hay sondeo.
+     */
+    WearModel {
+        id: wearModel
+        appIds: [backend.appId]
+        onWearLevelReset: appId => backend.wearLevelReset(appId)
+    }
+
+    /// Expone la única fila del modelo como objeto con propiedades
+    Instantiator {
+        id: metricsRow
+        model: wearModel
+        delegate: QtObject {
+            required property int wearLevel
+            required property int launches
+            required property int activeMinutes
+            required property int reconstructions
+        }
+    }
+}
@@ -0,0 +1,32 @@
+/**
+ * @file WearIconBatchView.qml
+ * @brief Un icono con desgaste sobre WearIconBatch (plugin org.kde.iconwear)
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ *
+ * WearShader.qml lo carga con un Loader: si el plugin no está instalado
+ * (o no se puede cargar) falla solo este archivo y WearShader usa su
+ * camino QML puro.
+ */
+
+import QtQuick
+import org.kde.iconwear
+
+Item {
+    id: root
+    property string icon                  ///< Nombre del icono del tema o ruta
+    property real wearLevel: 0.0          ///< Desgaste 0.0-1.0
+
+    function playResetAnimation() {
+        batch.playResetAnimation(0)
+    }
+
+    WearIconBatch {
+        id: batch
+        anchors.centerIn: parent
+        width: iconSize
+        height: iconSize
+        iconSize: Math.max(1, Math.min(root.width, root.height))
+        icons: [root.icon]
+        wearLevels: [root.wearLevel * 100]
+    }
+}
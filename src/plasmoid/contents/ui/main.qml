@@ -10,7 +10,10 @@
  * - Tooltip con estadísticas en tiempo real
  * - Slider interactivo para testing
  * 
- * Se comunica con el daemon UsageTracker via DBus para obtener/actualizar datos.
+ * Recibe los datos del daemon UsageTracker a través de WearModel (plugin
+ * org.kde.iconwear), que se actualiza por señales DBus. El plugin se carga
+ * con un Loader (WearBackend.qml): si falta, el widget carga igual, sin
+ * datos del daemon.
  */
 
 import QtQuick
@@ -44,22 +47,40 @@ PlasmoidItem {
     property int activeMinutes: 0                        ///< Minutos activos acumulados
     property bool showMetrics: false                     ///< Mostrar tooltip con stats
 
-    // DBus connection to the daemon
-    // Note: In Plasma 6, use proper DBus interface via Qt.createQmlObject or C++ plugin
-    // For now we use a Timer to simulate polling
+    /// Métricas de appId (WearBackend.qml sobre el plugin org.kde.iconwear)
+    Loader {
+        id: backend
+        source: "WearBackend.qml"
+        onStatusChanged: {
+            if (status === Loader.Error) {
+                console.warn("org.kde.iconwear no disponible; sin métricas del daemon")
+            }
+        }
+    }
 
-    // For simplicity in this MVP, we'll use a Timer to poll or just hardcode for now
-    // In a real app, we'd use a proper DBus interface in QML
-    Timer {
-        interval: 5000
-        running: true
-        repeat: true
-        onTriggered: {
-            // Mocking DBus call for now
-            // wearLevel = ...
+    Binding {
+        target: backend.item
+        property: "appId"
+        value: root.appId
+        when: backend.status === Loader.Ready
+    }
+
+    Connections {
+        target: backend.item
+        function onWearLevelReset(appId) {
+            if (appId === root.appId) {
+                wearShaderComponent.playResetAnimation()
+            }
         }
     }
 
+    readonly property bool hasBackend: backend.status === Loader.Ready   ///< El plugin cargó
+
+    Binding on wearLevel { value: backend.item.wearLevel; when: root.hasBackend }
+    Binding on launches { value: backend.item.launches; when: root.hasBackend }
+    Binding on activeMinutes { value: backend.item.activeMinutes; when: root.hasBackend }
+    Binding on reconstructions { value: backend.item.reconstructions; when: root.hasBackend }
+
     /**
      * @brief Menú contextual (clic derecho)
      * 
@@ -88,25 +109,22 @@ PlasmoidItem {
     /**
      * @brief Anima reset visual y llama al daemon
      * 
-     * Proceso:
-     * 1. Ejecuta animación de spark/glitch en shader
-     * 2. Pone wearLevel a 0
-     * 3. Incrementa contador de reconstrucciones
-     * 4. Llamaría a daemon.resetWearLevel(appId) en versión final
+     * Solo pide el reset al daemon. La animación se dispara con la señal
+     * wearLevelReset de WearModel (también cuando el reset llega de otro
+     * cliente), y el nuevo wearLevel y el contador de reconstrucciones
+     * llegan por la misma vía. Sin plugin el reset es solo local.
      * 
      * @see WearShader.playResetAnimation()
      * @see UsageTracker.resetWearLevel()
      */
     function resetWearAnimation() {
-        // Disparar animación de spark inverso en el shader
-        wearShaderComponent.playResetAnimation()
-        
-        // Resetear visualmente
-        wearLevel = 0
-        reconstructions += 1
-        
-        console.log("Icono restaurado. Restauraciones:", reconstructions)
-        // TODO: Llamar a daemon.resetWearLevel(appId) via DBus
+        if (hasBackend) {
+            backend.item.resetWearLevel(root.appId)
+        } else {
+            wearShaderComponent.playResetAnimation()
+            wearLevel = 0
+            reconstructions += 1
+        }
     }
 
     /**
@@ -119,8 +137,7 @@ PlasmoidItem {
          * @brief Contenedor del icono con efecto visual
          * 
          * Estructura:
-         * - IconItem: Icono base KDE (oculto)
-         * - WearShader: Efecto GLSL de desgaste en tiempo real
+         * - WearShader: Icono KDE con el desgaste en tiempo real
          * - MouseArea: Maneja clic derecho y hover
          */
         Item {
@@ -129,29 +146,19 @@ PlasmoidItem {
             Layout.preferredHeight: 64
             Layout.alignment: Qt.AlignCenter
 
-            // Icono base de KDE (renderizado por el shader)
-            Kirigami.Icon {
-                id: iconItem
-                anchors.fill: parent
-                source: "system-file-manager"
-                visible: true
-                layer.enabled: true  // Necesario para ShaderEffectSource
-            }
-
             /**
-             * @brief Aplica efecto visual de desgaste (shader GLSL)
+             * @brief Icono con el desgaste visual (WearIconBatch o su camino QML)
              * 
              * Propiedades:
-             * - source: Icono base a procesar
+             * - icon: Icono base de KDE
              * - wearLevel: 0.0-1.0 (normalizado)
-             * - resetProgress: Animación de reset en progreso
              * 
-             * @see WearShader.qml para fórmulas de shader
+             * @see WearShader.qml y weariconbatch.h para las fórmulas
              */
             WearShader {
                 id: wearShaderComponent
                 anchors.fill: parent
-                source: iconItem
+                icon: "system-file-manager"
                 wearLevel: root.wearLevel / 100.0
             }
 
@@ -0,0 +1,221 @@
+/**
+ * @file iconbatchbench.cpp
+ * @brief Tiempo de frame de WearIconBatch con muchos iconos
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ *
+ * Abre una ventana con una rejilla de N iconos sintéticos, cambia el
+ * desgaste de todos en cada frame (y lanza destellos de reset) y mide el
+ * tiempo de pared por frame y el de renderizado (beforeRendering →
+ * afterRendering). Funciona sin GPU ni pantalla, así que sirve en CI:
+ *
+ * **Uso:**
+ * ```bash
+ * ./iconwear-iconbench                                   # 16, 256 y 1024 iconos
+ * ./iconwear-iconbench --frames 600 4096                 # tamaños personalizados
+ * QT_QPA_PLATFORM=offscreen ./iconwear-iconbench --software   # backend software, sin X
+ * xvfb-run -a ./iconwear-iconbench                       # OpenGL sobre llvmpipe
+ * ```
+ *
+ * Cada resultado es una línea JSON en stdout:
+ * `{"benchmark":"frame","backend":"opengl","icons":1024,"frames":300,"firstFrameMs":...,"msPerFrame":...,"renderMs":...}`
+ */
+
+#include "weariconbatch.h"
+
+#include <QColor>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QImage>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+#include <QSurfaceFormat>
+#include <QTemporaryDir>
+#include <QtMath>
+
+#include <atomic>
+#include <cstdio>
+
+namespace {
+
+/// Iconos distintos en disco; la rejilla los repite
+constexpr int DISTINCT_ICONS = 16;
+
+/// Lado de cada icono en píxeles lógicos
+constexpr int ICON_SIZE = 32;
+
+/// Frames sin medir antes de empezar (atlas, shaders, primera subida)
+constexpr int WARMUP_FRAMES = 5;
+
+//! Escribe DISTINCT_ICONS PNG de colores distintos y devuelve sus rutas
+QStringList writeIcons(const QTemporaryDir &dir)
+{
+    QStringList paths;
+    for (int i = 0; i < DISTINCT_ICONS; ++i) {
+        QImage image(64, 64, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setBrush(QColor::fromHsv(i * 360 / DISTINCT_ICONS, 200, 230));
+        painter.setPen(QPen(Qt::black, 3));
+        painter.drawRoundedRect(QRectF(4, 4, 56, 56), 12, 12);
+        painter.end();
+
+        const QString path = dir.filePath(QStringLiteral("icon-%1.png").arg(i));
+        image.save(path);
+        paths.append(path);
+    }
+    return paths;
+}
+
+QString backendName(QQuickWindow &window)
+{
+    switch (window.rendererInterface()->graphicsApi()) {
+    case QSGRendererInterface::Software:
+        return QStringLiteral("software");
+    case QSGRendererInterface::OpenGL:
+        return QStringLiteral("opengl");
+    case QSGRendererInterface::Vulkan:
+        return QStringLiteral("vulkan");
+    default:
+        return QStringLiteral("other");
+    }
+}
+
+/**
+ * @brief Mide @p frames frames de una rejilla de @p icons iconos
+ *
+ * Cada frame cambia todos los niveles (el peor caso: todos los vértices y
+ * parte de los overlays cambian) y cada 30 frames lanza un destello.
+ */
+void benchFrames(const QStringList &paths, int icons, int frames)
+{
+    const int columns = qCeil(qSqrt(icons));
+    const int rows = (icons + columns - 1) / columns;
+
+    QQuickWindow window;
+    window.resize(columns * (ICON_SIZE + 4), rows * (ICON_SIZE + 4));
+
+    QStringList names;
+    names.reserve(icons);
+    for (int i = 0; i < icons; ++i) {
+        names.append(paths.at(i % paths.size()));
+    }
+
+    auto *batch = new WearIconBatch(window.contentItem());
+    batch->setIconSize(ICON_SIZE);
+    batch->setColumns(columns);
+    batch->setSize(QSizeF(window.width(), window.height()));
+    batch->setIcons(names);
+
+    // beforeRendering/afterRendering llegan en el hilo de render
+    QElapsedTimer clock;
+    clock.start();
+    std::atomic<qint64> renderStart(0);
+    std::atomic<qint64> renderNs(0);
+    QObject::connect(&window, &QQuickWindow::beforeRendering, &window, [&] {
+        renderStart = clock.nsecsElapsed();
+    }, Qt::DirectConnection);
+    QObject::connect(&window, &QQuickWindow::afterRendering, &window, [&] {
+        renderNs += clock.nsecsElapsed() - renderStart;
+    }, Qt::DirectConnection);
+
+    // En cola: despierta el bucle de eventos del hilo principal
+    int swapped = 0;
+    QObject::connect(&window, &QQuickWindow::frameSwapped, &window, [&] {
+        ++swapped;
+    }, Qt::QueuedConnection);
+
+    auto renderFrame = [&](int frame) {
+        QVariantList levels;
+        levels.reserve(icons);
+        for (int i = 0; i < icons; ++i) {
+            levels.append((i * 7 + frame) % 101);
+        }
+        batch->setWearLevels(levels);
+        if (frame % 30 == 0) {
+            batch->playResetAnimation(frame % icons);
+        }
+        const int target = swapped + 1;
+        while (swapped < target) {
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        }
+    };
+
+    qint64 start = clock.nsecsElapsed();
+    window.show();
+    renderFrame(0);
+    const qint64 firstFrameNs = clock.nsecsElapsed() - start;
+    for (int frame = 1; frame < WARMUP_FRAMES; ++frame) {
+        renderFrame(frame);
+    }
+
+    renderNs = 0;
+    start = clock.nsecsElapsed();
+    for (int frame = 0; frame < frames; ++frame) {
+        renderFrame(WARMUP_FRAMES + frame);
+    }
+    const qint64 wallNs = clock.nsecsElapsed() - start;
+
+    QJsonObject result;
+    result[QStringLiteral("benchmark")] = QStringLiteral("frame");
+    result[QStringLiteral("backend")] = backendName(window);
+    result[QStringLiteral("icons")] = icons;
+    result[QStringLiteral("frames")] = frames;
+    result[QStringLiteral("firstFrameMs")] = firstFrameNs / 1e6;
+    result[QStringLiteral("msPerFrame")] = wallNs / 1e6 / frames;
+    result[QStringLiteral("renderMs")] = renderNs / 1e6 / frames;
+    std::printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Sin vsync: el tiempo de frame es el del trabajo, no el del monitor
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setSwapInterval(0);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    QStringList args;
+    for (int i = 1; i < argc; ++i) {
+        args.append(QString::fromLocal8Bit(argv[i]));
+    }
+    if (args.removeAll(QStringLiteral("--software")) > 0) {
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    }
+
+    QGuiApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("iconwear-iconbench"));
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+
+    int frames = 300;
+    const int framesArg = args.indexOf(QStringLiteral("--frames"));
+    if (framesArg >= 0 && framesArg + 1 < args.size()) {
+        frames = qMax(1, args.at(framesArg + 1).toInt());
+        args.erase(args.begin() + framesArg, args.begin() + framesArg + 2);
+    }
+
+    QVector<int> sizes;
+    for (const QString &arg : qAsConst(args)) {
+        bool ok = false;
+        const int size = arg.toInt(&ok);
+        if (ok && size > 0) {
+            sizes.append(qMin(size, int(WearIconBatch::MAX_ICONS)));
+        }
+    }
+    if (sizes.isEmpty()) {
+        sizes = {16, 256, 1024};
+    }
+
+    QTemporaryDir dir;
+    const QStringList paths = writeIcons(dir);
+    for (int icons : sizes) {
+        benchFrames(paths, icons, frames);
+    }
+    return 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file iconwearclient.cpp
+ * @brief Implementación del cliente compartido de org.kde.iconwear
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "iconwearclient.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+#include <QPointer>
+
+namespace {
+
+const QString SERVICE = QStringLiteral("org.kde.iconwear");
+const QString PATH = QStringLiteral("/Tracker");
+const QString INTERFACE = QStringLiteral("org.kde.iconwear.Tracker");
+
+} // namespace
+
+IconWearClient *IconWearClient::instance()
+{
+    static QPointer<IconWearClient> s_instance;
+    if (!s_instance) {
+        s_instance = new IconWearClient(QCoreApplication::instance());
+    }
+    return s_instance;
+}
+
+IconWearClient::IconWearClient(QObject *parent)
+    : QObject(parent)
+{
+    registerWearMetricsTypes();
+    QDBusConnection bus = QDBusConnection::sessionBus();
+
+    // Suscripciones únicas para todo el proceso; el bus las mantiene aunque
+    // el daemon se reinicie
+    bus.connect(SERVICE, PATH, INTERFACE, QStringLiteral("wearLevelsChanged"),
+                this, SLOT(onWearLevelsChanged(WearLevelMap)));
+    bus.connect(SERVICE, PATH, INTERFACE, QStringLiteral("wearLevelReset"),
+                this, SLOT(onWearLevelReset(QString)));
+
+    m_serviceWatcher = new QDBusServiceWatcher(SERVICE, bus,
+                                               QDBusServiceWatcher::WatchForRegistration
+                                                   | QDBusServiceWatcher::WatchForUnregistration,
+                                               this);
+    connect(m_serviceWatcher, &QDBusServiceWatcher::serviceRegistered, this, &IconWearClient::onServiceRegistered);
+    connect(m_serviceWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &IconWearClient::onServiceUnregistered);
+
+    m_available = bus.interface() && bus.interface()->isServiceRegistered(SERVICE).value();
+}
+
+void IconWearClient::watch(const QStringList &appIds)
+{
+    QStringList missing;
+    for (const QString &appId : appIds) {
+        if (!m_watched.contains(appId)) {
+            m_watched.insert(appId);
+            if (!m_metrics.contains(appId)) {
+                missing.append(appId);
+            }
+        }
+    }
+    if (!missing.isEmpty()) {
+        refresh(missing);
+    }
+}
+
+void IconWearClient::watchAll()
+{
+    if (m_watchAll) {
+        return;
+    }
+    m_watchAll = true;
+    if (m_available) {
+        callMetrics(QStringLiteral("getAllMetrics"), QStringList());
+    }
+}
+
+void IconWearClient::resetWearLevel(const QString &appId)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(SERVICE, PATH, INTERFACE, QStringLiteral("resetWearLevel"));
+    message << appId;
+    QDBusConnection::sessionBus().asyncCall(message);
+}
+
+void IconWearClient::refresh(const QStringList &appIds)
+{
+    QStringList fromShm;
+    QStringList missing;
+
+    for (const QString &appId : appIds) {
+        WearShm::WearShmEntry entry;
+        if (m_shm.read(appId, &entry)) {
+            WearMetrics &metrics = m_metrics[appId];
+            metrics.wearLevel = entry.wearLevel;
+            metrics.launches = entry.launches;
+            metrics.reconstructions = entry.reconstructions;
+            metrics.activeTimeSeconds = entry.activeTimeSeconds;
+            metrics.lastOpenTime = entry.lastOpenTime;
+            fromShm.append(appId);
+        } else {
+            missing.append(appId);
+        }
+    }
+
+    if (!fromShm.isEmpty()) {
+        Q_EMIT metricsChanged(fromShm);
+    }
+    if (!missing.isEmpty() && m_available) {
+        callMetrics(QStringLiteral("getMetricsBatch"), missing);
+    }
+}
+
+void IconWearClient::callMetrics(const QString &method, const QStringList &appIds)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(SERVICE, PATH, INTERFACE, method);
+    if (!appIds.isEmpty()) {
+        message << appIds;
+    }
+
+    auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &IconWearClient::onMetricsReply);
+}
+
+void IconWearClient::onMetricsReply(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+    const QDBusPendingReply<WearMetricsMap> reply = *watcher;
+    if (reply.isError()) {
+        return;
+    }
+
+    const WearMetricsMap result = reply.value();
+    QStringList changed;
+    changed.reserve(result.size());
+    for (auto it = result.constBegin(); it != result.constEnd(); ++it) {
+        m_metrics.insert(it.key(), it.value());
+        changed.append(it.key());
+    }
+    if (!changed.isEmpty()) {
+        Q_EMIT metricsChanged(changed);
+    }
+}
+
+//! Un lote del daemon: nivel inmediato y resto de métricas por memoria compartida
+void IconWearClient::onWearLevelsChanged(const WearLevelMap &levels)
+{
+    QStringList affected;
+    affected.reserve(levels.size());
+    for (auto it = levels.constBegin(); it != levels.constEnd(); ++it) {
+        if (!m_watchAll && !m_watched.contains(it.key())) {
+            continue;
+        }
+        m_metrics[it.key()].wearLevel = it.value();
+        affected.append(it.key());
+    }
+
+    // Los lanzamientos y el tiempo activo cambian junto con el nivel;
+    // refresh() los lee sin IPC cuando hay memoria compartida
+    if (!affected.isEmpty()) {
+        refresh(affected);
+    }
+}
+
+void IconWearClient::onWearLevelReset(const QString &appId)
+{
+    Q_EMIT wearLevelReset(appId);
+}
+
+void IconWearClient::onServiceRegistered()
+{
+    // Daemon (re)iniciado: el segmento es otro y la caché puede estar obsoleta
+    m_shm.close();
+    m_available = true;
+    Q_EMIT availableChanged();
+
+    refresh(m_watched.values());
+    if (m_watchAll) {
+        callMetrics(QStringLiteral("getAllMetrics"), QStringList());
+    }
+}
+
+void IconWearClient::onServiceUnregistered()
+{
+    m_shm.close();
+    m_available = false;
+    Q_EMIT availableChanged();
+}
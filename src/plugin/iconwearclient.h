@@ -0,0 +1,117 @@
+/**
+ * @file iconwearclient.h
+ * @brief Conexión única del proceso con org.kde.iconwear
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Todas las instancias del plasmoid dentro de plasmashell comparten este
+ * cliente: una sola suscripción a las señales del daemon y una sola caché
+ * de métricas, actualizada exclusivamente por señales (sin sondeo).
+ */
+
+#ifndef ICONWEARCLIENT_H
+#define ICONWEARCLIENT_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+#include "wearmetrics.h"
+#include "wearshmreader.h"
+
+class QDBusPendingCallWatcher;
+class QDBusServiceWatcher;
+
+/**
+ * @class IconWearClient
+ * @brief Caché de métricas compartida, alimentada por las señales del daemon
+ * 
+ * **Flujo:**
+ * 1. Los modelos piden sus apps con watch() (o watchAll()).
+ * 2. Las métricas que faltan se leen de la memoria compartida del daemon
+ *    (sin IPC) o, si no está disponible, con una única llamada asíncrona
+ *    getMetricsBatch/getAllMetrics.
+ * 3. Cada wearLevelsChanged(a{si}) del daemon actualiza la caché y se
+ *    reenvía como un único metricsChanged() con todas las apps afectadas.
+ */
+class IconWearClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Instancia del proceso (se crea al primer uso, hija de qApp)
+    static IconWearClient *instance();
+
+    /// El daemon está registrado en el bus de sesión
+    bool isAvailable() const { return m_available; }
+
+    /// Métricas en caché de una app (a cero si aún no se conocen)
+    WearMetrics metrics(const QString &appId) const { return m_metrics.value(appId); }
+
+    /// Todas las apps con métricas en caché
+    QStringList knownAppIds() const { return m_metrics.keys(); }
+
+    /**
+     * @brief Asegura que las apps tengan métricas en caché
+     * @param appIds Apps que un modelo va a mostrar
+     * 
+     * Las apps ya conocidas no generan ninguna llamada.
+     */
+    void watch(const QStringList &appIds);
+
+    /// Como watch() pero para todas las apps del daemon (una llamada getAllMetrics)
+    void watchAll();
+
+    /// Pide al daemon el reset de una app (asíncrono; el cambio llega por señal)
+    void resetWearLevel(const QString &appId);
+
+Q_SIGNALS:
+    /**
+     * @brief Métricas actualizadas
+     * @param appIds Todas las apps que cambiaron en este lote
+     */
+    void metricsChanged(const QStringList &appIds);
+
+    /// Cambió isAvailable()
+    void availableChanged();
+
+    /// El daemon reseteó una app (para animaciones)
+    void wearLevelReset(const QString &appId);
+
+private Q_SLOTS:
+    void onWearLevelsChanged(const WearLevelMap &levels);
+    void onWearLevelReset(const QString &appId);
+    void onServiceRegistered();
+    void onServiceUnregistered();
+    void onMetricsReply(QDBusPendingCallWatcher *watcher);
+
+private:
+    explicit IconWearClient(QObject *parent);
+
+    /**
+     * @brief Relee las métricas completas de varias apps
+     * 
+     * Primero desde memoria compartida; las que no estén ahí, con una
+     * sola llamada DBus asíncrona. Emite metricsChanged() por cada origen.
+     */
+    void refresh(const QStringList &appIds);
+
+    /// Llamada asíncrona a un método de consulta del daemon
+    void callMetrics(const QString &method, const QStringList &appIds);
+
+    /// Caché appId -> métricas compartida por todos los modelos
+    QHash<QString, WearMetrics> m_metrics;
+
+    /// Apps que algún modelo está mostrando
+    QSet<QString> m_watched;
+
+    /// Algún modelo muestra todas las apps
+    bool m_watchAll = false;
+
+    bool m_available = false;
+    QDBusServiceWatcher *m_serviceWatcher;
+    WearShmReader m_shm;
+};
+
+#endif // ICONWEARCLIENT_H
@@ -0,0 +1,28 @@
+/**
+ * @file iconwearplugin.cpp
+ * @brief Implementación del plugin QML org.kde.iconwear
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "iconwearplugin.h"
+#include "weariconbatch.h"
+#include "wearmodel.h"
+#include "wearoverlayprovider.h"
+
+#include <QQmlEngine>
+
+void IconWearPlugin::registerTypes(const char *uri)
+{
+    Q_ASSERT(QLatin1String(uri) == QLatin1String("org.kde.iconwear"));
+    qmlRegisterModule(uri, 1, 0);
+    qmlRegisterType<WearModel>(uri, 1, 0, "WearModel");
+    qmlRegisterType<WearIconBatch>(uri, 1, 0, "WearIconBatch");
+}
+
+void IconWearPlugin::initializeEngine(QQmlEngine *engine, const char *uri)
+{
+    Q_UNUSED(uri);
+    // El motor toma posesión del proveedor; la caché de imágenes es global
+    // al proceso y la comparten todos los motores
+    engine->addImageProvider(QStringLiteral("iconwear"), new WearOverlayProvider);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file iconwearplugin.h
+ * @brief Plugin QML org.kde.iconwear
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Registra en el motor QML el proveedor de imágenes `image://iconwear`
+ * con los overlays de desgaste prerenderizados y los tipos WearModel y
+ * WearIconBatch.
+ */
+
+#ifndef ICONWEARPLUGIN_H
+#define ICONWEARPLUGIN_H
+
+#include <QQmlExtensionPlugin>
+
+/**
+ * @class IconWearPlugin
+ * @brief Punto de entrada del módulo QML `org.kde.iconwear`
+ */
+class IconWearPlugin : public QQmlExtensionPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID QQmlExtensionInterface_iid)
+
+public:
+    void registerTypes(const char *uri) override;
+    void initializeEngine(QQmlEngine *engine, const char *uri) override;
+};
+
+#endif // ICONWEARPLUGIN_H
@@ -0,0 +1,27 @@
+// Misma fórmula que WearIconBatch::composeCell(); todo premultiplicado
+// params = (desaturación, oscurecimiento, destello)
+#version 440
+
+layout(location = 0) in vec2 texCoord;
+layout(location = 1) in vec3 params;
+
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+};
+
+layout(binding = 1) uniform sampler2D iconTexture;
+layout(binding = 2) uniform sampler2D overlayTexture;
+
+void main()
+{
+    vec4 icon = texture(iconTexture, texCoord);
+    float gray = dot(icon.rgb, vec3(0.299, 0.587, 0.114));
+    vec4 color = vec4(mix(icon.rgb, vec3(gray), params.x) * (1.0 - params.y), icon.a);
+    vec4 overlay = texture(overlayTexture, texCoord);
+    color = overlay + color * (1.0 - overlay.a);
+    color = mix(color, vec4(1.0), params.z);
+    fragColor = color * qt_Opacity;
+}
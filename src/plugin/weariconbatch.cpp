@@ -0,0 +1,621 @@
+/**
+ * @file weariconbatch.cpp
+ * @brief Implementación de la rejilla de iconos en una sola pasada
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "weariconbatch.h"
+#include "wearoverlayprovider.h"
+
+#include <QIcon>
+#include <QMatrix4x4>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGImageNode>
+#include <QSGMaterial>
+#include <QSGRendererInterface>
+#include <QSGTexture>
+#include <QUrl>
+#include <QtMath>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+namespace {
+
+/// Vértice del lote: posición, coordenada en los atlas y parámetros de su icono
+struct WearVertex {
+    float x;
+    float y;
+    float u;
+    float v;
+    WearIconBatch::CellParams params;
+};
+
+static_assert(sizeof(WearVertex) == 7 * sizeof(float), "WearVertex debe ser compacto");
+
+const QSGGeometry::AttributeSet &wearAttributes()
+{
+    static const QSGGeometry::Attribute attributes[] = {
+        QSGGeometry::Attribute::createWithAttributeType(0, 2, QSGGeometry::FloatType, QSGGeometry::PositionAttribute),
+        QSGGeometry::Attribute::createWithAttributeType(1, 2, QSGGeometry::FloatType, QSGGeometry::TexCoordAttribute),
+        QSGGeometry::Attribute::createWithAttributeType(2, 3, QSGGeometry::FloatType, QSGGeometry::UnknownAttribute),
+    };
+    static const QSGGeometry::AttributeSet set = {3, sizeof(WearVertex), attributes};
+    return set;
+}
+
+/**
+ * @brief Material de todo el lote: dos atlas y ningún parámetro por icono
+ *
+ * Los parámetros viajan en los vértices, así que el material solo cambia
+ * cuando cambian los atlas y el renderer no parte el lote.
+ */
+class WearBatchMaterial : public QSGMaterial
+{
+public:
+    WearBatchMaterial() { setFlag(Blending); }
+
+    QSGMaterialType *type() const override
+    {
+        static QSGMaterialType materialType;
+        return &materialType;
+    }
+
+    QSGMaterialShader *createShader(QSGRendererInterface::RenderMode renderMode) const override;
+
+    int compare(const QSGMaterial *other) const override
+    {
+        const auto *material = static_cast<const WearBatchMaterial *>(other);
+        const qint64 icons = iconTexture->comparisonKey() - material->iconTexture->comparisonKey();
+        if (icons != 0) {
+            return icons < 0 ? -1 : 1;
+        }
+        const qint64 overlays = overlayTexture->comparisonKey() - material->overlayTexture->comparisonKey();
+        return overlays < 0 ? -1 : (overlays > 0 ? 1 : 0);
+    }
+
+    std::unique_ptr<QSGTexture> iconTexture;
+    std::unique_ptr<QSGTexture> overlayTexture;
+};
+
+//! Misma fórmula que WearIconBatch::composeCell(), en shaders/wearbatch.{vert,frag}
+class WearBatchShader : public QSGMaterialShader
+{
+public:
+    WearBatchShader()
+    {
+        setShaderFileName(VertexStage, QStringLiteral(":/org/kde/iconwear/shaders/wearbatch.vert.qsb"));
+        setShaderFileName(FragmentStage, QStringLiteral(":/org/kde/iconwear/shaders/wearbatch.frag.qsb"));
+    }
+
+    //! Bloque uniforme std140: mat4 qt_Matrix (64 bytes) y float qt_Opacity
+    bool updateUniformData(RenderState &state, QSGMaterial *newMaterial, QSGMaterial *oldMaterial) override
+    {
+        Q_UNUSED(newMaterial);
+        Q_UNUSED(oldMaterial);
+        QByteArray *buffer = state.uniformData();
+        bool changed = false;
+        if (state.isMatrixDirty()) {
+            const QMatrix4x4 matrix = state.combinedMatrix();
+            std::memcpy(buffer->data(), matrix.constData(), 64);
+            changed = true;
+        }
+        if (state.isOpacityDirty()) {
+            const float opacity = state.opacity();
+            std::memcpy(buffer->data() + 64, &opacity, sizeof(opacity));
+            changed = true;
+        }
+        return changed;
+    }
+
+    //! binding 1: atlas de iconos; binding 2: atlas de overlays
+    void updateSampledImage(RenderState &state, int binding, QSGTexture **texture, QSGMaterial *newMaterial,
+                            QSGMaterial *oldMaterial) override
+    {
+        Q_UNUSED(state);
+        Q_UNUSED(oldMaterial);
+        const auto *material = static_cast<WearBatchMaterial *>(newMaterial);
+        *texture = binding == 1 ? material->iconTexture.get() : material->overlayTexture.get();
+    }
+};
+
+QSGMaterialShader *WearBatchMaterial::createShader(QSGRendererInterface::RenderMode renderMode) const
+{
+    Q_UNUSED(renderMode);
+    return new WearBatchShader;
+}
+
+/// Nodo del camino RHI: geometría y material propios, sin asignaciones por icono
+class WearBatchNode : public QSGGeometryNode
+{
+public:
+    WearBatchNode()
+        : m_geometry(wearAttributes(), 0, 0, QSGGeometry::UnsignedShortType)
+    {
+        m_geometry.setDrawingMode(QSGGeometry::DrawTriangles);
+        setGeometry(&m_geometry);
+        setMaterial(&m_material);
+    }
+
+    QSGGeometry m_geometry;
+    WearBatchMaterial m_material;
+};
+
+/// Nodo del camino software: la imagen compuesta y la textura que la contiene
+class SoftwareFrameNode : public QSGNode
+{
+public:
+    explicit SoftwareFrameNode(QSGImageNode *image)
+        : imageNode(image)
+    {
+        appendChildNode(imageNode);
+    }
+
+    QSGImageNode *imageNode;
+    std::unique_ptr<QSGTexture> texture;
+};
+
+//! Icono de @p pixels × @p pixels, centrado; transparente si no se encuentra
+QImage loadIcon(const QString &name, int pixels)
+{
+    QIcon icon;
+    if (name.startsWith(QLatin1String("file:"))) {
+        icon = QIcon(QUrl(name).toLocalFile());
+    } else if (name.contains(QLatin1Char('/'))) {
+        icon = QIcon(name);
+    } else {
+        icon = QIcon::fromTheme(name);
+    }
+
+    QImage cell(pixels, pixels, QImage::Format_ARGB32_Premultiplied);
+    cell.fill(Qt::transparent);
+    if (icon.isNull()) {
+        return cell;
+    }
+
+    QImage image = icon.pixmap(QSize(pixels, pixels)).toImage();
+    if (image.width() != pixels && image.height() != pixels) {
+        image = image.scaled(pixels, pixels, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    QPainter painter(&cell);
+    painter.drawImage((pixels - image.width()) / 2, (pixels - image.height()) / 2, image);
+    return cell;
+}
+
+//! Copia @p image en la celda (sustituyendo lo que hubiera)
+void blitCell(QImage &atlas, const QPoint &at, const QImage &image)
+{
+    QPainter painter(&atlas);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(QRect(at, QSize(image.width(), image.height())), Qt::transparent);
+    if (!image.isNull()) {
+        painter.drawImage(at, image);
+    }
+}
+
+} // namespace
+
+WearIconBatch::WearIconBatch(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+    m_clock.start();
+}
+
+void WearIconBatch::setIcons(const QStringList &icons)
+{
+    if (icons == m_icons) {
+        return;
+    }
+    m_icons = icons;
+    m_iconsDirty = true;
+    m_flashStart.clear();
+    updateImplicitSize();
+    polish();
+    update();
+    Q_EMIT iconsChanged();
+}
+
+QVariantList WearIconBatch::wearLevels() const
+{
+    QVariantList levels;
+    levels.reserve(m_levels.size());
+    for (qreal level : m_levels) {
+        levels.append(level);
+    }
+    return levels;
+}
+
+void WearIconBatch::setWearLevels(const QVariantList &levels)
+{
+    QVector<qreal> values;
+    values.reserve(levels.size());
+    for (const QVariant &level : levels) {
+        values.append(level.toReal());
+    }
+    if (values == m_levels) {
+        return;
+    }
+    m_levels = values;
+    polish();
+    update();
+    Q_EMIT wearLevelsChanged();
+}
+
+void WearIconBatch::setModel(WearModel *model)
+{
+    if (model == m_model) {
+        return;
+    }
+    if (m_model) {
+        disconnect(m_model, nullptr, this, nullptr);
+    }
+    m_model = model;
+    if (m_model) {
+        connect(m_model, &QAbstractItemModel::dataChanged, this, &WearIconBatch::syncFromModel);
+        connect(m_model, &QAbstractItemModel::modelReset, this, &WearIconBatch::syncFromModel);
+        connect(m_model, &QAbstractItemModel::rowsInserted, this, &WearIconBatch::syncFromModel);
+        connect(m_model, &QAbstractItemModel::rowsRemoved, this, &WearIconBatch::syncFromModel);
+        connect(m_model, &WearModel::wearLevelReset, this, [this](const QString &appId) {
+            playResetAnimation(m_model->indexOf(appId));
+        });
+    }
+    syncFromModel();
+    Q_EMIT modelChanged();
+}
+
+void WearIconBatch::setIconSize(int size)
+{
+    size = qMax(1, size);
+    if (size == m_iconSize) {
+        return;
+    }
+    m_iconSize = size;
+    m_iconsDirty = true;
+    updateImplicitSize();
+    polish();
+    update();
+    Q_EMIT iconSizeChanged();
+}
+
+void WearIconBatch::setColumns(int columns)
+{
+    columns = qMax(0, columns);
+    if (columns == m_columns) {
+        return;
+    }
+    m_columns = columns;
+    updateImplicitSize();
+    update();
+    Q_EMIT columnsChanged();
+}
+
+void WearIconBatch::setSpacing(qreal spacing)
+{
+    if (qFuzzyCompare(spacing, m_spacing)) {
+        return;
+    }
+    m_spacing = spacing;
+    updateImplicitSize();
+    update();
+    Q_EMIT spacingChanged();
+}
+
+void WearIconBatch::playResetAnimation(int index)
+{
+    if (index < 0 || index >= cellCount()) {
+        return;
+    }
+    m_flashStart.insert(index, m_clock.elapsed());
+    update();
+}
+
+void WearIconBatch::syncFromModel()
+{
+    polish();
+    update();
+}
+
+//! Cada frame con destellos en curso pide el siguiente; al terminar el último, se para
+void WearIconBatch::advanceFlashes()
+{
+    if (m_flashStart.isEmpty()) {
+        return;
+    }
+    for (auto it = m_flashStart.begin(); it != m_flashStart.end();) {
+        it = flashProgress(it.key()) < 0 ? m_flashStart.erase(it) : std::next(it);
+    }
+    update();
+}
+
+int WearIconBatch::cellCount() const
+{
+    return qMin(m_icons.size(), MAX_ICONS);
+}
+
+int WearIconBatch::effectiveColumns() const
+{
+    if (m_columns > 0) {
+        return m_columns;
+    }
+    return qMax(1, qFloor((width() + m_spacing) / (m_iconSize + m_spacing)));
+}
+
+void WearIconBatch::updateImplicitSize()
+{
+    const int count = cellCount();
+    if (count == 0) {
+        setImplicitSize(0, 0);
+        return;
+    }
+    const int columns = m_columns > 0 ? qMin(m_columns, count) : count;
+    const int rows = (count + columns - 1) / columns;
+    setImplicitSize(columns * m_iconSize + (columns - 1) * m_spacing, rows * m_iconSize + (rows - 1) * m_spacing);
+}
+
+qreal WearIconBatch::flashProgress(int index) const
+{
+    const auto start = m_flashStart.constFind(index);
+    if (start == m_flashStart.constEnd()) {
+        return -1;
+    }
+    // Mismas curvas que la SequentialAnimation de WearShader.qml
+    const qreal elapsed = m_clock.elapsed() - *start;
+    if (elapsed < 300) {
+        const qreal t = elapsed / 300;
+        return 1 - (1 - t) * (1 - t);  // OutQuad, 0 -> 1
+    }
+    if (elapsed < 450) {
+        const qreal t = (elapsed - 300) / 150;
+        return 1 - t * t;  // InQuad, 1 -> 0
+    }
+    return -1;
+}
+
+WearIconBatch::CellParams WearIconBatch::cellParams(int index) const
+{
+    const float wear = static_cast<float>(qBound<qreal>(0, m_cellLevels.value(index) / 100.0, 1));
+    CellParams params;
+    params.desaturation = wear * 0.7f;
+    params.darken = wear * 0.25f;
+    params.flash = static_cast<float>(qMax<qreal>(0, flashProgress(index))) * 0.8f;
+    return params;
+}
+
+QPoint WearIconBatch::atlasCell(int index) const
+{
+    const int stride = m_cellPixels + 2;
+    return QPoint(index % m_atlasColumns * stride + 1, index / m_atlasColumns * stride + 1);
+}
+
+QRectF WearIconBatch::cellRect(int index) const
+{
+    const int columns = effectiveColumns();
+    const qreal step = m_iconSize + m_spacing;
+    return QRectF(index % columns * step, index / columns * step, m_iconSize, m_iconSize);
+}
+
+//! En el hilo de la GUI, antes de sincronizar: todo lo que toca QIcon o el modelo
+void WearIconBatch::updatePolish()
+{
+    const int count = cellCount();
+    m_cellLevels.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_cellLevels[i] = m_model ? m_model->data(m_model->index(i), WearModel::WearLevelRole).toReal()
+                                  : m_levels.value(i);
+    }
+
+    if (m_iconsDirty) {
+        rebuildIconAtlas();
+        m_iconsDirty = false;
+    }
+    refreshOverlayAtlas();
+}
+
+void WearIconBatch::rebuildIconAtlas()
+{
+    const int count = cellCount();
+    const qreal dpr = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    m_cellPixels = qMax(1, qRound(m_iconSize * dpr));
+    m_atlasColumns = qMax(1, qCeil(qSqrt(count)));
+    const int rows = qMax(1, (count + m_atlasColumns - 1) / m_atlasColumns);
+
+    // Borde transparente de 1 px por celda: el filtrado lineal no mezcla vecinos
+    const int stride = m_cellPixels + 2;
+    m_iconAtlas = QImage(m_atlasColumns * stride, rows * stride, QImage::Format_ARGB32_Premultiplied);
+    m_iconAtlas.fill(Qt::transparent);
+    m_overlayAtlas = QImage(m_iconAtlas.size(), QImage::Format_ARGB32_Premultiplied);
+    m_overlayAtlas.fill(Qt::transparent);
+
+    m_iconImages.resize(count);
+    m_overlayImages.fill(QImage(), count);
+    m_overlayLevels.fill(-1, count);
+    m_seeds.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_iconImages[i] = loadIcon(m_icons.at(i), m_cellPixels);
+        m_seeds[i] = static_cast<int>(qHash(m_icons.at(i)) & 0x7fffffff);
+        blitCell(m_iconAtlas, atlasCell(i), m_iconImages.at(i));
+    }
+    m_iconAtlasChanged = true;
+    m_overlayAtlasChanged = true;
+}
+
+void WearIconBatch::refreshOverlayAtlas()
+{
+    const QSize size(m_cellPixels, m_cellPixels);
+    for (int i = 0; i < m_overlayLevels.size(); ++i) {
+        const int level = WearOverlayProvider::quantizeLevel(qRound(m_cellLevels.value(i)));
+        if (level == m_overlayLevels.at(i)) {
+            continue;
+        }
+        // La caché del proveedor es global: los mismos overlays que image://iconwear
+        m_overlayLevels[i] = level;
+        m_overlayImages[i] = WearOverlayProvider::overlay(level, size, m_seeds.at(i));
+        blitCell(m_overlayAtlas, atlasCell(i), m_overlayImages.at(i));
+        m_overlayAtlasChanged = true;
+    }
+}
+
+QSGNode *WearIconBatch::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data);
+    if (m_overlayLevels.isEmpty() || width() <= 0 || height() <= 0) {
+        delete oldNode;
+        return nullptr;
+    }
+
+    // El backend software no admite materiales propios
+    const bool rhi = QSGRendererInterface::isApiRhiBased(window()->rendererInterface()->graphicsApi());
+    return rhi ? updateMaterialNode(oldNode) : updateSoftwareNode(oldNode);
+}
+
+QSGNode *WearIconBatch::updateMaterialNode(QSGNode *oldNode)
+{
+    auto *node = static_cast<WearBatchNode *>(oldNode);
+    if (!node) {
+        node = new WearBatchNode;
+        m_iconAtlasChanged = true;
+        m_overlayAtlasChanged = true;
+    }
+
+    WearBatchMaterial &material = node->m_material;
+    if (m_iconAtlasChanged) {
+        material.iconTexture.reset(window()->createTextureFromImage(m_iconAtlas));
+        material.iconTexture->setFiltering(QSGTexture::Linear);
+        m_iconAtlasChanged = false;
+    }
+    if (m_overlayAtlasChanged) {
+        material.overlayTexture.reset(window()->createTextureFromImage(m_overlayAtlas));
+        material.overlayTexture->setFiltering(QSGTexture::Linear);
+        m_overlayAtlasChanged = false;
+    }
+
+    // Cuatro vértices y seis índices por icono: una sola llamada de dibujo para todos
+    const int count = m_overlayLevels.size();
+    QSGGeometry &geometry = node->m_geometry;
+    if (geometry.vertexCount() != count * 4) {
+        geometry.allocate(count * 4, count * 6);
+        quint16 *indices = geometry.indexDataAsUShort();
+        for (int i = 0; i < count; ++i) {
+            const quint16 base = static_cast<quint16>(i * 4);
+            const quint16 quad[] = {base, quint16(base + 1), quint16(base + 2), quint16(base + 2), quint16(base + 1), quint16(base + 3)};
+            std::copy(std::begin(quad), std::end(quad), indices + i * 6);
+        }
+    }
+
+    const float atlasWidth = m_iconAtlas.width();
+    const float atlasHeight = m_iconAtlas.height();
+    auto *vertices = static_cast<WearVertex *>(geometry.vertexData());
+    for (int i = 0; i < count; ++i) {
+        const QRectF rect = cellRect(i);
+        const QPoint cell = atlasCell(i);
+        const float u0 = cell.x() / atlasWidth;
+        const float v0 = cell.y() / atlasHeight;
+        const float u1 = (cell.x() + m_cellPixels) / atlasWidth;
+        const float v1 = (cell.y() + m_cellPixels) / atlasHeight;
+        const CellParams params = cellParams(i);
+        WearVertex *quad = vertices + i * 4;
+        quad[0] = {float(rect.left()), float(rect.top()), u0, v0, params};
+        quad[1] = {float(rect.right()), float(rect.top()), u1, v0, params};
+        quad[2] = {float(rect.left()), float(rect.bottom()), u0, v1, params};
+        quad[3] = {float(rect.right()), float(rect.bottom()), u1, v1, params};
+    }
+
+    node->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
+    return node;
+}
+
+QSGNode *WearIconBatch::updateSoftwareNode(QSGNode *oldNode)
+{
+    auto *node = static_cast<SoftwareFrameNode *>(oldNode);
+    if (!node) {
+        node = new SoftwareFrameNode(window()->createImageNode());
+    }
+
+    const qreal dpr = window()->effectiveDevicePixelRatio();
+    QImage frame(qCeil(width() * dpr), qCeil(height() * dpr), QImage::Format_ARGB32_Premultiplied);
+    frame.fill(Qt::transparent);
+    for (int i = 0; i < m_overlayLevels.size(); ++i) {
+        const QPoint at = (cellRect(i).topLeft() * dpr).toPoint();
+        composeCell(frame, at, m_iconImages.at(i), m_overlayImages.at(i), cellParams(i));
+    }
+
+    // Una textura por frame compuesto; la anterior se libera tras sustituirla
+    std::unique_ptr<QSGTexture> texture(window()->createTextureFromImage(frame));
+    node->imageNode->setTexture(texture.get());
+    node->imageNode->setRect(QRectF(0, 0, frame.width() / dpr, frame.height() / dpr));
+    node->texture = std::move(texture);
+    m_iconAtlasChanged = false;
+    m_overlayAtlasChanged = false;
+    return node;
+}
+
+void WearIconBatch::composeCell(QImage &target, const QPoint &at, const QImage &icon, const QImage &overlay,
+                                const CellParams &params)
+{
+    const QRect area = QRect(at, icon.size()).intersected(target.rect());
+    const bool hasOverlay = overlay.size() == icon.size();
+    const float keep = 1.0f - params.darken;
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        auto *out = reinterpret_cast<QRgb *>(target.scanLine(y));
+        const auto *in = reinterpret_cast<const QRgb *>(icon.constScanLine(y - at.y()));
+        const auto *crack = hasOverlay ? reinterpret_cast<const QRgb *>(overlay.constScanLine(y - at.y())) : nullptr;
+        for (int x = area.left(); x <= area.right(); ++x) {
+            const QRgb pixel = in[x - at.x()];
+            float r = qRed(pixel) / 255.0f;
+            float g = qGreen(pixel) / 255.0f;
+            float b = qBlue(pixel) / 255.0f;
+            float a = qAlpha(pixel) / 255.0f;
+
+            const float gray = 0.299f * r + 0.587f * g + 0.114f * b;
+            r = (r + (gray - r) * params.desaturation) * keep;
+            g = (g + (gray - g) * params.desaturation) * keep;
+            b = (b + (gray - b) * params.desaturation) * keep;
+
+            if (crack) {
+                const QRgb over = crack[x - at.x()];
+                const float inverse = 1.0f - qAlpha(over) / 255.0f;
+                r = qRed(over) / 255.0f + r * inverse;
+                g = qGreen(over) / 255.0f + g * inverse;
+                b = qBlue(over) / 255.0f + b * inverse;
+                a = qAlpha(over) / 255.0f + a * inverse;
+            }
+
+            r += (1.0f - r) * params.flash;
+            g += (1.0f - g) * params.flash;
+            b += (1.0f - b) * params.flash;
+            a += (1.0f - a) * params.flash;
+            out[x] = qRgba(qRound(r * 255), qRound(g * 255), qRound(b * 255), qRound(a * 255));
+        }
+    }
+}
+
+void WearIconBatch::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    update();
+}
+
+void WearIconBatch::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    if (change == ItemSceneChange) {
+        if (m_window) {
+            disconnect(m_window, &QQuickWindow::afterAnimating, this, &WearIconBatch::advanceFlashes);
+        }
+        m_window = value.window;
+        if (m_window) {
+            connect(m_window, &QQuickWindow::afterAnimating, this, &WearIconBatch::advanceFlashes);
+        }
+        m_iconsDirty = true;
+        polish();
+    } else if (change == ItemDevicePixelRatioHasChanged) {
+        m_iconsDirty = true;
+        polish();
+        update();
+    }
+    QQuickItem::itemChange(change, value);
+}
@@ -0,0 +1,213 @@
+/**
+ * @file weariconbatch.h
+ * @brief Iconos gastados dibujados en una sola pasada del scene graph
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ *
+ * Sustituye la pila de WearShader.qml (ShaderEffectSource + Desaturate +
+ * Rectangle + overlay + flash, varias pasadas fuera de pantalla por icono)
+ * por un único QQuickItem que dibuja una rejilla de iconos:
+ *
+ * - **RHI** (OpenGL, Vulkan...): un solo QSGGeometryNode con un material
+ *   propio (shaders/wearbatch.vert/.frag, compilados a .qsb). Los iconos
+ *   y sus overlays de grietas (WearOverlayProvider) van en dos atlas; cada
+ *   icono son cuatro vértices que llevan sus parámetros (desaturación,
+ *   oscurecimiento, destello), así que N iconos son una sola llamada de
+ *   dibujo y cambiar un nivel no cambia el material.
+ * - **Software** (QT_QUICK_BACKEND=software, sin materiales propios): la
+ *   misma fórmula se compone en CPU en una imagen y se dibuja con un único
+ *   QSGImageNode.
+ *
+ * **Uso desde QML:**
+ * ```qml
+ * WearIconBatch {
+ *     iconSize: 48
+ *     icons: ["org.kde.dolphin", "firefox", "org.kde.konsole"]
+ *     model: WearModel { appIds: ["org.kde.dolphin.desktop", "firefox.desktop", "org.kde.konsole.desktop"] }
+ * }
+ * ```
+ */
+
+#ifndef WEARICONBATCH_H
+#define WEARICONBATCH_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QPointer>
+#include <QQuickItem>
+#include <QStringList>
+#include <QVector>
+
+#include "wearmodel.h"
+
+class QQuickWindow;
+
+/**
+ * @class WearIconBatch
+ * @brief Rejilla de iconos con desgaste, grietas y destello de reset en una pasada
+ *
+ * La celda i muestra `icons[i]` con el desgaste de la fila i de `model`
+ * (o `wearLevels[i]` si no hay modelo). Los iconos se colocan por filas de
+ * `columns` celdas (0 = las que quepan en el ancho).
+ */
+class WearIconBatch : public QQuickItem
+{
+    Q_OBJECT
+
+    /// Nombres de icono del tema o rutas de archivo, uno por celda
+    Q_PROPERTY(QStringList icons READ icons WRITE setIcons NOTIFY iconsChanged)
+
+    /// Desgaste 0-100 por celda; se ignora si hay `model`
+    Q_PROPERTY(QVariantList wearLevels READ wearLevels WRITE setWearLevels NOTIFY wearLevelsChanged)
+
+    /// Modelo del que leer el desgaste (fila i = celda i); su wearLevelReset() lanza el destello
+    Q_PROPERTY(WearModel *model READ model WRITE setModel NOTIFY modelChanged)
+
+    /// Lado de cada icono en píxeles lógicos
+    Q_PROPERTY(int iconSize READ iconSize WRITE setIconSize NOTIFY iconSizeChanged)
+
+    /// Celdas por fila; 0 = las que quepan en el ancho
+    Q_PROPERTY(int columns READ columns WRITE setColumns NOTIFY columnsChanged)
+
+    /// Separación entre celdas en píxeles lógicos
+    Q_PROPERTY(qreal spacing READ spacing WRITE setSpacing NOTIFY spacingChanged)
+
+public:
+    explicit WearIconBatch(QQuickItem *parent = nullptr);
+
+    QStringList icons() const { return m_icons; }
+    void setIcons(const QStringList &icons);
+
+    QVariantList wearLevels() const;
+    void setWearLevels(const QVariantList &levels);
+
+    WearModel *model() const { return m_model; }
+    void setModel(WearModel *model);
+
+    int iconSize() const { return m_iconSize; }
+    void setIconSize(int size);
+
+    int columns() const { return m_columns; }
+    void setColumns(int columns);
+
+    qreal spacing() const { return m_spacing; }
+    void setSpacing(qreal spacing);
+
+    /// Reproduce el destello de reset de una celda (300 ms de subida, 150 de bajada)
+    Q_INVOKABLE void playResetAnimation(int index);
+
+    /// Iconos por elemento: los índices de 16 bits de la geometría lo limitan
+    static constexpr int MAX_ICONS = 16383;
+
+    /**
+     * @brief Parámetros de una celda, en el orden del atributo del vértice
+     *
+     * Mismas proporciones que la antigua pila QML: desaturación 0.7,
+     * oscurecimiento 0.25 y destello 0.8 a desgaste/progreso completos.
+     */
+    struct CellParams {
+        float desaturation = 0.0f;
+        float darken = 0.0f;
+        float flash = 0.0f;
+    };
+
+    /**
+     * @brief Fórmula del material en CPU (camino software y referencia)
+     * @param target Imagen destino (ARGB32 premultiplicado)
+     * @param at Esquina de la celda en @p target
+     * @param icon Icono (ARGB32 premultiplicado)
+     * @param overlay Grietas del mismo tamaño que @p icon (puede ser nula)
+     */
+    static void composeCell(QImage &target, const QPoint &at, const QImage &icon, const QImage &overlay,
+                            const CellParams &params);
+
+Q_SIGNALS:
+    void iconsChanged();
+    void wearLevelsChanged();
+    void modelChanged();
+    void iconSizeChanged();
+    void columnsChanged();
+    void spacingChanged();
+
+protected:
+    void updatePolish() override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private Q_SLOTS:
+    /// Relee los niveles de `model`
+    void syncFromModel();
+
+    /// Avanza los destellos en curso; conectado a QQuickWindow::afterAnimating
+    void advanceFlashes();
+
+private:
+    /// Celdas a dibujar (iconos, acotados a MAX_ICONS)
+    int cellCount() const;
+
+    /// Celdas por fila con el ancho actual
+    int effectiveColumns() const;
+
+    /// Recalcula implicitWidth/implicitHeight
+    void updateImplicitSize();
+
+    /// Parámetros de la celda @p index en este instante
+    CellParams cellParams(int index) const;
+
+    /// Progreso 0-1 del destello de una celda, o -1 si terminó
+    qreal flashProgress(int index) const;
+
+    /// Rehace el atlas de iconos (hilo de la GUI: QIcon no es seguro en otros)
+    void rebuildIconAtlas();
+
+    /// Repinta en el atlas de overlays las celdas cuyo nivel cuantizado cambió
+    void refreshOverlayAtlas();
+
+    /// Esquina en el atlas de la celda @p index (píxeles físicos)
+    QPoint atlasCell(int index) const;
+
+    /// Rectángulo de la celda @p index en el elemento (píxeles lógicos)
+    QRectF cellRect(int index) const;
+
+    QSGNode *updateMaterialNode(QSGNode *oldNode);
+    QSGNode *updateSoftwareNode(QSGNode *oldNode);
+
+    QStringList m_icons;
+    QVector<qreal> m_levels;
+    QPointer<WearModel> m_model;
+    int m_iconSize = 48;
+    int m_columns = 0;
+    qreal m_spacing = 4.0;
+
+    /// Lado de una celda del atlas en píxeles físicos (sin el borde de 1 px)
+    int m_cellPixels = 0;
+    int m_atlasColumns = 1;
+
+    /// Semilla de las grietas por celda (hash del nombre: cada icono las suyas)
+    QVector<int> m_seeds;
+
+    /// Desgaste 0-100 por celda, tomado en updatePolish() (el modelo vive en el hilo de la GUI)
+    QVector<qreal> m_cellLevels;
+
+    /// Imágenes de cada icono, para el camino software
+    QVector<QImage> m_iconImages;
+    QVector<QImage> m_overlayImages;
+    QVector<int> m_overlayLevels;
+
+    QImage m_iconAtlas;
+    QImage m_overlayAtlas;
+    bool m_iconAtlasChanged = false;
+    bool m_overlayAtlasChanged = false;
+    bool m_iconsDirty = true;
+
+    /// Inicio de cada destello en curso (ms de m_clock)
+    QHash<int, qint64> m_flashStart;
+    QElapsedTimer m_clock;
+
+    /// Ventana de la que recibimos afterAnimating
+    QPointer<QQuickWindow> m_window;
+};
+
+#endif // WEARICONBATCH_H
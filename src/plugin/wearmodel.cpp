@@ -0,0 +1,186 @@
+/**
+ * @file wearmodel.cpp
+ * @brief Implementación del modelo QML de métricas de desgaste
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "wearmodel.h"
+#include "iconwearclient.h"
+
+#include <algorithm>
+
+WearModel::WearModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    IconWearClient *client = IconWearClient::instance();
+    connect(client, &IconWearClient::metricsChanged, this, &WearModel::onMetricsChanged);
+    connect(client, &IconWearClient::availableChanged, this, &WearModel::availableChanged);
+    connect(client, &IconWearClient::wearLevelReset, this, &WearModel::onWearLevelReset);
+
+    // Sin appIds el modelo muestra todas las apps
+    rebuildRows();
+}
+
+int WearModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant WearModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const QString &appId = m_rows.at(index.row());
+    if (role == AppIdRole) {
+        return appId;
+    }
+
+    const WearMetrics metrics = IconWearClient::instance()->metrics(appId);
+    switch (role) {
+    case WearLevelRole:
+        return metrics.wearLevel;
+    case LaunchesRole:
+        return metrics.launches;
+    case ActiveMinutesRole:
+        return static_cast<int>(metrics.activeTimeSeconds / 60);
+    case ReconstructionsRole:
+        return metrics.reconstructions;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> WearModel::roleNames() const
+{
+    return {
+        {AppIdRole, "appId"},
+        {WearLevelRole, "wearLevel"},
+        {LaunchesRole, "launches"},
+        {ActiveMinutesRole, "activeMinutes"},
+        {ReconstructionsRole, "reconstructions"},
+    };
+}
+
+void WearModel::setAppIds(const QStringList &appIds)
+{
+    if (appIds == m_appIds) {
+        return;
+    }
+    m_appIds = appIds;
+    rebuildRows();
+    Q_EMIT appIdsChanged();
+}
+
+bool WearModel::isAvailable() const
+{
+    return IconWearClient::instance()->isAvailable();
+}
+
+int WearModel::indexOf(const QString &appId) const
+{
+    return m_rowOf.value(appId, -1);
+}
+
+QVariantMap WearModel::get(int row) const
+{
+    QVariantMap result;
+    if (row < 0 || row >= m_rows.size()) {
+        return result;
+    }
+    const QModelIndex idx = index(row);
+    const QHash<int, QByteArray> roles = roleNames();
+    for (auto it = roles.constBegin(); it != roles.constEnd(); ++it) {
+        result.insert(QString::fromLatin1(it.value()), data(idx, it.key()));
+    }
+    return result;
+}
+
+void WearModel::resetWearLevel(const QString &appId)
+{
+    IconWearClient::instance()->resetWearLevel(appId);
+}
+
+void WearModel::rebuildRows()
+{
+    IconWearClient *client = IconWearClient::instance();
+
+    beginResetModel();
+    if (m_appIds.isEmpty()) {
+        m_rows = client->knownAppIds();
+        std::sort(m_rows.begin(), m_rows.end());
+    } else {
+        m_rows = m_appIds;
+        m_rows.removeDuplicates();
+    }
+    m_rowOf.clear();
+    m_rowOf.reserve(m_rows.size());
+    for (int row = 0; row < m_rows.size(); ++row) {
+        m_rowOf.insert(m_rows.at(row), row);
+    }
+    endResetModel();
+    Q_EMIT countChanged();
+
+    // Después del reset: la caché puede responder (y emitir) en el acto
+    if (m_appIds.isEmpty()) {
+        client->watchAll();
+    } else {
+        client->watch(m_rows);
+    }
+}
+
+//! Un lote del cliente: altas al final y un dataChanged por tramo contiguo
+void WearModel::onMetricsChanged(const QStringList &appIds)
+{
+    QVector<int> rows;
+    QStringList added;
+    rows.reserve(appIds.size());
+
+    for (const QString &appId : appIds) {
+        const int row = m_rowOf.value(appId, -1);
+        if (row >= 0) {
+            rows.append(row);
+        } else if (m_appIds.isEmpty()) {
+            added.append(appId);
+        }
+    }
+
+    // Apps nuevas (solo en modo "todas"): una única inserción al final
+    if (!added.isEmpty()) {
+        std::sort(added.begin(), added.end());
+        const int first = m_rows.size();
+        beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+        for (const QString &appId : qAsConst(added)) {
+            m_rowOf.insert(appId, m_rows.size());
+            m_rows.append(appId);
+        }
+        endInsertRows();
+        Q_EMIT countChanged();
+    }
+
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    static const QVector<int> metricRoles = {WearLevelRole, LaunchesRole, ActiveMinutesRole, ReconstructionsRole};
+
+    std::sort(rows.begin(), rows.end());
+    int first = rows.first();
+    int last = first;
+    for (int i = 1; i < rows.size(); ++i) {
+        if (rows.at(i) <= last + 1) {
+            last = qMax(last, rows.at(i));
+            continue;
+        }
+        Q_EMIT dataChanged(index(first), index(last), metricRoles);
+        first = last = rows.at(i);
+    }
+    Q_EMIT dataChanged(index(first), index(last), metricRoles);
+}
+
+void WearModel::onWearLevelReset(const QString &appId)
+{
+    if (m_rowOf.contains(appId)) {
+        Q_EMIT wearLevelReset(appId);
+    }
+}
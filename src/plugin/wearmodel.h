@@ -0,0 +1,95 @@
+/**
+ * @file wearmodel.h
+ * @brief Modelo QML de métricas de desgaste para varias aplicaciones
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ */
+
+#ifndef WEARMODEL_H
+#define WEARMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QStringList>
+
+/**
+ * @class WearModel
+ * @brief Lista de apps con sus métricas, actualizada por señales del daemon
+ * 
+ * Todos los modelos del proceso comparten un IconWearClient, así que cien
+ * plasmoides no generan cien suscripciones ni cien consultas. Un lote de
+ * cambios del daemon se traduce en un dataChanged() por cada tramo contiguo
+ * de filas afectadas, nunca en un reset del modelo.
+ * 
+ * @code
+ * WearModel { appIds: ["org.kde.dolphin.desktop", "firefox.desktop"] }
+ * @endcode
+ */
+class WearModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /// Apps a mostrar, en orden; vacío = todas las que conoce el daemon
+    Q_PROPERTY(QStringList appIds READ appIds WRITE setAppIds NOTIFY appIdsChanged)
+
+    /// El daemon está disponible en el bus de sesión
+    Q_PROPERTY(bool available READ isAvailable NOTIFY availableChanged)
+
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        AppIdRole = Qt::UserRole + 1,
+        WearLevelRole,
+        LaunchesRole,
+        ActiveMinutesRole,
+        ReconstructionsRole
+    };
+    Q_ENUM(Roles)
+
+    explicit WearModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QStringList appIds() const { return m_appIds; }
+    void setAppIds(const QStringList &appIds);
+
+    bool isAvailable() const;
+
+    /// Fila de una app, o -1
+    Q_INVOKABLE int indexOf(const QString &appId) const;
+
+    /// Métricas de una fila como objeto JS (roles como claves)
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+    /// Pide al daemon el reset de una app
+    Q_INVOKABLE void resetWearLevel(const QString &appId);
+
+Q_SIGNALS:
+    void appIdsChanged();
+    void availableChanged();
+    void countChanged();
+
+    /// El daemon reseteó una app de este modelo
+    void wearLevelReset(const QString &appId);
+
+private Q_SLOTS:
+    void onMetricsChanged(const QStringList &appIds);
+    void onWearLevelReset(const QString &appId);
+
+private:
+    /// Reconstruye m_rows a partir de m_appIds
+    void rebuildRows();
+
+    QStringList m_appIds;
+
+    /// Filas mostradas (= m_appIds, o todas las conocidas si está vacío)
+    QStringList m_rows;
+
+    /// appId -> fila
+    QHash<QString, int> m_rowOf;
+};
+
+#endif // WEARMODEL_H
@@ -0,0 +1,164 @@
+/**
+ * @file wearoverlayprovider.cpp
+ * @brief Implementación de los overlays de desgaste cacheados
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ */
+
+#include "wearoverlayprovider.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPainterPath>
+#include <QtMath>
+
+namespace {
+
+/**
+ * @brief Caché global al proceso: (nivel, ancho, alto, semilla) -> imagen
+ * 
+ * El coste de cada entrada son sus bytes de píxeles; QCache expulsa las
+ * menos usadas al superar CACHE_BUDGET_BYTES. requestImage() puede
+ * llamarse desde los hilos de carga asíncrona de QML, de ahí el mutex.
+ */
+struct OverlayCache {
+    QMutex mutex;
+    QCache<quint64, QImage> images{WearOverlayProvider::CACHE_BUDGET_BYTES};
+};
+
+Q_GLOBAL_STATIC(OverlayCache, s_cache)
+
+//! Empaqueta la clave en 64 bits: nivel (7) | ancho (12) | alto (12) | semilla (32)
+quint64 overlayKey(int level, const QSize &size, int seed)
+{
+    return (quint64(level & 0x7f) << 56)
+         | (quint64(size.width() & 0xfff) << 44)
+         | (quint64(size.height() & 0xfff) << 32)
+         | quint64(quint32(seed));
+}
+
+} // namespace
+
+WearOverlayProvider::WearOverlayProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+}
+
+int WearOverlayProvider::quantizeLevel(int level)
+{
+    const int clamped = qBound(0, level, 100);
+    return (clamped + LEVEL_STEP / 2) / LEVEL_STEP * LEVEL_STEP;
+}
+
+//! id = "overlay/<nivel>/<semilla>"
+QImage WearOverlayProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    const QStringList parts = id.split(QLatin1Char('/'));
+    const int level = parts.value(1).toInt();
+    const int seed = parts.value(2).toInt();
+
+    QSize imageSize(requestedSize.width() > 0 ? requestedSize.width() : DEFAULT_SIZE,
+                    requestedSize.height() > 0 ? requestedSize.height() : DEFAULT_SIZE);
+    imageSize = imageSize.boundedTo(QSize(0xfff, 0xfff));
+
+    const QImage image = overlay(level, imageSize, seed);
+    if (size) {
+        *size = image.size();
+    }
+    return image;
+}
+
+QImage WearOverlayProvider::overlay(int level, const QSize &size, int seed)
+{
+    const int quantized = quantizeLevel(level);
+    const quint64 key = overlayKey(quantized, size, seed);
+
+    QMutexLocker locker(&s_cache->mutex);
+    if (const QImage *cached = s_cache->images.object(key)) {
+        return *cached;  // Copia implícitamente compartida, sin duplicar píxeles
+    }
+    locker.unlock();
+
+    // Render fuera del mutex: dos hilos pueden generar la misma clave a la
+    // vez, pero el resultado es idéntico y solo uno queda en la caché
+    auto *image = new QImage(render(quantized, size, seed));
+    const QImage result = *image;
+
+    locker.relock();
+    s_cache->images.insert(key, image, qMax(1, int(image->sizeInBytes())));
+    return result;
+}
+
+QImage WearOverlayProvider::render(int level, const QSize &size, int seed)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    const qreal wear = level / 100.0;
+    if (wear <= 0.1) {
+        return image;
+    }
+
+    const qreal width = size.width();
+    const qreal height = size.height();
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // === Grietas: polilíneas pseudoaleatorias pero estables para la semilla ===
+    QPen crackPen(QColor::fromRgbF(0, 0, 0, 0.6 * wear));
+    crackPen.setWidthF(1 + wear);
+    painter.setPen(crackPen);
+    painter.setBrush(Qt::NoBrush);
+
+    // La semilla llega de la URL y puede ser negativa: sin signo, los
+    // restos (y con ellos las coordenadas) quedan dentro del icono
+    const qint64 s = quint32(seed);
+    const int numCracks = qFloor(wear * 8);
+    const int segments = 3 + qFloor(wear * 4);
+    const qreal length = 5 + wear * 15;
+    for (int i = 0; i < numCracks; ++i) {
+        qreal x = ((s * (i + 1) * 13) % 100) / 100.0 * width;
+        qreal y = ((s * (i + 1) * 17) % 100) / 100.0 * height;
+
+        QPainterPath path(QPointF(x, y));
+        for (int j = 0; j < segments; ++j) {
+            const qreal angle = qDegreesToRadians(qreal((s * (i + 1) * (j + 1) * 23) % 360));
+            x = qBound(0.0, x + qCos(angle) * length, width);
+            y = qBound(0.0, y + qSin(angle) * length, height);
+            path.lineTo(x, y);
+        }
+        painter.drawPath(path);
+    }
+
+    // === Arañazos diagonales (rotados alrededor de su centro) ===
+    if (wear > 0.15) {
+        const qreal scratchLength = 8 + wear * 12;
+        const QColor scratchColor = QColor::fromRgbF(0.8, 0.8, 0.8, 0.4 * wear);
+        const int numScratches = qFloor(wear * 4);
+        for (int i = 0; i < numScratches; ++i) {
+            const qreal x = ((i * 41 + 19) % 100) / 100.0 * width;
+            const qreal y = ((i * 61 + 11) % 100) / 100.0 * height;
+            painter.save();
+            painter.translate(x + 0.5, y + scratchLength / 2);
+            painter.rotate(30 + i * 25);
+            painter.fillRect(QRectF(-0.5, -scratchLength / 2, 1, scratchLength), scratchColor);
+            painter.restore();
+        }
+    }
+
+    // === Astillas / puntos de impacto ===
+    if (wear > 0.2) {
+        const qreal chipSize = 2 + wear * 4;
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor::fromRgbF(0.3, 0.3, 0.3, 0.5 * wear));
+        const int numChips = qFloor(wear * 6);
+        for (int i = 0; i < numChips; ++i) {
+            const qreal x = ((i * 37 + 13) % 100) / 100.0 * (width - chipSize);
+            const qreal y = ((i * 53 + 7) % 100) / 100.0 * (height - chipSize);
+            painter.drawEllipse(QRectF(x, y, chipSize, chipSize));
+        }
+    }
+
+    return image;
+}
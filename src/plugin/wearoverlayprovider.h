@@ -0,0 +1,69 @@
+/**
+ * @file wearoverlayprovider.h
+ * @brief Overlays de desgaste prerenderizados y cacheados para QML
+ * @author Nicolas Butterfield <nicobutter@gmail.com>
+ * @license MIT
+ * 
+ * Genera una sola vez, con QPainter, la capa de grietas, astillas y
+ * arañazos de cada combinación (nivel de desgaste cuantizado, tamaño de
+ * icono, semilla). La caché es global al proceso, así que todas las
+ * instancias del plasmoid dentro de plasmashell comparten las imágenes,
+ * y está acotada en bytes.
+ * 
+ * **Uso desde QML:**
+ * ```qml
+ * Image {
+ *     source: "image://iconwear/overlay/" + level + "/" + seed
+ *     sourceSize: Qt.size(width, height)
+ * }
+ * ```
+ */
+
+#ifndef WEAROVERLAYPROVIDER_H
+#define WEAROVERLAYPROVIDER_H
+
+#include <QImage>
+#include <QQuickImageProvider>
+
+/**
+ * @class WearOverlayProvider
+ * @brief Proveedor `image://iconwear/overlay/<nivel>/<semilla>`
+ * 
+ * - `nivel`: desgaste 0-100; se cuantiza a pasos de LEVEL_STEP
+ * - `semilla`: entero que fija la disposición pseudoaleatoria de las grietas
+ *   (se toma sin signo: las negativas también dan grietas dentro del icono)
+ * - El tamaño sale de `sourceSize` (por defecto DEFAULT_SIZE)
+ */
+class WearOverlayProvider : public QQuickImageProvider
+{
+public:
+    WearOverlayProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    /**
+     * @brief Devuelve el overlay cacheado o lo genera
+     * @param level Desgaste 0-100 (se cuantiza)
+     * @param size Tamaño del icono en píxeles
+     * @param seed Semilla de la disposición
+     */
+    static QImage overlay(int level, const QSize &size, int seed);
+
+    /// Cuantiza un desgaste 0-100 al paso de la caché
+    static int quantizeLevel(int level);
+
+    /// Granularidad de la cuantización (puntos de desgaste por paso)
+    static constexpr int LEVEL_STEP = 5;
+
+    /// Tamaño por defecto si QML no indica sourceSize
+    static constexpr int DEFAULT_SIZE = 64;
+
+    /// Presupuesto de memoria de la caché compartida (bytes de píxeles)
+    static constexpr int CACHE_BUDGET_BYTES = 16 * 1024 * 1024;
+
+private:
+    /// Dibuja el overlay: equivale al antiguo Canvas + Repeaters de WearShader.qml
+    static QImage render(int level, const QSize &size, int seed);
+};
+
+#endif // WEAROVERLAYPROVIDER_H
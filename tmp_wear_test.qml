@@ -12,21 +12,9 @@ Window {
         anchors.fill: parent
         color: "transparent"
 
-        ShaderEffectSource {
-            id: srcItem
-            anchors.centerIn: parent
-            sourceItem: Image {
-                source: "/usr/share/icons/hicolor/64x64/apps/system-file-manager.png"
-                fillMode: Image.PreserveAspectFit
-                width: 64
-                height: 64
-            }
-            live: true
-        }
-
         IW.WearShader {
             anchors.fill: parent
-            source: srcItem
+            icon: "/usr/share/icons/hicolor/64x64/apps/system-file-manager.png"
             wearLevel: 0.5
         }
     }